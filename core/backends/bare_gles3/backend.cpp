@@ -4,6 +4,7 @@
 #include <EGL/eglext.h>
 
 #include "imgui.h"
+#include "imgui_internal.h"
 #include "imgui_impl_opengl3.h"
 
 #include <spdlog/spdlog.h>
@@ -99,7 +100,12 @@ namespace backend {
     }
 
     void drawFrame() {
+        // The host calls this for every display frame, only redraw when something changed.
+        // It can't tell about input so new input events count as such.
+        if (!ImGui::GetCurrentContext()->InputEventsQueue.empty()) { gui::frameScheduler.inputReceived(); }
+        if (!gui::frameScheduler.frameDue()) { return; }
 
+        gui::frameScheduler.beginFrame();
         beginFrame();
 
         if (_winWidth != winWidth || _winHeight != winHeight) {
@@ -116,6 +122,7 @@ namespace backend {
         gui::mainWindow.draw();
 
         render();
+        gui::frameScheduler.endFrame(ImGui::IsAnyItemActive());
 
         eglMakeCurrent(_egl.eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
     }
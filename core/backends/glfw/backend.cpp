@@ -11,6 +11,7 @@
 #include <stb_image.h>
 #include <stb_image_resize.h>
 #include <gui/gui.h>
+#include <chrono>
 
 namespace backend {
     const char* OPENGL_VERSIONS_GLSL[] = {
@@ -53,6 +54,10 @@ namespace backend {
         spdlog::error("Glfw Error {0}: {1}", error, description);
     }
 
+    static void wake_handler() {
+        glfwPostEmptyEvent();
+    }
+
     static void maximized_callback(GLFWwindow* window, int n) {
         if (n == GLFW_TRUE) {
             maximized = true;
@@ -238,10 +243,24 @@ namespace backend {
     }
 
     int renderLoop() {
+        // Let the frame scheduler wake the loop up when new data is ready
+        gui::frameScheduler.setWakeHandler(wake_handler);
+
         // Main loop
         while (!glfwWindowShouldClose(window)) {
-            glfwPollEvents();
+            // Sleep until input arrives, a frame is requested or the idle timeout runs out
+            double waitTime = gui::frameScheduler.getWaitTime();
+            if (waitTime > 0.0) {
+                auto waitStart = std::chrono::steady_clock::now();
+                glfwWaitEventsTimeout(waitTime);
+                double waited = std::chrono::duration<double>(std::chrono::steady_clock::now() - waitStart).count();
+                if (waited < waitTime && !gui::frameScheduler.framePending()) { gui::frameScheduler.inputReceived(); }
+            }
+            else {
+                glfwPollEvents();
+            }
 
+            gui::frameScheduler.beginFrame();
             beginFrame();
             
             if (_maximized != maximized) {
@@ -294,8 +313,10 @@ namespace backend {
             }
 
             render();
+            gui::frameScheduler.endFrame(ImGui::IsAnyItemActive());
         }
 
+        gui::frameScheduler.setWakeHandler(NULL);
         return 0;
     }
 
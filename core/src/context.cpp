@@ -292,6 +292,9 @@ int Context::init_sdrpp(int argc, char *argv[], int width, int height, void *nat
     defConfig["fastFFT"] = false;
     defConfig["fftHeight"] = 300;
     defConfig["fftRate"] = 20;
+    defConfig["maxFps"] = 0;
+    defConfig["waterfallAveraging"] = 0;
+    defConfig["waterfallRate"] = 0;
     defConfig["fftSize"] = 65536;
     defConfig["fftWindow"] = 2;
     defConfig["frequency"] = 100000000.0;
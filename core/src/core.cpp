@@ -120,6 +120,9 @@ int sdrpp_main(int argc, char* argv[]) {
     defConfig["fastFFT"] = false;
     defConfig["fftHeight"] = 300;
     defConfig["fftRate"] = 20;
+    defConfig["maxFps"] = 0;
+    defConfig["waterfallAveraging"] = 0;
+    defConfig["waterfallRate"] = 0;
     defConfig["fftSize"] = 65536;
     defConfig["fftWindow"] = 2;
     defConfig["frequency"] = 100000000.0;
@@ -234,6 +237,11 @@ int sdrpp_main(int argc, char* argv[]) {
 
     defConfig["vfoColors"]["Radio"] = "#FFFFFF";
 
+    defConfig["threading"]["sharedExecutor"] = false;
+    defConfig["threading"]["executorWorkers"] = 0; // One per physical core
+    defConfig["threading"]["frontEndCores"] = json::array();
+    defConfig["threading"]["realtimeAudio"] = false;
+
 #ifdef __ANDROID__
     defConfig["lockMenuOrder"] = true;
 #else
@@ -3,8 +3,16 @@
 #include <thread>
 #include <vector>
 #include <algorithm>
+#include <string>
+#include <atomic>
 #include "stream.h"
 #include "types.h"
+#include "executor.h"
+#include <utils/threading.h>
+
+// Maximum number of buffers a block processes each time it's run by an executor, so that
+// a busy block can't starve the others
+#define BLOCK_MAX_EXECUTOR_RUNS 4
 
 namespace dsp {
     class generic_block {
@@ -12,9 +20,10 @@ namespace dsp {
         virtual void start() {}
         virtual void stop() {}
         virtual int run() { return -1; }
+        virtual void setExecutor(Executor* executor) {}
     };
 
-    class block : public generic_block {
+    class block : public generic_block, public Executor::Task {
     public:
         virtual void init() {}
 
@@ -64,16 +73,69 @@ namespace dsp {
 
         virtual int run() = 0;
 
+        // Blocks that consume at most one buffer from each input and produce at most one into
+        // each output per call to run() can be run by an executor instead of their own thread
+        virtual bool isSchedulable() { return false; }
+
+        // Runs the block on the executor, or on its own thread again if NULL. Ignored if the
+        // block isn't schedulable or the executor isn't running.
+        virtual void setExecutor(Executor* executor) {
+            assert(_block_init);
+            std::lock_guard<std::recursive_mutex> lck(ctrlMtx);
+            tempStop();
+            _executor = executor;
+            tempStart();
+        }
+
+        // Options for the worker thread, applied the next time it's started
+        void setThreadOptions(std::string name, std::vector<int> cores = {}, threading::Priority priority = threading::PRIORITY_NORMAL) {
+            std::lock_guard<std::recursive_mutex> lck(ctrlMtx);
+            threadName = name;
+            threadCores = cores;
+            threadPriority = priority;
+        }
+
     protected:
         void workerLoop() {
+            if (!threadName.empty()) { threading::setName(threadName); }
+            if (!threadCores.empty()) { threading::setAffinity(threadCores); }
+            if (threadPriority != threading::PRIORITY_NORMAL) { threading::setPriority(threadPriority); }
             while (run() >= 0) {}
         }
 
         virtual void doStart() {
+            if (_executor && _executor->isRunning() && isSchedulable()) {
+                scheduled = true;
+                for (auto& in : inputs) {
+                    in->setReaderHandler(&block::onStreamReady, this);
+                }
+                for (auto& out : outputs) {
+                    out->setWriterHandler(&block::onStreamReady, this);
+                }
+
+                // Data may already be waiting
+                _executor->schedule(this);
+                return;
+            }
             workerThread = std::thread(&block::workerLoop, this);
         }
 
         virtual void doStop() {
+            if (scheduled) {
+                taskStop = true;
+                for (auto& in : inputs) {
+                    in->setReaderHandler(NULL, NULL);
+                }
+                for (auto& out : outputs) {
+                    out->setWriterHandler(NULL, NULL);
+                }
+                _executor->cancel(this);
+                taskStop = false;
+                scheduled = false;
+                return;
+            }
+
+
             for (auto& in : inputs) {
                 in->stopReader();
             }
@@ -118,6 +180,26 @@ namespace dsp {
             outputs.erase(std::remove(outputs.begin(), outputs.end(), outStream), outputs.end());
         }
 
+        bool execute() {
+            for (int i = 0; i < BLOCK_MAX_EXECUTOR_RUNS; i++) {
+                // Only run when neither reading nor swapping would wait
+                if (taskStop) { return false; }
+                for (auto& in : inputs) {
+                    if (!in->isDataReady()) { return false; }
+                }
+                for (auto& out : outputs) {
+                    if (!out->canWrite()) { return false; }
+                }
+                if (run() < 0) { return false; }
+            }
+            return true;
+        }
+
+        static void onStreamReady(void* ctx) {
+            block* _this = (block*)ctx;
+            _this->_executor->schedule(_this);
+        }
+
         bool _block_init = false;
 
         std::recursive_mutex ctrlMtx;
@@ -129,5 +211,13 @@ namespace dsp {
         bool tempStopped = false;
         int tempStopDepth = 0;
         std::thread workerThread;
+
+        std::string threadName;
+        std::vector<int> threadCores;
+        threading::Priority threadPriority = threading::PRIORITY_NORMAL;
+
+        Executor* _executor = NULL;
+        bool scheduled = false;
+        std::atomic<bool> taskStop = false;
     };
 }
\ No newline at end of file
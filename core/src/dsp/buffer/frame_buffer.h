@@ -54,7 +54,10 @@ namespace dsp::buffer {
             if (count < 0) { return -1; }
 
             if (bypass) {
-                memcpy(out.writeBuf, _in->readBuf, count * sizeof(T));
+                // Hand the filled input buffer straight to the output instead of copying it
+                if (!exchange(_in->readBuf, _in->getBufferSize(), out.writeBuf, out.getBufferSize(), count)) {
+                    memcpy(out.writeBuf, _in->readBuf, count * sizeof(T));
+                }
                 _in->flush();
                 if (!out.swap(count)) { return -1; }
                 return count;
@@ -63,7 +66,9 @@ namespace dsp::buffer {
             // Push it on the ring buffer
             {
                 std::lock_guard<std::mutex> lck(bufMtx);
-                memcpy(buffers[writeCur], _in->readBuf, count * sizeof(T));
+                if (!exchange(buffers[writeCur], STREAM_BUFFER_SIZE, _in->readBuf, _in->getBufferSize(), count)) {
+                    memcpy(buffers[writeCur], _in->readBuf, count * sizeof(T));
+                }
                 sizes[writeCur] = count;
                 writeCur++;
                 writeCur = ((writeCur) % TEST_BUFFER_SIZE);
@@ -84,9 +89,11 @@ namespace dsp::buffer {
                 cnd.wait(lck, [this]() { return (((writeCur - readCur + TEST_BUFFER_SIZE) % TEST_BUFFER_SIZE) > 0) || stopWorker; });
                 if (stopWorker) { break; }
 
-                // Write one to output buffer and unlock in preparation to swap buffers
+                // Move one to output buffer and unlock in preparation to swap buffers
                 int count = sizes[readCur];
-                memcpy(out.writeBuf, buffers[readCur], count * sizeof(T));
+                if (!exchange(out.writeBuf, out.getBufferSize(), buffers[readCur], STREAM_BUFFER_SIZE, count)) {
+                    memcpy(out.writeBuf, buffers[readCur], count * sizeof(T));
+                }
                 readCur++;
                 readCur = ((readCur) % TEST_BUFFER_SIZE);
                 lck.unlock();
@@ -104,6 +111,15 @@ namespace dsp::buffer {
         bool bypass = false;
 
     private:
+        // Moves the content of src into dst by exchanging the buffer pointers. This is only
+        // done when both buffers have the same capacity so that every buffer in circulation
+        // stays interchangeable. Returns false if the caller needs to copy instead.
+        static inline bool exchange(T*& dst, int dstSize, T*& src, int srcSize, int count) {
+            if (dstSize != srcSize || count > dstSize) { return false; }
+            std::swap(dst, src);
+            return true;
+        }
+
         void doStart() {
             base_type::workerThread = std::thread(&SampleFrameBuffer<T>::workerLoop, this);
             readWorkerThread = std::thread(&SampleFrameBuffer<T>::worker, this);
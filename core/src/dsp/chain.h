@@ -159,6 +159,13 @@ namespace dsp {
             running = false;
         }
 
+        // Runs all blocks of the chain on the executor, or on their own threads if NULL
+        void setExecutor(Executor* executor) {
+            for (auto& ln : links) {
+                ln->setExecutor(executor);
+            }
+        }
+
         stream<T>* out;
 
     private:
@@ -99,6 +99,8 @@ namespace dsp::channel {
             return count;
         }
 
+        bool isSchedulable() { return true; }
+
         int run() {
             int count = base_type::_in->read();
             if (count < 0) { return -1; }
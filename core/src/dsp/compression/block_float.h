@@ -0,0 +1,266 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <volk/volk.h>
+#include "../types.h"
+
+// Number of complex samples sharing one exponent
+#define BFP_BLOCK_SIZE      64
+#define BFP_MIN_BITS        4
+#define BFP_MAX_BITS        16
+#define BFP_FLAG_DELTA      (1 << 0)
+#define BFP_ZERO_EXPONENT   INT8_MIN
+
+namespace dsp::compression::bfp {
+    // Packs signed values into a little-endian bit stream, width bits each. Values are
+    // expected to already be in range. Returns the number of bytes written.
+    inline int pack(const int16_t* in, uint8_t* out, int count, int bits) {
+        if (bits == 16) {
+            memcpy(out, in, count * sizeof(int16_t));
+            return count * sizeof(int16_t);
+        }
+        if (bits == 8) {
+            for (int i = 0; i < count; i++) { out[i] = in[i]; }
+            return count;
+        }
+
+        int i = 0;
+        int o = 0;
+        if (bits == 12) {
+            // Two values in three bytes
+            for (; i + 1 < count; i += 2) {
+                uint16_t a = in[i] & 0xFFF;
+                uint16_t b = in[i + 1] & 0xFFF;
+                out[o++] = a;
+                out[o++] = (a >> 8) | (b << 4);
+                out[o++] = b >> 4;
+            }
+        }
+        else if (bits == 10) {
+            // Four values in five bytes
+            for (; i + 3 < count; i += 4) {
+                uint64_t v = (uint64_t)(in[i] & 0x3FF) | ((uint64_t)(in[i + 1] & 0x3FF) << 10) | ((uint64_t)(in[i + 2] & 0x3FF) << 20) | ((uint64_t)(in[i + 3] & 0x3FF) << 30);
+                out[o++] = v;
+                out[o++] = v >> 8;
+                out[o++] = v >> 16;
+                out[o++] = v >> 24;
+                out[o++] = v >> 32;
+            }
+        }
+
+        // Generic path for other widths. Eight values always fill exactly `bits` bytes, so they
+        // are packed in groups without any per-value branching.
+        uint32_t mask = (1u << bits) - 1;
+        for (; i + 7 < count; i += 8) {
+            uint64_t lo = 0;
+            uint64_t hi = 0;
+            for (int j = 0; j < 8; j++) {
+                uint64_t v = in[i + j] & mask;
+                int pos = j * bits;
+                if (pos >= 64) { hi |= v << (pos - 64); }
+                else {
+                    lo |= v << pos;
+                    if (pos + bits > 64) { hi |= v >> (64 - pos); }
+                }
+            }
+            memcpy(&out[o], &lo, std::min<int>(bits, 8));
+            if (bits > 8) { memcpy(&out[o + 8], &hi, bits - 8); }
+            o += bits;
+        }
+
+        // Remainder
+        uint64_t acc = 0;
+        int accBits = 0;
+        for (; i < count; i++) {
+            acc |= (uint64_t)(in[i] & mask) << accBits;
+            accBits += bits;
+            while (accBits >= 8) {
+                out[o++] = acc;
+                acc >>= 8;
+                accBits -= 8;
+            }
+        }
+        if (accBits) { out[o++] = acc; }
+        return o;
+    }
+
+    // Inverse of pack(), sign extends each value. Returns the number of bytes read.
+    inline int unpack(const uint8_t* in, int16_t* out, int count, int bits) {
+        if (bits == 16) {
+            memcpy(out, in, count * sizeof(int16_t));
+            return count * sizeof(int16_t);
+        }
+        if (bits == 8) {
+            for (int i = 0; i < count; i++) { out[i] = (int8_t)in[i]; }
+            return count;
+        }
+
+        int i = 0;
+        int o = 0;
+        if (bits == 12) {
+            for (; i + 1 < count; i += 2) {
+                uint16_t a = in[o] | ((in[o + 1] & 0xF) << 8);
+                uint16_t b = (in[o + 1] >> 4) | (in[o + 2] << 4);
+                out[i] = (int16_t)(a << 4) >> 4;
+                out[i + 1] = (int16_t)(b << 4) >> 4;
+                o += 3;
+            }
+        }
+        else if (bits == 10) {
+            for (; i + 3 < count; i += 4) {
+                uint64_t v = (uint64_t)in[o] | ((uint64_t)in[o + 1] << 8) | ((uint64_t)in[o + 2] << 16) | ((uint64_t)in[o + 3] << 24) | ((uint64_t)in[o + 4] << 32);
+                out[i] = (int16_t)((v & 0x3FF) << 6) >> 6;
+                out[i + 1] = (int16_t)(((v >> 10) & 0x3FF) << 6) >> 6;
+                out[i + 2] = (int16_t)(((v >> 20) & 0x3FF) << 6) >> 6;
+                out[i + 3] = (int16_t)(((v >> 30) & 0x3FF) << 6) >> 6;
+                o += 5;
+            }
+        }
+
+        uint32_t mask = (1u << bits) - 1;
+        int shift = 16 - bits;
+        for (; i + 7 < count; i += 8) {
+            uint64_t lo = 0;
+            uint64_t hi = 0;
+            memcpy(&lo, &in[o], std::min<int>(bits, 8));
+            if (bits > 8) { memcpy(&hi, &in[o + 8], bits - 8); }
+            for (int j = 0; j < 8; j++) {
+                int pos = j * bits;
+                uint64_t v;
+                if (pos >= 64) { v = hi >> (pos - 64); }
+                else {
+                    v = lo >> pos;
+                    if (pos + bits > 64) { v |= hi << (64 - pos); }
+                }
+                out[i + j] = (int16_t)((v & mask) << shift) >> shift;
+            }
+            o += bits;
+        }
+
+        uint64_t acc = 0;
+        int accBits = 0;
+        for (; i < count; i++) {
+            while (accBits < bits) {
+                acc |= (uint64_t)in[o++] << accBits;
+                accBits += 8;
+            }
+            out[i] = (int16_t)((acc & mask) << shift) >> shift;
+            acc >>= bits;
+            accBits -= bits;
+        }
+        return o;
+    }
+
+    // Largest absolute value. It works on the IEEE bit patterns, which order like the values once
+    // the sign is cleared, so that the reduction vectorizes. Infinities and NaNs come out on top.
+    inline float maxAbs(const float* vals, int count) {
+        uint32_t max = 0;
+        for (int i = 0; i < count; i++) {
+            uint32_t v;
+            memcpy(&v, &vals[i], sizeof(uint32_t));
+            max = std::max<uint32_t>(max, v & 0x7FFFFFFF);
+        }
+        float ret;
+        memcpy(&ret, &max, sizeof(float));
+        return ret;
+    }
+
+    // Maximum number of bytes encode() can generate for a given sample count
+    inline int maxEncodedSize(int count) {
+        int blocks = (count + BFP_BLOCK_SIZE - 1) / BFP_BLOCK_SIZE;
+        return 8 + (blocks * (1 + ((BFP_BLOCK_SIZE * 2 * BFP_MAX_BITS) / 8)));
+    }
+
+    // Encodes samples as blocks sharing an exponent, each followed by its bit-packed mantissas.
+    // Data that already has at most `bits` bits of resolution is reproduced exactly.
+    inline int encode(int count, int bits, bool delta, const complex_t* in, uint8_t* out) {
+        bits = std::clamp<int>(bits, BFP_MIN_BITS, delta ? (BFP_MAX_BITS - 1) : BFP_MAX_BITS);
+        int packBits = delta ? (bits + 1) : bits;
+        int16_t qMax = (1 << (bits - 1)) - 1;
+        int16_t qMin = -(1 << (bits - 1));
+        int16_t quant[BFP_BLOCK_SIZE * 2];
+        int16_t diff[BFP_BLOCK_SIZE * 2];
+
+        // Stream header
+        *(uint32_t*)&out[0] = count;
+        out[4] = bits;
+        out[5] = delta ? BFP_FLAG_DELTA : 0;
+        *(uint16_t*)&out[6] = BFP_BLOCK_SIZE;
+        int o = 8;
+
+        for (int b = 0; b < count; b += BFP_BLOCK_SIZE) {
+            int n = std::min<int>(BFP_BLOCK_SIZE, count - b) * 2;
+            const float* vals = (const float*)&in[b];
+
+            // Find the largest absolute value of the block
+            float maxVal = maxAbs(vals, n);
+            if (maxVal == 0.0f || !isfinite(maxVal)) {
+                out[o++] = (uint8_t)BFP_ZERO_EXPONENT;
+                continue;
+            }
+
+            // Smallest exponent such that maxVal <= 2^exp
+            int exp;
+            float frac = frexpf(maxVal, &exp);
+            if (frac == 0.5f) { exp--; }
+            exp = std::clamp<int>(exp, INT8_MIN + 1, INT8_MAX);
+            out[o++] = (int8_t)exp;
+
+            // Quantize and clamp the one value that can reach 2^(bits-1)
+            volk_32f_s32f_convert_16i(quant, vals, ldexpf(1.0f, bits - 1 - exp), n);
+            for (int i = 0; i < n; i++) { quant[i] = std::clamp<int16_t>(quant[i], qMin, qMax); }
+
+            // Delta code each component against its previous value
+            if (delta) {
+                diff[0] = quant[0];
+                diff[1] = quant[1];
+                for (int i = 2; i < n; i++) { diff[i] = quant[i] - quant[i - 2]; }
+                o += pack(diff, &out[o], n, packBits);
+                continue;
+            }
+
+            o += pack(quant, &out[o], n, packBits);
+        }
+
+        return o;
+    }
+
+    // Decodes a buffer generated by encode(). Returns the number of samples or -1 if invalid.
+    inline int decode(int len, const uint8_t* in, complex_t* out, int maxCount) {
+        if (len < 8) { return -1; }
+        int count = *(uint32_t*)&in[0];
+        int bits = in[4];
+        bool delta = in[5] & BFP_FLAG_DELTA;
+        int blockSize = *(uint16_t*)&in[6];
+        if (count > maxCount || bits < BFP_MIN_BITS || bits > BFP_MAX_BITS || blockSize <= 0 || blockSize > BFP_BLOCK_SIZE) { return -1; }
+        int packBits = delta ? (bits + 1) : bits;
+        if (packBits > BFP_MAX_BITS) { return -1; }
+        int16_t quant[BFP_BLOCK_SIZE * 2];
+        int i = 8;
+
+        for (int b = 0; b < count; b += blockSize) {
+            int n = std::min<int>(blockSize, count - b) * 2;
+            float* vals = (float*)&out[b];
+            if (i >= len) { return -1; }
+            int8_t exp = in[i++];
+
+            if (exp == BFP_ZERO_EXPONENT) {
+                memset(vals, 0, n * sizeof(float));
+                continue;
+            }
+
+            if (i + ((n * packBits) + 7) / 8 > len) { return -1; }
+            i += unpack(&in[i], quant, n, packBits);
+
+            if (delta) {
+                for (int j = 2; j < n; j++) { quant[j] += quant[j - 2]; }
+            }
+
+            volk_16i_s32f_convert_32f(vals, quant, ldexpf(1.0f, bits - 1 - exp), n);
+        }
+
+        return count;
+    }
+}
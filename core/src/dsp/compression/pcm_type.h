@@ -4,6 +4,7 @@ namespace dsp::compression {
     enum PCMType {
         PCM_TYPE_I8,
         PCM_TYPE_I16,
-        PCM_TYPE_F32
+        PCM_TYPE_F32,
+        PCM_TYPE_BFP
     };
 }
\ No newline at end of file
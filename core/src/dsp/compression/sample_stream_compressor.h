@@ -1,6 +1,8 @@
 #pragma once
 #include "../processor.h"
 #include "pcm_type.h"
+#include "block_float.h"
+#include <atomic>
 
 namespace dsp::compression {
     class SampleStreamCompressor : public Processor<complex_t, uint8_t> {
@@ -13,17 +15,28 @@ namespace dsp::compression {
         void init(stream<complex_t>* in, PCMType pcmType) {
             _pcmType = pcmType;
             base_type::init(in);
+
+            // Float32 samples plus the header don't fit in a default sized buffer
+            base_type::out.setBufferSize((sizeof(complex_t) * STREAM_BUFFER_SIZE) + 8);
         }
 
+        // Takes effect on the next buffer, so it can be called from the thread consuming the output
         void setPCMType(PCMType pcmType) {
+            assert(base_type::_block_init);
+            _pcmType = pcmType;
+        }
+
+        // Only used by the block floating point type
+        void setBitDepth(int bits, bool deltaCoding = false) {
             assert(base_type::_block_init);
             std::lock_guard<std::recursive_mutex> lck(base_type::ctrlMtx);
             base_type::tempStop();
-            _pcmType = pcmType;
+            _bits = bits;
+            _deltaCoding = deltaCoding;
             base_type::tempStart();
         }
 
-        inline static int process(int count, PCMType pcmType, const complex_t* in, uint8_t* out) {
+        inline static int process(int count, PCMType pcmType, const complex_t* in, uint8_t* out, int bits = 12, bool deltaCoding = false) {
             uint16_t* compressionType = (uint16_t*)out;
             uint16_t* sampleType = (uint16_t*)&out[2];
             float* scaler = (float*)&out[4];
@@ -40,10 +53,17 @@ namespace dsp::compression {
                 return 8 + (count * sizeof(complex_t));
             }
 
-            // Find maximum value
+            // Block floating point carries its own scaling
+            if (pcmType == PCMType::PCM_TYPE_BFP) {
+                *scaler = 0;
+                return 8 + bfp::encode(count, bits, deltaCoding, in, (uint8_t*)dataBuf);
+            }
+
+            // Find maximum amplitude, no component can be larger than it
             uint32_t maxIdx;
-            volk_32f_index_max_32u(&maxIdx, (float*)in, count * 2);
-            float maxVal = ((float*)in)[maxIdx];
+            volk_32fc_index_max_32u(&maxIdx, (lv_32fc_t*)in, count);
+            float maxVal = sqrtf((in[maxIdx].re * in[maxIdx].re) + (in[maxIdx].im * in[maxIdx].im));
+            if (maxVal == 0.0f) { maxVal = 1.0f; }
             *scaler = maxVal;
 
             // Convert to the right type and send it out (sign bit determines pcm type)
@@ -63,7 +83,7 @@ namespace dsp::compression {
             int count = base_type::_in->read();
             if (count < 0) { return -1; }
 
-            int outCount = process(count, _pcmType, base_type::_in->readBuf, base_type::out.writeBuf);
+            int outCount = process(count, _pcmType.load(), base_type::_in->readBuf, base_type::out.writeBuf, _bits, _deltaCoding);
 
             // Swap if some data was generated
             base_type::_in->flush();
@@ -74,6 +94,8 @@ namespace dsp::compression {
         }
 
     protected:
-        PCMType _pcmType;
+        std::atomic<PCMType> _pcmType;
+        int _bits = 12;
+        bool _deltaCoding = false;
     };
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 #include "../processor.h"
 #include "pcm_type.h"
+#include "block_float.h"
 
 namespace dsp::compression {
     class SampleStreamDecompressor : public Processor<uint8_t, complex_t> {
@@ -29,6 +30,10 @@ namespace dsp::compression {
                 volk_8i_s32f_convert_32f((float*)out, (int8_t*)dataBuf, 128.0f / scaler, outCount * 2);
                 return outCount;
             }
+            else if (sampleType == PCMType::PCM_TYPE_BFP) {
+                int outCount = bfp::decode(count - 8, (const uint8_t*)dataBuf, out, base_type::out.getBufferSize());
+                return std::max<int>(outCount, 0);
+            }
             
             return 0;
         }
@@ -0,0 +1,71 @@
+#pragma once
+#include <vector>
+#include <stdint.h>
+#include <algorithm>
+
+namespace dsp::detector {
+    // Cell averaging CFAR detector over a spectrum in dB. The noise level of each bin is the
+    // mean of the training cells on both sides of it, skipping the guard cells around it.
+    // A running prefix sum makes the cost O(1) per bin regardless of the window size.
+    class CFAR {
+    public:
+        CFAR() {}
+
+        CFAR(int guard, int training, float threshold) { init(guard, training, threshold); }
+
+        void init(int guard, int training, float threshold) {
+            _guard = std::max<int>(guard, 0);
+            _training = std::max<int>(training, 1);
+            _threshold = threshold;
+        }
+
+        void setGuard(int guard) {
+            _guard = std::max<int>(guard, 0);
+        }
+
+        void setTraining(int training) {
+            _training = std::max<int>(training, 1);
+        }
+
+        void setThreshold(float threshold) {
+            _threshold = threshold;
+        }
+
+        // Sets the mask entry of every bin at least threshold dB above its neighbourhood and
+        // optionally writes the estimated noise level of each bin. Returns the detected bin count.
+        int process(const float* levels, int count, uint8_t* mask, float* noise = NULL) {
+            if (count <= 0) { return 0; }
+            if (sums.size() < count + 1) { sums.resize(count + 1); }
+
+            sums[0] = 0.0;
+            for (int i = 0; i < count; i++) { sums[i + 1] = sums[i] + levels[i]; }
+
+            int detected = 0;
+            for (int i = 0; i < count; i++) {
+                // Leading and lagging training windows, clipped to the edges of the spectrum
+                int lStart = std::max<int>(i - _guard - _training, 0);
+                int lEnd = std::max<int>(i - _guard, 0);
+                int rStart = std::min<int>(i + _guard + 1, count);
+                int rEnd = std::min<int>(i + _guard + _training + 1, count);
+                int cells = (lEnd - lStart) + (rEnd - rStart);
+
+                float level = levels[i];
+                if (cells > 0) {
+                    level = ((sums[lEnd] - sums[lStart]) + (sums[rEnd] - sums[rStart])) / (double)cells;
+                }
+
+                if (noise) { noise[i] = level; }
+                mask[i] = (levels[i] - level >= _threshold);
+                if (mask[i]) { detected++; }
+            }
+
+            return detected;
+        }
+
+    private:
+        std::vector<double> sums;
+        int _guard = 2;
+        int _training = 16;
+        float _threshold = 6.0f;
+    };
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include <vector>
+#include <stdint.h>
+#include <math.h>
+#include <algorithm>
+
+// Number of sub-window minima kept per bin, the tracking window is this times the sub-window length
+#define NOISE_FLOOR_SUBWINDOWS  8
+
+namespace dsp::detector {
+    // Tracks the noise floor of a set of bins (spectrum bins, channels or a single power
+    // measurement) using minimum statistics: each bin is smoothed, the minimum of every
+    // sub-window is kept and the floor is the smallest of the last few sub-window minima.
+    // Updates are O(1) per bin, amortized over the sub-window length. Levels are in dB.
+    class NoiseFloor {
+    public:
+        NoiseFloor() {}
+
+        NoiseFloor(int bins, int subWindow = 32, float smoothing = 0.3f) { init(bins, subWindow, smoothing); }
+
+        void init(int bins, int subWindow = 32, float smoothing = 0.3f) {
+            _subWindow = std::max<int>(subWindow, 1);
+            _smoothing = std::clamp<float>(smoothing, 0.0f, 1.0f);
+            states.assign(bins, State());
+            floors.assign(bins, NAN);
+        }
+
+        void setSubWindow(int subWindow) {
+            _subWindow = std::max<int>(subWindow, 1);
+        }
+
+        void setSmoothing(float smoothing) {
+            _smoothing = std::clamp<float>(smoothing, 0.0f, 1.0f);
+        }
+
+        void reset() {
+            std::fill(states.begin(), states.end(), State());
+            std::fill(floors.begin(), floors.end(), NAN);
+        }
+
+        // Moves the bins by offset so that new bin i is old bin i + offset, as when a spectrum
+        // gets retuned. Bins shifted in start over.
+        void shift(int offset) {
+            int count = states.size();
+            if (offset >= count || offset <= -count) {
+                reset();
+                return;
+            }
+            if (offset > 0) {
+                std::move(states.begin() + offset, states.end(), states.begin());
+                std::move(floors.begin() + offset, floors.end(), floors.begin());
+                std::fill(states.end() - offset, states.end(), State());
+                std::fill(floors.end() - offset, floors.end(), NAN);
+            }
+            else if (offset < 0) {
+                std::move_backward(states.begin(), states.end() + offset, states.end());
+                std::move_backward(floors.begin(), floors.end() + offset, floors.end());
+                std::fill(states.begin(), states.begin() - offset, State());
+                std::fill(floors.begin(), floors.begin() - offset, NAN);
+            }
+        }
+
+        // Feed a new level for a bin
+        inline void update(int bin, float level) {
+            State& s = states[bin];
+            if (isnan(s.smoothed)) {
+                s.smoothed = level;
+                s.current = level;
+                s.min = level;
+                std::fill(s.mins, s.mins + NOISE_FLOOR_SUBWINDOWS, level);
+            }
+            else {
+                s.smoothed += _smoothing * (level - s.smoothed);
+                s.current = std::min<float>(s.current, s.smoothed);
+            }
+
+            // End of sub-window, rotate the minima
+            if (++s.count >= _subWindow) {
+                s.mins[s.head] = s.current;
+                s.head = (s.head + 1) % NOISE_FLOOR_SUBWINDOWS;
+                s.min = s.mins[0];
+                for (int i = 1; i < NOISE_FLOOR_SUBWINDOWS; i++) { s.min = std::min<float>(s.min, s.mins[i]); }
+                s.current = s.smoothed;
+                s.count = 0;
+            }
+
+            floors[bin] = std::min<float>(s.min, s.current);
+        }
+
+        // Feed a level for a bin known to contain a signal, the floor is only allowed to drop
+        inline void hold(int bin, float level) {
+            float floor = floors[bin];
+            update(bin, isnan(floor) ? level : std::min<float>(level, floor));
+        }
+
+        // Feed a level for every bin, bins with a non-zero mask entry are held instead of updated
+        void update(const float* levels, const uint8_t* mask = NULL) {
+            int count = states.size();
+            if (mask) {
+                for (int i = 0; i < count; i++) {
+                    if (mask[i]) { hold(i, levels[i]); }
+                    else { update(i, levels[i]); }
+                }
+            }
+            else {
+                for (int i = 0; i < count; i++) { update(i, levels[i]); }
+            }
+        }
+
+        inline float operator[](int bin) const { return floors[bin]; }
+
+        inline const float* data() const { return floors.data(); }
+
+        inline int size() const { return floors.size(); }
+
+    private:
+        struct State {
+            float smoothed = NAN;
+            float current = NAN;    // Minimum of the running sub-window
+            float min = NAN;        // Minimum of the completed sub-windows
+            float mins[NOISE_FLOOR_SUBWINDOWS];
+            int count = 0;
+            int head = 0;
+        };
+
+        std::vector<State> states;
+        std::vector<float> floors;
+        int _subWindow = 32;
+        float _smoothing = 0.3f;
+    };
+}
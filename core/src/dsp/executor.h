@@ -0,0 +1,250 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <string>
+#include <chrono>
+#include <utils/threading.h>
+
+namespace dsp {
+    // Work-stealing thread pool running blocks as tasks whenever they have something to do,
+    // instead of dedicating a thread to each of them. Tasks are picked from the worker's own
+    // queue first and stolen from the others when it's empty.
+    class Executor {
+    public:
+        class Task {
+        public:
+            virtual ~Task() {}
+
+        protected:
+            // Does the pending work, returns true if the task should be run again right away
+            virtual bool execute() = 0;
+
+        private:
+            friend class Executor;
+            std::atomic<int> taskState = TASK_IDLE;
+        };
+
+        Executor() {}
+
+        Executor(int workerCount, std::string name = "dsp_exec", std::vector<int> cores = {}) { init(workerCount, name, cores); }
+
+        ~Executor() { stop(); }
+
+        // Starts the workers, 0 uses one worker per physical core. If cores are given the
+        // workers are pinned to them in a round-robin fashion.
+        void init(int workerCount = 0, std::string name = "dsp_exec", std::vector<int> cores = {}) {
+            if (running) { return; }
+            if (workerCount <= 0) { workerCount = threading::physicalCoreCount(); }
+            _name = name;
+            _cores = cores;
+            stopping = false;
+            queued = 0;
+            nextQueue = 0;
+            queues.clear();
+            for (int i = 0; i < workerCount; i++) { queues.push_back(std::make_unique<WorkerQueue>()); }
+            for (int i = 0; i < workerCount; i++) { workers.push_back(std::thread(&Executor::worker, this, i)); }
+            running = true;
+        }
+
+        // Stops the workers once all queued tasks were run, nothing may be scheduled anymore
+        void stop() {
+            if (!running) { return; }
+            {
+                std::lock_guard<std::mutex> lck(sleepMtx);
+                stopping = true;
+            }
+            sleepCV.notify_all();
+            for (auto& w : workers) {
+                if (w.joinable()) { w.join(); }
+            }
+            workers.clear();
+            running = false;
+        }
+
+        bool isRunning() { return running; }
+
+        int getWorkerCount() { return workers.size(); }
+
+        // Requests a run of the task, can be called from any thread. A task is never run by
+        // two workers at once and a request made while it runs makes it run once more after.
+        void schedule(Task* task) {
+            int state = task->taskState.load();
+            while (true) {
+                if (state == TASK_QUEUED || state == TASK_RUNNING_DIRTY) { return; }
+                int next = (state == TASK_IDLE) ? TASK_QUEUED : TASK_RUNNING_DIRTY;
+                if (!task->taskState.compare_exchange_weak(state, next)) { continue; }
+                if (next == TASK_QUEUED) { push(task); }
+                return;
+            }
+        }
+
+        // Waits until the task is neither queued nor running. The caller must make sure
+        // nothing schedules it anymore. From inside the task itself this returns right away,
+        // and other workers of this executor keep running queued tasks while they wait so
+        // that the task can't end up stuck behind them.
+        void cancel(Task* task) {
+            if (currentExecutor() == this) {
+                if (currentTask() == task) { return; }
+                while (task->taskState.load() != TASK_IDLE) {
+                    Task* other = claim(false);
+                    if (other) {
+                        run(other);
+                        continue;
+                    }
+                    waitIdle(task, false);
+                }
+                return;
+            }
+
+            waitIdle(task, true);
+        }
+
+    private:
+        enum TaskState {
+            TASK_IDLE,
+            TASK_QUEUED,
+            TASK_RUNNING,
+            TASK_RUNNING_DIRTY
+        };
+
+        struct WorkerQueue {
+            std::mutex mtx;
+            std::deque<Task*> tasks;
+        };
+
+        void push(Task* task) {
+            // Workers keep the tasks they schedule to themselves to stay cache friendly,
+            // other threads spread them across the queues
+            int id = (currentExecutor() == this) ? currentWorker() : (nextQueue++ % queues.size());
+            {
+                std::lock_guard<std::mutex> lck(queues[id]->mtx);
+                queues[id]->tasks.push_back(task);
+            }
+            {
+                std::lock_guard<std::mutex> lck(sleepMtx);
+                queued++;
+            }
+            sleepCV.notify_one();
+        }
+
+        Task* pop(int id) {
+            // Newest task of our own queue first
+            {
+                std::lock_guard<std::mutex> lck(queues[id]->mtx);
+                if (!queues[id]->tasks.empty()) {
+                    Task* task = queues[id]->tasks.back();
+                    queues[id]->tasks.pop_back();
+                    return task;
+                }
+            }
+
+            // Otherwise steal the oldest task of another worker
+            int count = queues.size();
+            for (int i = 1; i < count; i++) {
+                WorkerQueue* q = queues[(id + i) % count].get();
+                std::lock_guard<std::mutex> lck(q->mtx);
+                if (!q->tasks.empty()) {
+                    Task* task = q->tasks.front();
+                    q->tasks.pop_front();
+                    return task;
+                }
+            }
+            return NULL;
+        }
+
+        // Claims a queued task for the calling worker, waiting for one if asked to.
+        // Returns NULL if there is none or if the executor is stopping.
+        Task* claim(bool wait) {
+            {
+                std::unique_lock<std::mutex> lck(sleepMtx);
+                if (wait) { sleepCV.wait(lck, [this] { return (queued > 0 || stopping); }); }
+                if (!queued) { return NULL; }
+                queued--;
+            }
+
+            // The claimed task is already in one of the queues, but it may have to be found again
+            // if another worker took this one first
+            Task* task;
+            while (!(task = pop(currentWorker()))) { std::this_thread::yield(); }
+            return task;
+        }
+
+        void run(Task* task) {
+            Task* prev = currentTask();
+            currentTask() = task;
+            task->taskState = TASK_RUNNING;
+            bool again = task->execute();
+            currentTask() = prev;
+
+            // Go back to idle unless the task asked for more or was scheduled while running
+            int state = TASK_RUNNING;
+            if (!again && task->taskState.compare_exchange_strong(state, TASK_IDLE)) {
+                if (idleWaiters.load()) {
+                    std::lock_guard<std::mutex> lck(idleMtx);
+                    idleCV.notify_all();
+                }
+                return;
+            }
+            task->taskState = TASK_QUEUED;
+            push(task);
+        }
+
+        // Waits for the task to go idle, or for a short while only if forever is false
+        void waitIdle(Task* task, bool forever) {
+            idleWaiters++;
+            {
+                std::unique_lock<std::mutex> lck(idleMtx);
+                auto idle = [task] { return task->taskState.load() == TASK_IDLE; };
+                if (forever) { idleCV.wait(lck, idle); }
+                else { idleCV.wait_for(lck, std::chrono::microseconds(100), idle); }
+            }
+            idleWaiters--;
+        }
+
+        void worker(int id) {
+            currentExecutor() = this;
+            currentWorker() = id;
+            threading::setName(_name + "_" + std::to_string(id));
+            if (!_cores.empty()) { threading::setAffinity({ _cores[id % _cores.size()] }); }
+
+            while (Task* task = claim(true)) { run(task); }
+        }
+
+        static Executor*& currentExecutor() {
+            static thread_local Executor* exec = NULL;
+            return exec;
+        }
+
+        static int& currentWorker() {
+            static thread_local int id = 0;
+            return id;
+        }
+
+        static Task*& currentTask() {
+            static thread_local Task* task = NULL;
+            return task;
+        }
+
+        std::string _name;
+        std::vector<int> _cores;
+        std::vector<std::unique_ptr<WorkerQueue>> queues;
+        std::vector<std::thread> workers;
+        std::atomic<unsigned int> nextQueue = 0;
+        bool running = false;
+
+        std::mutex sleepMtx;
+        std::condition_variable sleepCV;
+        int queued = 0;
+        bool stopping = false;
+
+        // Signalled when a task goes idle while someone is waiting in cancel()
+        std::mutex idleMtx;
+        std::condition_variable idleCV;
+        std::atomic<int> idleWaiters = 0;
+    };
+}
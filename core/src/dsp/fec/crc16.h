@@ -0,0 +1,35 @@
+#pragma once
+#include <stdint.h>
+
+namespace dsp::fec {
+    // Table driven CRC-16, MSB first with neither reflection nor final XOR
+    class CRC16 {
+    public:
+        CRC16() {}
+
+        CRC16(uint16_t poly, uint16_t initValue) { init(poly, initValue); }
+
+        void init(uint16_t poly, uint16_t initValue) {
+            _initValue = initValue;
+            for (int i = 0; i < 256; i++) {
+                uint16_t crc = i << 8;
+                for (int j = 0; j < 8; j++) {
+                    crc = (crc & 0x8000) ? ((crc << 1) ^ poly) : (crc << 1);
+                }
+                table[i] = crc;
+            }
+        }
+
+        uint16_t compute(const uint8_t* data, int len) {
+            uint16_t crc = _initValue;
+            for (int i = 0; i < len; i++) {
+                crc = (crc << 8) ^ table[(crc >> 8) ^ data[i]];
+            }
+            return crc;
+        }
+
+    private:
+        uint16_t table[256];
+        uint16_t _initValue = 0;
+    };
+}
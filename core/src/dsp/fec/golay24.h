@@ -0,0 +1,65 @@
+#pragma once
+#include <stdint.h>
+
+namespace dsp::fec {
+    // Table driven decoder for the extended Golay(24, 12) code. Codewords hold the data in bits 23
+    // to 12, the check bits in bits 11 to 1 and the overall parity in bit 0.
+    class Golay24 {
+    public:
+        static constexpr uint16_t POLY = 0xC75;
+
+        Golay24() {
+            // The syndrome is linear in the codeword, so it's the XOR of the syndromes of its bytes
+            for (int i = 0; i < 3; i++) {
+                for (int j = 0; j < 256; j++) {
+                    syndromes[i][j] = serialSyndrome(((uint32_t)j << (i * 8)) & 0x7FFFFF);
+                }
+            }
+
+            // The Golay(23, 12) code is perfect, every syndrome matches exactly one error pattern of up to 3 bits
+            corrections[0] = 0;
+            for (int i = 0; i < 23; i++) {
+                corrections[serialSyndrome(1 << i)] = 1 << i;
+                for (int j = i + 1; j < 23; j++) {
+                    corrections[serialSyndrome((1 << i) | (1 << j))] = (1 << i) | (1 << j);
+                    for (int k = j + 1; k < 23; k++) {
+                        corrections[serialSyndrome((1 << i) | (1 << j) | (1 << k))] = (1 << i) | (1 << j) | (1 << k);
+                    }
+                }
+            }
+        }
+
+        // Corrects up to 3 errors, returns false if there were more
+        bool decode(uint32_t input, uint32_t& output) {
+            uint32_t codeword = (input >> 1) & 0x7FFFFF;
+            uint16_t syn = syndromes[0][codeword & 0xFF] ^ syndromes[1][(codeword >> 8) & 0xFF] ^ syndromes[2][codeword >> 16];
+            uint32_t correction = corrections[syn];
+            output = input ^ (correction << 1);
+
+            // The overall parity tells a third error apart from a fourth one
+            int errors = popcount(correction) + (popcount(output) & 1);
+            return errors <= 3;
+        }
+
+    private:
+        static uint16_t serialSyndrome(uint32_t codeword) {
+            for (int i = 0; i < 12; i++) {
+                if (codeword & 1) { codeword ^= POLY; }
+                codeword >>= 1;
+            }
+            return codeword;
+        }
+
+        static inline int popcount(uint32_t x) {
+            int count = 0;
+            while (x) {
+                x &= x - 1;
+                count++;
+            }
+            return count;
+        }
+
+        uint16_t syndromes[3][256];
+        uint32_t corrections[2048];
+    };
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+namespace dsp::fec {
+    // Soft decision Viterbi decoder for rate 1/2 convolutional codes of constraint length K.
+    // Soft bits are 0 for a certain zero, 255 for a certain one and 128 for an erasure.
+    // Polynomials use bit 0 for the current input bit, the encoder starts and ends in state zero.
+    template <int K>
+    class Viterbi {
+        static_assert(K >= 3 && K <= 9, "Unsupported constraint length");
+    public:
+        static constexpr int STATES = 1 << (K - 1);
+
+        Viterbi() {}
+
+        Viterbi(uint16_t polyA, uint16_t polyB) { init(polyA, polyB); }
+
+        void init(uint16_t polyA, uint16_t polyB) {
+            // Expected output of every branch, stored as a mask to invert the soft bits with
+            for (int s = 0; s < STATES; s++) {
+                for (int b = 0; b < 2; b++) {
+                    int reg = (s << 1) | b;
+                    maskA[b][s] = parity(reg & polyA) ? 0xFF : 0x00;
+                    maskB[b][s] = parity(reg & polyB) ? 0xFF : 0x00;
+                }
+            }
+        }
+
+        // Decodes bitCount input bits, including the K - 1 flush bits, from 2 * bitCount soft bits.
+        // The data bits are packed MSB first into out. Returns the metric of the best path, lower is better.
+        int decode(const uint8_t* soft, int bitCount, uint8_t* out) {
+            decisions.resize(bitCount * STATES);
+
+            // Only state zero is valid at the start
+            metrics[0] = 0;
+            for (int s = 1; s < STATES; s++) { metrics[s] = 0x3FFF; }
+
+            for (int t = 0; t < bitCount; t++) {
+                uint8_t a = soft[2 * t];
+                uint8_t b = soft[(2 * t) + 1];
+                uint8_t* dec = &decisions[t * STATES];
+
+                // Add-compare-select, written as butterflies without branches so that the compiler
+                // can process as many states per instruction as the target allows
+                for (int i = 0; i < STATES / 2; i++) {
+                    int hi = i + (STATES / 2);
+                    for (int bit = 0; bit < 2; bit++) {
+                        uint16_t m0 = metrics[i] + (uint8_t)(a ^ maskA[bit][i]) + (uint8_t)(b ^ maskB[bit][i]);
+                        uint16_t m1 = metrics[hi] + (uint8_t)(a ^ maskA[bit][hi]) + (uint8_t)(b ^ maskB[bit][hi]);
+                        uint8_t sel = (m1 < m0);
+                        next[(2 * i) + bit] = sel ? m1 : m0;
+                        dec[(2 * i) + bit] = sel;
+                    }
+                }
+
+                // Renormalize to keep the metrics from overflowing
+                uint16_t min = next[0];
+                for (int s = 1; s < STATES; s++) { min = (next[s] < min) ? next[s] : min; }
+                for (int s = 0; s < STATES; s++) { metrics[s] = next[s] - min; }
+                pathMetric += min;
+            }
+
+            // Trace back from state zero
+            int dataBits = bitCount - (K - 1);
+            memset(out, 0, (dataBits + 7) / 8);
+            int state = 0;
+            for (int t = bitCount - 1; t >= 0; t--) {
+                if (t < dataBits) { out[t / 8] |= (state & 1) << (7 - (t % 8)); }
+                state = (state >> 1) | (decisions[(t * STATES) + state] << (K - 2));
+            }
+
+            int result = pathMetric + metrics[0];
+            pathMetric = 0;
+            return result;
+        }
+
+    private:
+        static inline int parity(int x) {
+            int p = 0;
+            while (x) {
+                p ^= x & 1;
+                x >>= 1;
+            }
+            return p;
+        }
+
+        uint8_t maskA[2][STATES];
+        uint8_t maskB[2][STATES];
+        uint16_t metrics[STATES];
+        uint16_t next[STATES];
+        int pathMetric = 0;
+        std::vector<uint8_t> decisions;
+    };
+}
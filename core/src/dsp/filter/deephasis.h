@@ -78,6 +78,8 @@ namespace dsp::filter {
 
         //DEFAULT_PROC_RUN();
 
+        bool isSchedulable() { return true; }
+
         int run() {
             int count = base_type::_in->read();
             if (count < 0) { return -1; }
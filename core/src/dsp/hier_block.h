@@ -50,6 +50,14 @@ namespace dsp {
             }
         }
 
+        virtual void setExecutor(Executor* executor) {
+            assert(_block_init);
+            std::lock_guard<std::recursive_mutex> lck(ctrlMtx);
+            for (auto& block : blocks) {
+                block->setExecutor(executor);
+            }
+        }
+
     private:
         virtual void doStart() {
             for (auto& block : blocks) {
@@ -95,6 +95,8 @@ namespace dsp::multirate {
             return count;
         }
 
+        bool isSchedulable() { return true; }
+
         int run() {
             int count = base_type::_in->read();
             if (count < 0) { return -1; }
@@ -1,11 +1,17 @@
 #pragma once
 #include "../processor.h"
+#include "../detector/noise_floor.h"
 
 // TODO: Rewrite better!!!!!
 namespace dsp::noise_reduction {
     class Squelch : public Processor<complex_t, complex_t> {
         using base_type = Processor<complex_t, complex_t>;
     public:
+        enum Mode {
+            MODE_ABSOLUTE,  // Open above a fixed level
+            MODE_RELATIVE   // Open when the level is the given amount above the tracked noise floor
+        };
+
         Squelch() {}
 
         Squelch(stream<complex_t>* in, double level) {}
@@ -16,10 +22,14 @@ namespace dsp::noise_reduction {
             buffer::free(normBuffer);
         }
 
-        void init(stream<complex_t>* in, double level) {
+        void init(stream<complex_t>* in, double level, Mode mode = MODE_ABSOLUTE, double samplerate = 48000.0) {
             _level = level;
+            _mode = mode;
+            _samplerate = samplerate;
 
             normBuffer = buffer::alloc<float>(STREAM_BUFFER_SIZE);
+            floor.init(1, FLOOR_SUB_WINDOW);
+            generateUpdateInterval();
 
             base_type::init(in);
         }
@@ -30,13 +40,53 @@ namespace dsp::noise_reduction {
             _level = level;
         }
 
+        void setMode(Mode mode) {
+            assert(base_type::_block_init);
+            std::lock_guard<std::recursive_mutex> lck(base_type::ctrlMtx);
+            _mode = mode;
+            resetFloor();
+        }
+
+        void setSampleRate(double samplerate) {
+            assert(base_type::_block_init);
+            std::lock_guard<std::recursive_mutex> lck(base_type::ctrlMtx);
+            _samplerate = samplerate;
+            generateUpdateInterval();
+            resetFloor();
+        }
+
+        // Current noise floor estimate in dB, NAN until the relative mode has seen any samples
+        float getNoiseFloor() {
+            assert(base_type::_block_init);
+            std::lock_guard<std::recursive_mutex> lck(base_type::ctrlMtx);
+            return floor[0];
+        }
+
         inline int process(int count, const complex_t* in, complex_t* out) {
             float sum;
             volk_32fc_magnitude_32f(normBuffer, (lv_32fc_t*)in, count);
             volk_32f_accumulator_s32f(&sum, normBuffer, count);
-            sum /= (float)count;
 
-            if (10.0f * log10f(sum) >= _level) {
+            if (_mode == MODE_RELATIVE) {
+                // Feed the floor tracker at a fixed rate, holding it while the squelch is open
+                accSum += sum;
+                accCount += count;
+                if (accCount >= updateInterval) {
+                    float accLevel = 10.0f * log10f(accSum / (float)accCount);
+                    if (open) { floor.hold(0, accLevel); }
+                    else { floor.update(0, accLevel); }
+                    accSum = 0.0f;
+                    accCount = 0;
+                }
+
+                float level = 10.0f * log10f(sum / (float)count);
+                open = !isnan(floor[0]) && (level >= floor[0] + _level);
+            }
+            else {
+                open = (10.0f * log10f(sum / (float)count) >= _level);
+            }
+
+            if (open) {
                 memcpy(out, in, count * sizeof(complex_t));
             }
             else {
@@ -48,6 +98,8 @@ namespace dsp::noise_reduction {
 
         //DEFAULT_PROC_RUN();
 
+        bool isSchedulable() { return true; }
+
         int run() {
             int count = base_type::_in->read();
             if (count < 0) { return -1; }
@@ -58,8 +110,30 @@ namespace dsp::noise_reduction {
         }
 
     private:
+        void generateUpdateInterval() {
+            updateInterval = std::max<int>(_samplerate * FLOOR_UPDATE_PERIOD, 1);
+        }
+
+        void resetFloor() {
+            floor.reset();
+            accSum = 0.0f;
+            accCount = 0;
+            open = false;
+        }
+
+        // Floor updates every 10ms over sub-windows of 0.5s, so it follows a rising floor within about 4s
+        static constexpr double FLOOR_UPDATE_PERIOD = 0.01;
+        static constexpr int FLOOR_SUB_WINDOW = 50;
+
         float* normBuffer;
         float _level = -50.0f;
-                
+        Mode _mode = MODE_ABSOLUTE;
+        double _samplerate = 48000.0;
+
+        detector::NoiseFloor floor;
+        int updateInterval;
+        float accSum = 0.0f;
+        int accCount = 0;
+        bool open = false;
     };
-}
\ No newline at end of file
+}
@@ -5,6 +5,8 @@
 // This is needed because not all process functions have the same arguments
 
 #define OVERRIDE_PROC_RUN(exp)\
+    bool isSchedulable() { return true; }\
+    \
     int run() {\
         int count = _in->read();\
         if (count < 0) {\
@@ -19,6 +21,8 @@
     }
 
 #define OVERRIDE_MULTIRATE_PROC_RUN(exp)\
+    bool isSchedulable() { return true; }\
+    \
     int run() {\
         int count = _in->read();\
         if (count < 0) {\
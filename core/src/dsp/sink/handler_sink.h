@@ -16,6 +16,8 @@ namespace dsp::sink {
             base_type::init(in);
         }
 
+        bool isSchedulable() { return true; }
+
         int run() {
             int count = base_type::_in->read();
             if (count < 0) { return -1; }
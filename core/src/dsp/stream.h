@@ -18,6 +18,10 @@ namespace dsp {
         virtual void clearWriteStop() {}
         virtual void stopReader() {}
         virtual void clearReadStop() {}
+        virtual bool isDataReady() { return false; }
+        virtual bool canWrite() { return false; }
+        virtual void setReaderHandler(void (*handler)(void* ctx), void* ctx) {}
+        virtual void setWriterHandler(void (*handler)(void* ctx), void* ctx) {}
     };
 
     template <class T>
@@ -26,6 +30,7 @@ namespace dsp {
         stream() {
             writeBuf = buffer::alloc<T>(STREAM_BUFFER_SIZE);
             readBuf = buffer::alloc<T>(STREAM_BUFFER_SIZE);
+            bufferSize = STREAM_BUFFER_SIZE;
         }
 
         virtual ~stream() {
@@ -37,6 +42,13 @@ namespace dsp {
             buffer::free(readBuf);
             writeBuf = buffer::alloc<T>(samples);
             readBuf = buffer::alloc<T>(samples);
+            bufferSize = samples;
+        }
+
+        // Capacity of both writeBuf and readBuf in samples. Blocks that exchange
+        // buffer pointers with a stream instead of copying must check this first.
+        inline int getBufferSize() {
+            return bufferSize;
         }
 
         virtual inline bool swap(int size) {
@@ -60,6 +72,7 @@ namespace dsp {
             {
                 std::lock_guard<std::mutex> lck(rdyMtx);
                 dataReady = true;
+                if (readerHandler) { readerHandler(readerCtx); }
             }
             rdyCV.notify_all();
 
@@ -85,6 +98,7 @@ namespace dsp {
             {
                 std::lock_guard<std::mutex> lck(swapMtx);
                 canSwap = true;
+                if (writerHandler) { writerHandler(writerCtx); }
             }
 
             swapCV.notify_all();
@@ -114,6 +128,33 @@ namespace dsp {
             readerStop = false;
         }
 
+        // Non-blocking equivalents of read() and swap(), true if they wouldn't wait
+        virtual bool isDataReady() {
+            std::lock_guard<std::mutex> lck(rdyMtx);
+            return dataReady || readerStop;
+        }
+
+        virtual bool canWrite() {
+            std::lock_guard<std::mutex> lck(swapMtx);
+            return canSwap || writerStop;
+        }
+
+        // Called when data becomes ready for the reader, NULL to remove. The handler runs with the
+        // stream locked so it must only signal someone else and return. Once this returns, the
+        // previous handler is guaranteed to not be running anymore.
+        virtual void setReaderHandler(void (*handler)(void* ctx), void* ctx) {
+            std::lock_guard<std::mutex> lck(rdyMtx);
+            readerHandler = handler;
+            readerCtx = ctx;
+        }
+
+        // Same as setReaderHandler but called when the writer can swap again
+        virtual void setWriterHandler(void (*handler)(void* ctx), void* ctx) {
+            std::lock_guard<std::mutex> lck(swapMtx);
+            writerHandler = handler;
+            writerCtx = ctx;
+        }
+
         void free() {
             if (writeBuf) { buffer::free(writeBuf); }
             if (readBuf) { buffer::free(readBuf); }
@@ -136,6 +177,12 @@ namespace dsp {
         bool readerStop = false;
         bool writerStop = false;
 
+        void (*readerHandler)(void* ctx) = NULL;
+        void* readerCtx = NULL;
+        void (*writerHandler)(void* ctx) = NULL;
+        void* writerCtx = NULL;
+
         int dataSize = 0;
+        int bufferSize = 0;
     };
 }
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include <gui/frame_scheduler.h>
+#include <thread>
+#include <algorithm>
+
+void FrameScheduler::requestFrame() {
+    pending = true;
+    std::lock_guard<std::mutex> lck(wakeMtx);
+    if (wakeHandler) { wakeHandler(); }
+}
+
+void FrameScheduler::inputReceived() {
+    settleFrames = FRAME_SCHEDULER_SETTLE_FRAMES;
+}
+
+void FrameScheduler::setWakeHandler(void (*handler)()) {
+    std::lock_guard<std::mutex> lck(wakeMtx);
+    wakeHandler = handler;
+}
+
+void FrameScheduler::setMaxFPS(int fps) {
+    maxFPS = std::max<int>(fps, 0);
+}
+
+int FrameScheduler::getMaxFPS() {
+    return maxFPS;
+}
+
+double FrameScheduler::getWaitTime() {
+    if (pending || settleFrames > 0) { return 0.0; }
+    return std::max<double>((1.0 / (double)FRAME_SCHEDULER_IDLE_FPS) - sinceLastFrame(), 0.0);
+}
+
+bool FrameScheduler::frameDue() {
+    return getWaitTime() <= 0.0;
+}
+
+bool FrameScheduler::framePending() {
+    return pending;
+}
+
+void FrameScheduler::beginFrame() {
+    // Don't go faster than the maximum framerate, whatever asked for the frame
+    int fps = maxFPS;
+    if (fps > 0) {
+        double remaining = (1.0 / (double)fps) - sinceLastFrame();
+        if (remaining > 0.0) { std::this_thread::sleep_for(std::chrono::duration<double>(remaining)); }
+    }
+    pending = false;
+    lastFrame = clock::now();
+}
+
+void FrameScheduler::endFrame(bool active) {
+    if (active) {
+        settleFrames = FRAME_SCHEDULER_SETTLE_FRAMES;
+    }
+    else if (settleFrames > 0) {
+        settleFrames--;
+    }
+}
+
+double FrameScheduler::sinceLastFrame() {
+    return std::chrono::duration<double>(clock::now() - lastFrame).count();
+}
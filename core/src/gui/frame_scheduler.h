@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <chrono>
+
+// Number of frames drawn after an input event so that ImGui can settle (hover, release, popups...)
+#define FRAME_SCHEDULER_SETTLE_FRAMES   3
+
+// Default framerate when nothing changes
+#define FRAME_SCHEDULER_IDLE_FPS        10
+
+// Decides when the backend has to redraw the GUI. Frames are drawn when new data is
+// displayed, while the user interacts with it and otherwise only at a low idle rate.
+class FrameScheduler {
+public:
+    // Called from any thread when something on screen changed, e.g. a new FFT frame
+    void requestFrame();
+
+    // Called by the backend when it received input
+    void inputReceived();
+
+    // Lets the backend be woken up from another thread when a frame is requested
+    void setWakeHandler(void (*handler)());
+
+    // Maximum framerate, 0 for no limit other than vsync
+    void setMaxFPS(int fps);
+    int getMaxFPS();
+
+    // Time in seconds the backend can wait for events before the next frame is due
+    double getWaitTime();
+
+    // True if a frame should be drawn now, for backends that get polled by their host
+    bool frameDue();
+
+    bool framePending();
+
+    // Called by the backend right before drawing, sleeps if needed to respect the maximum framerate
+    void beginFrame();
+
+    // Called by the backend once the frame is drawn, active if the user is interacting with an item
+    void endFrame(bool active);
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    double sinceLastFrame();
+
+    std::atomic<bool> pending = false;
+    std::atomic<int> settleFrames = FRAME_SCHEDULER_SETTLE_FRAMES;
+    std::atomic<int> maxFPS = 0;
+    clock::time_point lastFrame = clock::now();
+
+    std::mutex wakeMtx;
+    void (*wakeHandler)() = NULL;
+};
@@ -6,6 +6,7 @@
 #include <module.h>
 #include <gui/main_window.h>
 #include <gui/theme_manager.h>
+#include <gui/frame_scheduler.h>
 
 namespace gui {
     SDRPP_EXPORT ImGui::WaterFall waterfall;
@@ -13,6 +14,7 @@ namespace gui {
     SDRPP_EXPORT Menu menu;
     SDRPP_EXPORT ThemeManager themeManager;
     SDRPP_EXPORT MainWindow mainWindow;
+    SDRPP_EXPORT FrameScheduler frameScheduler;
 
     void selectSource(std::string name);
 };
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "imgui.h"
 #include <stdio.h>
 #include <thread>
+#include <chrono>
 #include <complex>
 #include <gui/widgets/waterfall.h>
 #include <gui/widgets/frequency_select.h>
@@ -88,7 +89,20 @@ void MainWindow::init() {
     fft_out = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * fftSize);
     fftwPlan = fftwf_plan_dft_1d(fftSize, fft_in, fft_out, FFTW_FORWARD, FFTW_ESTIMATE);
 
+    // Set up the shared DSP executor and front-end pinning if enabled
+    core::configManager.acquire();
+    json threadingConf = core::configManager.conf["threading"];
+    core::configManager.release();
+    if (threadingConf.value("sharedExecutor", false)) {
+        int workers = threadingConf.value("executorWorkers", 0);
+        sigpath::executor.init(workers);
+        spdlog::info("Using a shared DSP executor with {0} workers", sigpath::executor.getWorkerCount());
+        sigpath::iqFrontEnd.setVFOExecutor(&sigpath::executor);
+    }
+
     sigpath::iqFrontEnd.init(&dummyStream, 8000000, true, 1, false, 1024, 20.0, IQFrontEnd::FFTWindow::NUTTALL, acquireFFTBuffer, releaseFFTBuffer, this);
+    std::vector<int> frontEndCores = threadingConf.value("frontEndCores", std::vector<int>());
+    if (!frontEndCores.empty()) { sigpath::iqFrontEnd.setPreprocCores(frontEndCores); }
     sigpath::iqFrontEnd.start();
 
     vfoCreatedHandler.handler = vfoAddedHandler;
@@ -96,6 +110,9 @@ void MainWindow::init() {
     sigpath::vfoManager.onVfoCreated.bindHandler(&vfoCreatedHandler);
 
     spdlog::info("Loading modules");
+    LoadingScreen::show("Loading modules");
+    auto modLoadStart = std::chrono::steady_clock::now();
+    std::vector<std::string> modPaths;
 
     // Load modules from /module directory
     if (std::filesystem::is_directory(modulesDir)) {
@@ -106,8 +123,7 @@ void MainWindow::init() {
             }
             if (!file.is_regular_file()) { continue; }
             spdlog::info("Loading {0}", path);
-            LoadingScreen::show("Loading " + file.path().filename().string());
-            core::moduleManager.loadModule(path);
+            modPaths.push_back(path);
         }
     }
     else {
@@ -125,12 +141,12 @@ void MainWindow::init() {
 #ifndef __ANDROID__
         std::string apath = std::filesystem::absolute(path).string();
         spdlog::info("Loading {0}", apath);
-        LoadingScreen::show("Loading " + std::filesystem::path(path).filename().string());
-        core::moduleManager.loadModule(apath);
+        modPaths.push_back(apath);
 #else
-        core::moduleManager.loadModule(path);
+        modPaths.push_back(path);
 #endif
     }
+    core::moduleManager.loadModules(modPaths);
 
     // Create module instances
     for (auto const& [name, _module] : modList) {
@@ -141,6 +157,7 @@ void MainWindow::init() {
         core::moduleManager.createInstance(name, mod);
         if (!enabled) { core::moduleManager.disableInstance(name); }
     }
+    spdlog::info("Modules loaded in {0:.1f}ms", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - modLoadStart).count());
 
     // Load color maps
     LoadingScreen::show("Loading color maps");
@@ -224,6 +241,7 @@ void MainWindow::init() {
     autostart = core::args["autostart"].b();
     initComplete = true;
 
+    // Sources only start looking for their devices here and swap the results in once they're done
     core::moduleManager.doPostInitAll();
 }
 
@@ -233,6 +251,7 @@ float* MainWindow::acquireFFTBuffer(void* ctx) {
 
 void MainWindow::releaseFFTBuffer(void* ctx) {
     gui::waterfall.pushFFT();
+    gui::frameScheduler.requestFrame();
 }
 
 void MainWindow::vfoAddedHandler(VFOManager::VFO* vfo, void* ctx) {
@@ -18,6 +18,9 @@ namespace displaymenu {
     std::string colorMapAuthor = "";
     int selectedWindow = 0;
     int fftRate = 20;
+    int maxFps = 0;
+    int waterfallRate = 0;
+    int waterfallAveraging = ImGui::WaterFall::AVERAGING_PEAK;
     int uiScaleId = 0;
     bool restartRequired = false;
     bool fftHold = false;
@@ -61,6 +64,12 @@ namespace displaymenu {
         gui::waterfall.setFFTHoldSpeed(fftHoldSpeed / (fftRate * 10.0f));
     }
 
+    void updateWaterfallDecimation() {
+        // Rate of 0 means one line per FFT frame
+        int frames = waterfallRate ? (int)roundf((float)fftRate / (float)waterfallRate) : 1;
+        gui::waterfall.setWaterfallDecimation(frames, waterfallAveraging);
+    }
+
     void init() {
         showWaterfall = core::configManager.conf["showWaterfall"];
         showWaterfall ? gui::waterfall.showWaterfall() : gui::waterfall.hideWaterfall();
@@ -96,6 +105,13 @@ namespace displaymenu {
         fftRate = core::configManager.conf["fftRate"];
         sigpath::iqFrontEnd.setFFTRate(fftRate);
 
+        maxFps = core::configManager.conf["maxFps"];
+        gui::frameScheduler.setMaxFPS(maxFps);
+
+        waterfallRate = core::configManager.conf["waterfallRate"];
+        waterfallAveraging = std::clamp<int>((int)core::configManager.conf["waterfallAveraging"], 0, ImGui::WaterFall::_AVERAGING_COUNT - 1);
+        updateWaterfallDecimation();
+
         selectedWindow = std::clamp<int>((int)core::configManager.conf["fftWindow"], 0, (sizeof(fftWindowList) / sizeof(IQFrontEnd::FFTWindow)) - 1);
         sigpath::iqFrontEnd.setFFTWindow(fftWindowList[selectedWindow]);
 
@@ -169,11 +185,43 @@ namespace displaymenu {
             fftRate = std::max<int>(1, fftRate);
             sigpath::iqFrontEnd.setFFTRate(fftRate);
             updateFFTHoldSpeed();
+            updateWaterfallDecimation();
             core::configManager.acquire();
             core::configManager.conf["fftRate"] = fftRate;
             core::configManager.release(true);
         }
 
+        // 0 leaves the framerate up to vsync
+        ImGui::LeftLabel("Max Framerate");
+        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+        if (ImGui::InputInt("##sdrpp_max_fps", &maxFps, 1, 10)) {
+            maxFps = std::max<int>(0, maxFps);
+            gui::frameScheduler.setMaxFPS(maxFps);
+            core::configManager.acquire();
+            core::configManager.conf["maxFps"] = maxFps;
+            core::configManager.release(true);
+        }
+
+        // Lines per second, 0 adds a line for every FFT frame
+        ImGui::LeftLabel("Waterfall Rate");
+        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+        if (ImGui::InputInt("##sdrpp_wf_rate", &waterfallRate, 1, 10)) {
+            waterfallRate = std::max<int>(0, waterfallRate);
+            updateWaterfallDecimation();
+            core::configManager.acquire();
+            core::configManager.conf["waterfallRate"] = waterfallRate;
+            core::configManager.release(true);
+        }
+
+        ImGui::LeftLabel("Waterfall Averaging");
+        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+        if (ImGui::Combo("##sdrpp_wf_averaging", &waterfallAveraging, "Peak\0Mean\0")) {
+            updateWaterfallDecimation();
+            core::configManager.acquire();
+            core::configManager.conf["waterfallAveraging"] = waterfallAveraging;
+            core::configManager.release(true);
+        }
+
         ImGui::LeftLabel("FFT Size");
         ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
         if (ImGui::Combo("##sdrpp_fft_size", &fftSizeId, FFTSizesStr)) {
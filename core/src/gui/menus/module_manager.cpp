@@ -111,6 +111,40 @@ namespace module_manager_menu {
             ImGui::EndTable();
         }
 
+        // Time spent on each module and instance during startup
+        if (ImGui::TreeNode("Startup Times##module_mgr_timings")) {
+            if (ImGui::BeginTable("Module Manager Timings Table", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY, ImVec2(0, 200))) {
+                ImGui::TableSetupColumn("Name");
+                ImGui::TableSetupColumn("Load");
+                ImGui::TableSetupColumn("Init");
+                ImGui::TableSetupScrollFreeze(3, 1);
+                ImGui::TableHeadersRow();
+
+                for (auto& [name, mod] : core::moduleManager.modules) {
+                    ImGui::TableNextRow();
+                    ImGui::TableSetColumnIndex(0);
+                    ImGui::TextUnformatted(name.c_str());
+                    ImGui::TableSetColumnIndex(1);
+                    ImGui::Text("%.1fms", mod.loadTime);
+                    ImGui::TableSetColumnIndex(2);
+                    ImGui::Text("%.1fms", mod.initTime);
+                }
+
+                // For instances, load is the creation and init the post-init
+                for (auto& [name, inst] : core::moduleManager.instances) {
+                    ImGui::TableNextRow();
+                    ImGui::TableSetColumnIndex(0);
+                    ImGui::Text("%s (%s)", name.c_str(), inst.module.info->name);
+                    ImGui::TableSetColumnIndex(1);
+                    ImGui::Text("%.1fms", inst.createTime);
+                    ImGui::TableSetColumnIndex(2);
+                    ImGui::Text("%.1fms", inst.postInitTime);
+                }
+                ImGui::EndTable();
+            }
+            ImGui::TreePop();
+        }
+
         if (modified) {
             // Update enabled and disabled modules
             core::configManager.acquire();
@@ -263,7 +263,7 @@ namespace SmGui {
         else if (elem.type == DRAW_LIST_ELEM_TYPE_STRING && len >= 2) {
             uint16_t slen = *(uint16_t*)&data[i];
             if (len < slen + 2) { return -1; }
-            elem.str = std::string(&data[i + 2], &data[i + 2 + slen]);
+            elem.str.assign((const char*)&data[i + 2], slen);
             i += slen + 2;
         }
         else {
@@ -275,21 +275,21 @@ namespace SmGui {
     
     int DrawList::load(void* data, int len) {
         uint8_t* buf = (uint8_t*)data;
-        elements.clear();
         int i = 0;
+        int n = 0;
 
-        // Load all entries
+        // Load all entries over the existing ones so that their strings are reused
         while (len > 0) {
-            // Load entry type
-            DrawListElem elem;
-            int consumed = loadItem(elem, &buf[i], len);
-            if (consumed < 0) { return -1; }
+            if (n == elements.size()) { elements.emplace_back(); }
+            int consumed = loadItem(elements[n++], &buf[i], len);
+            if (consumed < 0) {
+                elements.resize(n - 1);
+                return -1;
+            }
             i += consumed;
             len -= consumed;
-
-            // Add element to list
-            elements.push_back(elem);
         }
+        elements.resize(n);
 
         // Validate and clear if invalid
         if (!validate()) {
@@ -376,6 +376,35 @@ namespace SmGui {
         return size;
     }
 
+    // 64 bit FNV-1a, the lists are only a few kilobytes
+    #define DRAW_LIST_HASH_SEED     0xCBF29CE484222325ULL
+    #define DRAW_LIST_HASH_PRIME    0x100000001B3ULL
+
+    static inline uint64_t hashBytes(uint64_t h, const uint8_t* data, int len) {
+        for (int i = 0; i < len; i++) {
+            h = (h ^ data[i]) * DRAW_LIST_HASH_PRIME;
+        }
+        return h;
+    }
+
+    uint64_t DrawList::getHash() {
+        // Hash the elements in their stored form without storing the whole list
+        uint64_t h = DRAW_LIST_HASH_SEED;
+        uint8_t buf[8];
+        for (auto& elem : elements) {
+            if (elem.type == DRAW_LIST_ELEM_TYPE_STRING) {
+                buf[0] = elem.type;
+                *(uint16_t*)&buf[1] = elem.str.size();
+                h = hashBytes(h, buf, 3);
+                h = hashBytes(h, (const uint8_t*)elem.str.data(), elem.str.size());
+                continue;
+            }
+            int count = storeItem(elem, buf, sizeof(buf));
+            if (count > 0) { h = hashBytes(h, buf, count); }
+        }
+        return h;
+    }
+
     bool DrawList::checkTypes(int firstId, int n, ...) {
         va_list args;
         va_start(args, n);
@@ -92,6 +92,10 @@ namespace SmGui {
         int store(void* data, int len);
         static int getItemSize(DrawListElem& elem);
         int getSize();
+
+        // Hash of the stored form, lets both ends tell if a list changed without exchanging it
+        uint64_t getHash();
+
         bool checkTypes(int firstId, int n, ...);
         bool validate();
 
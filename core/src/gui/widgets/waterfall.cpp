@@ -132,29 +132,13 @@ namespace ImGui {
             window->DrawList->AddText(ImVec2(roundf(xPos - (txtSz.x / 2.0)), fftAreaMax.y + txtSz.y), text, buf);
         }
 
-        // Data
-        if (latestFFT != NULL && fftLines != 0) {
-            for (int i = 1; i < dataWidth; i++) {
-                double aPos = fftAreaMax.y - ((latestFFT[i - 1] - fftMin) * scaleFactor);
-                double bPos = fftAreaMax.y - ((latestFFT[i] - fftMin) * scaleFactor);
-                aPos = std::clamp<double>(aPos, fftAreaMin.y + 1, fftAreaMax.y);
-                bPos = std::clamp<double>(bPos, fftAreaMin.y + 1, fftAreaMax.y);
-                window->DrawList->AddLine(ImVec2(fftAreaMin.x + i - 1, roundf(aPos)),
-                                          ImVec2(fftAreaMin.x + i, roundf(bPos)), trace, 1.0);
-                window->DrawList->AddLine(ImVec2(fftAreaMin.x + i, roundf(bPos)),
-                                          ImVec2(fftAreaMin.x + i, fftAreaMax.y), shadow, 1.0);
-            }
-        }
-
-        // Hold
-        if (fftHold && latestFFT != NULL && latestFFTHold != NULL && fftLines != 0) {
-            for (int i = 1; i < dataWidth; i++) {
-                double aPos = fftAreaMax.y - ((latestFFTHold[i - 1] - fftMin) * scaleFactor);
-                double bPos = fftAreaMax.y - ((latestFFTHold[i] - fftMin) * scaleFactor);
-                aPos = std::clamp<double>(aPos, fftAreaMin.y + 1, fftAreaMax.y);
-                bPos = std::clamp<double>(bPos, fftAreaMin.y + 1, fftAreaMax.y);
-                window->DrawList->AddLine(ImVec2(fftAreaMin.x + i - 1, roundf(aPos)),
-                                          ImVec2(fftAreaMin.x + i, roundf(bPos)), traceHold, 1.0);
+        // Data, drawn as one shadow mesh and one polyline per trace
+        if (latestFFT != NULL && fftLines != 0 && dataWidth > 1) {
+            updateTraceGeometry(scaleFactor);
+            drawTraceShadow(shadow);
+            window->DrawList->AddPolyline(tracePoints.data(), dataWidth, trace, ImDrawFlags_None, 1.0f);
+            if (fftHold && latestFFTHold != NULL) {
+                window->DrawList->AddPolyline(holdPoints.data(), dataWidth, traceHold, ImDrawFlags_None, 1.0f);
             }
         }
 
@@ -178,6 +162,56 @@ namespace ImGui {
                                   text, style::uiScale);
     }
 
+    void WaterFall::updateTraceGeometry(float scaleFactor) {
+        // Reuse the points unless there's new data or the scale or area moved
+        bool moved = (fftMin != traceFFTMin || fftMax != traceFFTMax || fftAreaMin.x != traceAreaMin.x || fftAreaMin.y != traceAreaMin.y ||
+                      fftAreaMax.x != traceAreaMax.x || fftAreaMax.y != traceAreaMax.y || tracePoints.size() != dataWidth);
+        if (!traceDirty && !moved) { return; }
+        traceDirty = false;
+        traceFFTMin = fftMin;
+        traceFFTMax = fftMax;
+        traceAreaMin = fftAreaMin;
+        traceAreaMax = fftAreaMax;
+        tracePoints.resize(dataWidth);
+        holdPoints.resize(dataWidth);
+
+        // Points are at the center of the pixels like ImGui lines
+        float top = fftAreaMin.y + 1.0f;
+        float bottom = fftAreaMax.y;
+        float x = fftAreaMin.x + 0.5f;
+        float offset = bottom + (fftMin * scaleFactor) + 0.5f;
+        for (int i = 0; i < dataWidth; i++) {
+            tracePoints[i] = ImVec2(x + i, roundf(std::clamp<float>(offset - (latestFFT[i] * scaleFactor), top, bottom)));
+        }
+        if (fftHold && latestFFTHold != NULL) {
+            for (int i = 0; i < dataWidth; i++) {
+                holdPoints[i] = ImVec2(x + i, roundf(std::clamp<float>(offset - (latestFFTHold[i] * scaleFactor), top, bottom)));
+            }
+        }
+    }
+
+    void WaterFall::drawTraceShadow(ImU32 color) {
+        // Triangle strip between the trace and the bottom of the FFT area
+        ImDrawList* dl = window->DrawList;
+        ImVec2 uv = dl->_Data->TexUvWhitePixel;
+        float bottom = fftAreaMax.y;
+        dl->PrimReserve((dataWidth - 1) * 6, dataWidth * 2);
+        ImDrawIdx base = (ImDrawIdx)dl->_VtxCurrentIdx;
+        for (int i = 0; i < dataWidth; i++) {
+            dl->PrimWriteVtx(tracePoints[i], uv, color);
+            dl->PrimWriteVtx(ImVec2(tracePoints[i].x, bottom), uv, color);
+        }
+        for (int i = 0; i < dataWidth - 1; i++) {
+            ImDrawIdx id = base + (i * 2);
+            dl->PrimWriteIdx(id);
+            dl->PrimWriteIdx(id + 1);
+            dl->PrimWriteIdx(id + 2);
+            dl->PrimWriteIdx(id + 1);
+            dl->PrimWriteIdx(id + 3);
+            dl->PrimWriteIdx(id + 2);
+        }
+    }
+
     void WaterFall::drawWaterfall() {
         if (waterfallUpdate) {
             waterfallUpdate = false;
@@ -465,7 +499,7 @@ namespace ImGui {
                         ImGui::Text("Bandwidth Locked: %s", _vfo->bandwidthLocked ? "Yes" : "No");
 
                         float strength, snr;
-                        if (calculateVFOSignalInfo(waterfallVisible ? &rawFFTs[currentFFTLine * rawFFTSize] : rawFFTs, _vfo, strength, snr)) {
+                        if (calculateVFOSignalInfo(fftSlots[fftReadSlot].frame.data(), _vfo, strength, snr)) {
                             ImGui::Text("Strength: %0.1fdBFS", strength);
                             ImGui::Text("SNR: %0.1fdB", snr);
                         }
@@ -749,6 +783,7 @@ namespace ImGui {
             latestFFT[i] = -1000.0; // Hide everything
             latestFFTHold[i] = -1000.0;
         }
+        traceDirty = true;
 
         fftAreaMin = ImVec2(widgetPos.x + (50.0f * style::uiScale), widgetPos.y + (9.0f * style::uiScale));
         fftAreaMax = ImVec2(fftAreaMin.x + dataWidth, fftAreaMin.y + fftHeight + 1);
@@ -817,6 +852,7 @@ namespace ImGui {
             if (!inputHandled) { processInputs(); }
         }
 
+        consumeFFT();
         updateAllVFOs(true);
 
         drawFFT();
@@ -837,45 +873,107 @@ namespace ImGui {
     }
 
     float* WaterFall::getFFTBuffer() {
-        if (rawFFTs == NULL) { return NULL; }
-        buf_mtx.lock();
-        if (waterfallVisible) {
-            currentFFTLine--;
-            fftLines++;
-            currentFFTLine = ((currentFFTLine + waterfallHeight) % waterfallHeight);
-            fftLines = std::min<float>(fftLines, waterfallHeight);
-            return &rawFFTs[currentFFTLine * rawFFTSize];
-        }
-        return rawFFTs;
+        // Held until pushFFT() so the size can't change under the writer. Only one writer at a time,
+        // the slot is entirely its own
+        fftWriteMtx.lock();
+        if (fftSlots[fftWriteSlot].frame.empty()) { return NULL; }
+        return fftSlots[fftWriteSlot].frame.data();
     }
 
     void WaterFall::pushFFT() {
-        if (rawFFTs == NULL) { return; }
+        std::lock_guard<std::mutex> lck(fftWriteMtx, std::adopt_lock);
+        FFTSlot& slot = fftSlots[fftWriteSlot];
+        if (slot.frame.empty()) { return; }
+
+        // Combine the frame into the current waterfall line
+        int averaging = wfAveraging;
+        if (!wfAccumCount) {
+            memcpy(wfAccum.data(), slot.frame.data(), rawFFTSize * sizeof(float));
+        }
+        else if (averaging == AVERAGING_PEAK) {
+            volk_32f_x2_max_32f(wfAccum.data(), wfAccum.data(), slot.frame.data(), rawFFTSize);
+        }
+        else {
+            volk_32f_x2_add_32f(wfAccum.data(), wfAccum.data(), slot.frame.data(), rawFFTSize);
+        }
+
+        // Queue finished lines for the GUI. If it stalled long enough to fill the queue, the line is dropped
+        if (++wfAccumCount >= wfDecimFrames) {
+            uint64_t id = wfLinesWritten.load(std::memory_order_relaxed);
+            if (id - wfLinesTaken.load(std::memory_order_acquire) < WATERFALL_MAX_PENDING_LINES) {
+                float* line = &wfPendingLines[(id % WATERFALL_MAX_PENDING_LINES) * rawFFTSize];
+                if (averaging == AVERAGING_MEAN && wfAccumCount > 1) {
+                    volk_32f_s32f_multiply_32f(line, wfAccum.data(), 1.0f / (float)wfAccumCount, rawFFTSize);
+                }
+                else {
+                    memcpy(line, wfAccum.data(), rawFFTSize * sizeof(float));
+                }
+                wfLinesWritten.store(id + 1, std::memory_order_release);
+            }
+            wfAccumCount = 0;
+        }
+
+        // Publish the frame and take back the slot the GUI isn't using. If the previous frame
+        // was still pending, the GUI was too slow for it and only the latest one is shown.
+        int prev = fftExchange.exchange(fftWriteSlot | WATERFALL_FFT_SLOT_FRESH, std::memory_order_acq_rel);
+        fftWriteSlot = prev & WATERFALL_FFT_SLOT_MASK;
+    }
+
+    void WaterFall::consumeFFT() {
+        // Take the latest frame if there is one
+        bool newFrame = (fftExchange.load(std::memory_order_relaxed) & WATERFALL_FFT_SLOT_FRESH);
+        if (newFrame) {
+            fftReadSlot = fftExchange.exchange(fftReadSlot, std::memory_order_acq_rel) & WATERFALL_FFT_SLOT_MASK;
+        }
+        uint64_t taken = wfLinesTaken.load(std::memory_order_relaxed);
+        uint64_t written = wfLinesWritten.load(std::memory_order_acquire);
+        if (rawFFTs == NULL || (!newFrame && written == taken)) { return; }
         std::lock_guard<std::recursive_mutex> lck(latestFFTMtx);
+        FFTSlot& slot = fftSlots[fftReadSlot];
+
         double offsetRatio = viewOffset / (wholeBandwidth / 2.0);
         int drawDataSize = (viewBandwidth / wholeBandwidth) * rawFFTSize;
         int drawDataStart = (((double)rawFFTSize / 2.0) * (offsetRatio + 1)) - (drawDataSize / 2);
 
         if (waterfallVisible) {
-            doZoom(drawDataStart, drawDataSize, dataWidth, &rawFFTs[currentFFTLine * rawFFTSize], latestFFT);
-            memmove(&waterfallFb[dataWidth], waterfallFb, dataWidth * (waterfallHeight - 1) * sizeof(uint32_t));
-            float pixel;
-            float dataRange = waterfallMax - waterfallMin;
-            for (int j = 0; j < dataWidth; j++) {
-                pixel = (std::clamp<float>(latestFFT[j], waterfallMin, waterfallMax) - waterfallMin) / dataRange;
-                int id = (int)(pixel * (WATERFALL_RESOLUTION - 1));
-                waterfallFb[j] = waterfallPallet[id];
+            // Add every line finished since the last frame, shifting the image only once
+            int count = std::min<int>(written - taken, waterfallHeight);
+            if (count > 0) {
+                memmove(&waterfallFb[count * dataWidth], waterfallFb, dataWidth * (waterfallHeight - count) * sizeof(uint32_t));
+                float pixel;
+                float dataRange = waterfallMax - waterfallMin;
+                for (uint64_t lineId = written - count; lineId < written; lineId++) {
+                    currentFFTLine--;
+                    fftLines++;
+                    currentFFTLine = ((currentFFTLine + waterfallHeight) % waterfallHeight);
+                    fftLines = std::min<float>(fftLines, waterfallHeight);
+                    memcpy(&rawFFTs[currentFFTLine * rawFFTSize], &wfPendingLines[(lineId % WATERFALL_MAX_PENDING_LINES) * rawFFTSize], rawFFTSize * sizeof(float));
+
+                    // The trace buffer is used as scratch for the line, it's overwritten right after
+                    doZoom(drawDataStart, drawDataSize, dataWidth, &rawFFTs[currentFFTLine * rawFFTSize], latestFFT);
+                    uint32_t* row = &waterfallFb[(written - 1 - lineId) * dataWidth];
+                    for (int j = 0; j < dataWidth; j++) {
+                        pixel = (std::clamp<float>(latestFFT[j], waterfallMin, waterfallMax) - waterfallMin) / dataRange;
+                        int id = (int)(pixel * (WATERFALL_RESOLUTION - 1));
+                        row[j] = waterfallPallet[id];
+                    }
+                }
+                waterfallUpdate = true;
             }
-            waterfallUpdate = true;
+            wfLinesTaken.store(written, std::memory_order_release);
+            doZoom(drawDataStart, drawDataSize, dataWidth, slot.frame.data(), latestFFT);
         }
         else {
+            wfLinesTaken.store(written, std::memory_order_release);
+            memcpy(rawFFTs, slot.frame.data(), rawFFTSize * sizeof(float));
             doZoom(drawDataStart, drawDataSize, dataWidth, rawFFTs, latestFFT);
             fftLines = 1;
         }
+        if (!newFrame) { return; }
 
         if (selectedVFO != "" && vfos.size() > 0) {
             float dummy;
-            calculateVFOSignalInfo(waterfallVisible ? &rawFFTs[currentFFTLine * rawFFTSize] : rawFFTs, vfos[selectedVFO], dummy, selectedVFOSNR);
+            calculateVFOSignalInfo(slot.frame.data(), vfos[selectedVFO], dummy, selectedVFOSNR);
         }
 
         // If FFT hold is enabled, update it
@@ -884,8 +982,7 @@ namespace ImGui {
                 latestFFTHold[i] = std::max<float>(latestFFT[i], latestFFTHold[i] - fftHoldSpeed);
             }
         }
-
-        buf_mtx.unlock();
+        traceDirty = true;
     }
 
     void WaterFall::updatePallette(float colors[][3], int colorCount) {
@@ -920,6 +1017,14 @@ namespace ImGui {
         updateWaterfallFb();
     }
 
+    void WaterFall::levelsToColors(const float* levels, uint32_t* colors, int count) {
+        float dataRange = waterfallMax - waterfallMin;
+        for (int i = 0; i < count; i++) {
+            float pixel = (std::clamp<float>(levels[i], waterfallMin, waterfallMax) - waterfallMin) / dataRange;
+            colors[i] = waterfallPallet[(int)(pixel * (WATERFALL_RESOLUTION - 1))];
+        }
+    }
+
     void WaterFall::autoRange() {
         std::lock_guard<std::recursive_mutex> lck(latestFFTMtx);
         float min = INFINITY;
@@ -1080,6 +1185,7 @@ namespace ImGui {
 
     void WaterFall::setRawFFTSize(int size) {
         std::lock_guard<std::recursive_mutex> lck(buf_mtx);
+        std::lock_guard<std::mutex> lck2(fftWriteMtx);
         rawFFTSize = size;
         int wfSize = std::max<int>(1, waterfallHeight);
         if (rawFFTs != NULL) {
@@ -1090,9 +1196,24 @@ namespace ImGui {
         }
         fftLines = 0;
         memset(rawFFTs, 0, rawFFTSize * waterfallHeight * sizeof(float));
+
+        // Drop any frame or line of the old size
+        for (auto& slot : fftSlots) { slot.frame.assign(rawFFTSize, -1000.0f); }
+        fftExchange = fftExchange & WATERFALL_FFT_SLOT_MASK;
+        wfAccum.resize(rawFFTSize);
+        wfAccumCount = 0;
+        wfPendingLines.assign(WATERFALL_MAX_PENDING_LINES * rawFFTSize, -1000.0f);
+        wfLinesWritten = 0;
+        wfLinesTaken = 0;
+
         updateWaterfallFb();
     }
 
+    void WaterFall::setWaterfallDecimation(int frames, int averaging) {
+        wfDecimFrames = std::max<int>(1, frames);
+        wfAveraging = std::clamp<int>(averaging, 0, _AVERAGING_COUNT - 1);
+    }
+
     void WaterFall::setBandPlanPos(int pos) {
         bandPlanPos = pos;
     }
@@ -1104,6 +1225,7 @@ namespace ImGui {
                 latestFFTHold[i] = -1000.0;
             }
         }
+        traceDirty = true;
     }
 
     void WaterFall::setFFTHoldSpeed(float speed) {
@@ -1,15 +1,24 @@
 #pragma once
 #include <vector>
 #include <mutex>
+#include <atomic>
 #include <gui/widgets/bandplan.h>
 #include <imgui/imgui.h>
 #include <imgui/imgui_internal.h>
 #include <utils/event.h>
+#include <volk/volk.h>
 
 #include <utils/opengl_include_code.h>
 
 #define WATERFALL_RESOLUTION 1000000
 
+// FFT frame exchange slot index and flag marking a frame the GUI hasn't taken yet
+#define WATERFALL_FFT_SLOT_MASK     0b011
+#define WATERFALL_FFT_SLOT_FRESH    0b100
+
+// Waterfall lines that can wait for the GUI, for when lines come in faster than frames are drawn
+#define WATERFALL_MAX_PENDING_LINES 16
+
 namespace ImGui {
     class WaterfallVFO {
     public:
@@ -103,16 +112,19 @@ namespace ImGui {
             float sFactor = ceilf(factor);
             float uFactor;
             float id = offset;
-            float maxVal;
             int sId;
+            uint32_t maxId;
             for (int i = 0; i < outWidth; i++) {
-                maxVal = -INFINITY;
                 sId = (int)id;
                 uFactor = (sId + sFactor > rawFFTSize) ? sFactor - ((sId + sFactor) - rawFFTSize) : sFactor;
-                for (int j = 0; j < uFactor; j++) {
-                    if (data[sId + j] > maxVal) { maxVal = data[sId + j]; }
+                if (uFactor > 1) {
+                    // Peak of the bins covered by the column
+                    volk_32f_index_max_32u(&maxId, &data[sId], uFactor);
+                    out[i] = data[sId + maxId];
+                }
+                else {
+                    out[i] = (uFactor > 0) ? data[sId] : -INFINITY;
                 }
-                out[i] = maxVal;
                 id += factor;
             }
         }
@@ -120,6 +132,9 @@ namespace ImGui {
         void updatePallette(float colors[][3], int colorCount);
         void updatePalletteFromArray(float* colors, int colorCount);
 
+        // Converts levels in dB to colors using the waterfall palette and range
+        void levelsToColors(const float* levels, uint32_t* colors, int count);
+
         void setCenterFrequency(double freq);
         double getCenterFrequency();
 
@@ -162,6 +177,9 @@ namespace ImGui {
 
         void setRawFFTSize(int size);
 
+        // Combine this many FFT frames into each waterfall line
+        void setWaterfallDecimation(int frames, int averaging);
+
         void setFullWaterfallUpdate(bool fullUpdate);
 
         void setBandPlanPos(int pos);
@@ -232,6 +250,12 @@ namespace ImGui {
             _BANDPLAN_POS_COUNT
         };
 
+        enum {
+            AVERAGING_PEAK,
+            AVERAGING_MEAN,
+            _AVERAGING_COUNT
+        };
+
         ImVec2 fftAreaMin;
         ImVec2 fftAreaMax;
         ImVec2 freqAreaMin;
@@ -242,6 +266,9 @@ namespace ImGui {
     private:
         void drawWaterfall();
         void drawFFT();
+        void consumeFFT();
+        void updateTraceGeometry(float scaleFactor);
+        void drawTraceShadow(ImU32 color);
         void drawVFOs();
         void drawBandPlan();
         void processInputs();
@@ -309,6 +336,27 @@ namespace ImGui {
         int currentFFTLine = 0;
         int fftLines = 0;
 
+        // Triple buffered handoff of raw FFT frames so the DSP thread never waits on the GUI.
+        // The writer owns fftWriteSlot, the GUI owns fftReadSlot and the third one is in fftExchange.
+        struct FFTSlot {
+            std::vector<float> frame;
+        };
+        FFTSlot fftSlots[3];
+        int fftWriteSlot = 0;
+        int fftReadSlot = 1;
+        std::atomic<int> fftExchange = 2;
+        std::mutex fftWriteMtx;
+
+        // Waterfall line decimation. The accumulator belongs to the FFT writer, finished lines are
+        // queued in a ring of WATERFALL_MAX_PENDING_LINES that the GUI drains on each frame.
+        std::atomic<int> wfDecimFrames = 1;
+        std::atomic<int> wfAveraging = AVERAGING_PEAK;
+        std::vector<float> wfAccum;
+        int wfAccumCount = 0;
+        std::vector<float> wfPendingLines;
+        std::atomic<uint64_t> wfLinesWritten = 0;
+        std::atomic<uint64_t> wfLinesTaken = 0;
+
         uint32_t* waterfallFb;
 
         bool draggingFW = false;
@@ -325,6 +373,15 @@ namespace ImGui {
         bool fftHold = false;
         float fftHoldSpeed = 0.3f;
 
+        // Trace geometry, only rebuilt when a new FFT arrives or the scale changes
+        std::vector<ImVec2> tracePoints;
+        std::vector<ImVec2> holdPoints;
+        bool traceDirty = true;
+        float traceFFTMin;
+        float traceFFTMax;
+        ImVec2 traceAreaMin;
+        ImVec2 traceAreaMax;
+
         // UI Select elements
         bool fftResizeSelect = false;
         bool freqScaleSelect = false;
@@ -0,0 +1,61 @@
+#pragma once
+#include <stdint.h>
+
+#define IQ_MULTICAST_MAGIC          0x51495053 // "SPIQ"
+#define IQ_MULTICAST_VERSION        1
+#define IQ_MULTICAST_DEFAULT_GROUP  "239.255.42.42"
+#define IQ_MULTICAST_DEFAULT_PORT   4243
+#define IQ_MULTICAST_DEFAULT_MTU    1500
+#define IQ_MULTICAST_MAX_PACKET     65507
+
+// IPv4 + UDP header overhead to subtract from the MTU
+#define IQ_MULTICAST_IP_OVERHEAD    28
+
+namespace iq_multicast {
+    enum SampleType {
+        SAMPLE_TYPE_INT8,
+        SAMPLE_TYPE_INT16,
+        SAMPLE_TYPE_FLOAT32
+    };
+
+#pragma pack(push, 1)
+    // Every datagram starts with this header followed by sampleCount interleaved IQ samples
+    struct PacketHeader {
+        uint32_t magic;
+        uint8_t version;
+        uint8_t sampleType;
+        uint16_t streamId;
+        uint32_t sampleCount;
+        float scale;            // Multiply integer samples by this to get back floats
+        uint64_t sequence;      // Incremented by one for every datagram
+        uint64_t timestamp;     // Time of the first sample in nanoseconds since the unix epoch
+        uint64_t sampleIndex;   // Index of the first sample since the stream was started
+        double sampleRate;
+        double centerFrequency;
+    };
+#pragma pack(pop)
+
+    inline int sampleSize(int type) {
+        switch (type) {
+        case SAMPLE_TYPE_INT8:
+            return 2 * sizeof(int8_t);
+        case SAMPLE_TYPE_INT16:
+            return 2 * sizeof(int16_t);
+        case SAMPLE_TYPE_FLOAT32:
+            return 2 * sizeof(float);
+        default:
+            return 0;
+        }
+    }
+
+    // Number of samples fitting in a datagram for a given MTU
+    inline int samplesPerPacket(int mtu, int type) {
+        int payload = mtu - IQ_MULTICAST_IP_OVERHEAD - (int)sizeof(PacketHeader);
+        if (payload > IQ_MULTICAST_MAX_PACKET - (int)sizeof(PacketHeader)) {
+            payload = IQ_MULTICAST_MAX_PACKET - (int)sizeof(PacketHeader);
+        }
+        int size = sampleSize(type);
+        if (!size || payload < size) { return 0; }
+        return payload / size;
+    }
+}
@@ -1,8 +1,30 @@
 #include <module.h>
 #include <filesystem>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <spdlog/spdlog.h>
 
-ModuleManager::Module_t ModuleManager::loadModule(std::string path) {
+// Runs task(0) to task(count - 1) spread over as many threads as there are cores
+static void runParallel(int count, const std::function<void(int)>& task) {
+    int threadCount = std::min<int>(count, std::max<int>(1, std::thread::hardware_concurrency()));
+    std::atomic<int> next = 0;
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threadCount; i++) {
+        workers.push_back(std::thread([&]() {
+            for (int id = next++; id < count; id = next++) { task(id); }
+        }));
+    }
+    for (auto& w : workers) { w.join(); }
+}
+
+static double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+ModuleManager::Module_t ModuleManager::openModule(std::string path) {
+    auto start = std::chrono::steady_clock::now();
     Module_t mod;
 
     // On android, the path has to be relative, don't make it absolute
@@ -68,9 +90,26 @@ ModuleManager::Module_t ModuleManager::loadModule(std::string path) {
         mod.handle = NULL;
         return mod;
     }
+    mod.loadTime = msSince(start);
+    return mod;
+}
+
+void ModuleManager::closeModule(Module_t& mod) {
+    // The handle is reference counted, so this doesn't unload a module that was opened twice
+#ifdef _WIN32
+    FreeLibrary(mod.handle);
+#else
+    dlclose(mod.handle);
+#endif
+    mod.handle = NULL;
+}
+
+ModuleManager::Module_t ModuleManager::loadModule(std::string path) {
+    Module_t mod = openModule(path);
+    if (mod.handle == NULL) { return mod; }
     if (modules.find(mod.info->name) != modules.end()) {
         spdlog::error("{0} has the same name as an already loaded module", path);
-        mod.handle = NULL;
+        closeModule(mod);
         return mod;
     }
     for (auto const& [name, _mod] : modules) {
@@ -78,11 +117,38 @@ ModuleManager::Module_t ModuleManager::loadModule(std::string path) {
             return _mod;
         }
     }
+    auto start = std::chrono::steady_clock::now();
     mod.init();
+    mod.initTime = msSince(start);
     modules[mod.info->name] = mod;
+    spdlog::info("Loaded {0} in {1:.1f}ms (init {2:.1f}ms)", mod.info->name, mod.loadTime, mod.initTime);
     return mod;
 }
 
+void ModuleManager::loadModules(std::vector<std::string> paths) {
+    // Opening a module only touches the module itself so it can be done in parallel
+    std::vector<Module_t> mods(paths.size());
+    runParallel(paths.size(), [&](int i) { mods[i] = openModule(paths[i]); });
+
+    // Register them in order so that duplicates are handled the same as when loading one by one
+    for (int i = 0; i < mods.size(); i++) {
+        Module_t& mod = mods[i];
+        if (mod.handle == NULL) { continue; }
+        if (modules.find(mod.info->name) != modules.end()) {
+            spdlog::error("{0} has the same name as an already loaded module", paths[i]);
+            closeModule(mod);
+            continue;
+        }
+
+        // Inits create shared directories and such, so they stay sequential
+        auto start = std::chrono::steady_clock::now();
+        mod.init();
+        mod.initTime = msSince(start);
+        modules[mod.info->name] = mod;
+        spdlog::info("Loaded {0} in {1:.1f}ms (init {2:.1f}ms)", mod.info->name, mod.loadTime, mod.initTime);
+    }
+}
+
 int ModuleManager::createInstance(std::string name, std::string module) {
     if (modules.find(module) == modules.end()) {
         spdlog::error("Module '{0}' doesn't exist", module);
@@ -99,8 +165,11 @@ int ModuleManager::createInstance(std::string name, std::string module) {
     }
     Instance_t inst;
     inst.module = modules[module];
+    auto start = std::chrono::steady_clock::now();
     inst.instance = inst.module.createInstance(name);
+    inst.createTime = msSince(start);
     instances[name] = inst;
+    spdlog::info("Created {0} in {1:.1f}ms", name, inst.createTime);
     onInstanceCreated.emit(name);
     return 0;
 }
@@ -154,7 +223,9 @@ void ModuleManager::postInit(std::string name) {
         spdlog::error("Cannot post-init '{0}', instance doesn't exist", name);
         return;
     }
+    auto start = std::chrono::steady_clock::now();
     instances[name].instance->postInit();
+    instances[name].postInitTime = msSince(start);
 }
 
 std::string ModuleManager::getInstanceModuleName(std::string name) {
@@ -181,6 +252,8 @@ int ModuleManager::countModuleInstances(std::string module) {
 void ModuleManager::doPostInitAll() {
     for (auto& [name, inst] : instances) {
         spdlog::info("Running post-init for {0}", name);
+        auto start = std::chrono::steady_clock::now();
         inst.instance->postInit();
+        inst.postInitTime = msSince(start);
     }
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <map>
+#include <vector>
 #include <json.hpp>
 #include <utils/event.h>
 
@@ -60,6 +61,10 @@ public:
         void (*deleteInstance)(ModuleManager::Instance* instance);
         void (*end)();
 
+        // Startup timings in milliseconds
+        double loadTime = 0.0;
+        double initTime = 0.0;
+
         friend bool operator==(const Module_t& a, const Module_t& b) {
             if (a.handle != b.handle) { return false; }
             if (a.info != b.info) { return false; }
@@ -74,10 +79,17 @@ public:
     struct Instance_t {
         ModuleManager::Module_t module;
         ModuleManager::Instance* instance;
+
+        // Startup timings in milliseconds
+        double createTime = 0.0;
+        double postInitTime = 0.0;
     };
 
     ModuleManager::Module_t loadModule(std::string path);
 
+    // Loads several modules at once, opening them and running their init in parallel
+    void loadModules(std::vector<std::string> paths);
+
     int createInstance(std::string name, std::string module);
     int deleteInstance(std::string name);
     int deleteInstance(ModuleManager::Instance* instance);
@@ -98,6 +110,10 @@ public:
 
     std::map<std::string, ModuleManager::Module_t> modules;
     std::map<std::string, ModuleManager::Instance_t> instances;
+
+private:
+    ModuleManager::Module_t openModule(std::string path);
+    void closeModule(Module_t& mod);
 };
 
 #define SDRPP_MOD_INFO MOD_EXPORT const ModuleManager::ModuleInfo_t _INFO_
\ No newline at end of file
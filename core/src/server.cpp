@@ -10,10 +10,27 @@
 #include <utils/optionlist.h>
 #include "dsp/compression/sample_stream_compressor.h"
 #include "dsp/sink/handler_sink.h"
-#include <zstd.h>
+#include "dsp/routing/splitter.h"
+#include <utils/parallel_compressor.h>
+#include <chrono>
+#include <map>
+#include <atomic>
+#include <mutex>
 
 namespace server {
+    // Narrowband stream computed on the server for a client in spectrum mode
+    struct ServerVFO {
+        uint32_t id;
+        std::string name;
+        dsp::channel::RxVFO* vfo;
+        dsp::sink::Handler<dsp::complex_t> sink;
+        std::vector<uint8_t> buf;
+    };
+
     dsp::stream<dsp::complex_t> dummyInput;
+    dsp::routing::Splitter<dsp::complex_t> inputSplit;
+    dsp::stream<dsp::complex_t> basebandInput;
+    dsp::stream<dsp::complex_t> frontEndInput;
     dsp::compression::SampleStreamCompressor comp;
     dsp::sink::Handler<uint8_t> hnd;
     net::Conn client;
@@ -36,21 +53,58 @@ namespace server {
 
     SmGui::DrawListElem dummyElem;
 
-    ZSTD_CCtx* cctx;
+    // Spectrum mode state. The mode is changed from the network threads and read by the DSP
+    std::atomic<StreamingMode> streamingMode = STREAMING_MODE_BASEBAND;
+    std::mutex streamingModeMtx;
+    bool basebandBound = false;
+    bool frontEndBound = false;
+    EventHandler<SpectrumFrameRef> spectrumHandler;
+    std::vector<uint8_t> fftBuf;
+    std::map<uint32_t, ServerVFO*> vfos;
+    std::mutex vfoMtx;
+    std::atomic<int> vfoCount = 0;
+
+    ParallelCompressor compressor;
+
+    // Levels the adaptive mode can step through, from cheapest to strongest
+    const int adaptiveLevels[] = { -5, -1, 1, 3, 5, 9 };
+    const int adaptiveLevelCount = sizeof(adaptiveLevels) / sizeof(int);
+
+    // Number of buffers over which link and CPU pressure are evaluated
+    const int adaptPeriod = 16;
 
     net::Listener listener;
 
     OptionList<std::string, std::string> sourceList;
     int sourceId = 0;
     bool running = false;
-    bool compression = false;
+    std::atomic<bool> compression = false;
+    std::atomic<int> compressionLevel = 1;
     double sampleRate = 1000000.0;
 
+    // Adaptive compression state. Only the DSP thread touches it, the network thread
+    // sets the requested type and flags a reset that gets applied on the next buffer
+    std::atomic<dsp::compression::PCMType> requestedPCMType = dsp::compression::PCM_TYPE_I16;
+    std::atomic<bool> adaptiveResetPending = false;
+    dsp::compression::PCMType currentPCMType = dsp::compression::PCM_TYPE_I16;
+    int adaptiveLevelId = 2;
+    int linkPressure = 0;
+    int cpuPressure = 0;
+    int adaptCounter = 0;
+    int lastDropped = 0;
+    std::chrono::high_resolution_clock::time_point lastBuffer;
+
+    // Statistics sent back to the client
+    uint64_t statsInBytes = 0;
+    uint64_t statsOutBytes = 0;
+    std::chrono::high_resolution_clock::time_point lastStats;
+
     int main() {
         spdlog::info("=====| SERVER MODE |=====");
 
         // Init DSP
-        comp.init(&dummyInput, dsp::compression::PCM_TYPE_I8);
+        inputSplit.init(&dummyInput);
+        comp.init(&basebandInput, dsp::compression::PCM_TYPE_I8);
         hnd.init(&comp.out, _testServerHandler, NULL);
         rbuf = new uint8_t[SERVER_MAX_PACKET_SIZE];
         sbuf = new uint8_t[SERVER_MAX_PACKET_SIZE];
@@ -72,8 +126,17 @@ namespace server {
         bb_pkt_hdr = (PacketHeader*)bbuf;
         bb_pkt_data = &bbuf[sizeof(PacketHeader)];
 
-        // Initialize compressor
-        cctx = ZSTD_createCCtx();
+        // Initialize compressor, leaving some cores for the DSP
+        compressor.init(std::clamp<int>(std::thread::hardware_concurrency() / 2, 1, 8));
+
+        // The front end only gets samples for the spectrum or narrowband streams, it has no display to feed
+        sigpath::iqFrontEnd.init(&frontEndInput, sampleRate, false, 1, false, 1024, 20.0, IQFrontEnd::FFTWindow::NUTTALL, NULL, NULL, NULL);
+        sigpath::iqFrontEnd.start();
+        updateRouting();
+        inputSplit.start();
+        spectrumHandler.handler = _spectrumHandler;
+        spectrumHandler.ctx = NULL;
+        sigpath::spectrum.bindHandler(&spectrumHandler);
 
         // Load config
         core::configManager.acquire();
@@ -88,6 +151,8 @@ namespace server {
         SmGui::init(true);
 
         spdlog::info("Loading modules");
+        std::vector<std::string> modPaths;
+
         // Load modules and check type to only load sources ( TODO: Have a proper type parameter int the info )
         // TODO LATER: Add whitelist/blacklist stuff
         if (std::filesystem::is_directory(modulesDir)) {
@@ -101,7 +166,7 @@ namespace server {
                 if (fn.find("source") == std::string::npos) { continue; }
 
                 spdlog::info("Loading {0}", path);
-                core::moduleManager.loadModule(path);
+                modPaths.push_back(path);
             }
         }
         else {
@@ -121,8 +186,9 @@ namespace server {
             if (fn.find("source") == std::string::npos) { continue; }
 
             spdlog::info("Loading {0}", path);
-            core::moduleManager.loadModule(path);
+            modPaths.push_back(path);
         }
+        core::moduleManager.loadModules(modPaths);
 
         // Create module instances
         for (auto const& [name, _module] : modList) {
@@ -134,7 +200,7 @@ namespace server {
             if (!enabled) { core::moduleManager.disableInstance(name); }
         }
 
-        // Do post-init
+        // Do post-init. Sources only start looking for their devices there, so this doesn't delay serving
         core::moduleManager.doPostInitAll();
 
         // Generate source list
@@ -186,12 +252,24 @@ namespace server {
 
         spdlog::info("Connection from {0}:{1}", "TODO", "TODO");
         client = std::move(conn);
+
+        // Configure the socket for streaming. If the link can't keep up, the oldest spectrum frame
+        // is dropped, baseband and narrowband streams wait for room in the queue instead
+        int sockBuf = (int)core::args["sockbuf"];
+        if (sockBuf > 0) { client->setSendBufferSize(sockBuf); }
+        client->setNoDelay(true);
+        client->setReadBuffer(SERVER_READ_BUFFER_SIZE);
+        client->setWriteQueue(SERVER_MAX_WRITE_QUEUE, net::WRITE_DROP_POLICY_OLDEST);
+
         client->readAsync(sizeof(PacketHeader), rbuf, _packetHandler, NULL);
 
         // Perform settings reset
         sigpath::sourceManager.stop();
-        comp.setPCMType(dsp::compression::PCM_TYPE_I16);
+        removeAllVFOs();
+        setStreamingMode(STREAMING_MODE_BASEBAND);
         compression = false;
+        compressionLevel = 1;
+        requestPCMType(dsp::compression::PCM_TYPE_I16);
 
         sendSampleRate(sampleRate);
 
@@ -227,10 +305,31 @@ namespace server {
     }
 
     void _testServerHandler(uint8_t* data, int count, void* ctx) {
+        auto now = std::chrono::high_resolution_clock::now();
+        double interval = std::chrono::duration<double>(now - lastBuffer).count();
+        lastBuffer = now;
+
+        // Apply changes requested by the client since the last buffer
+        if (adaptiveResetPending.exchange(false)) {
+            resetAdaptiveCompression();
+            statsInBytes = 0;
+            statsOutBytes = 0;
+            lastStats = now;
+        }
+
         // Compress data if needed and fill out header fields
+        int compSize = -1;
+        double compTime = 0.0;
+        int level = compressionLevel;
+        bool adaptive = (level == SERVER_COMPRESSION_LEVEL_ADAPTIVE);
+        if (adaptive) { level = adaptiveLevels[adaptiveLevelId]; }
         if (compression) {
+            compSize = compressor.compress(&bbuf[sizeof(PacketHeader)], SERVER_MAX_PACKET_SIZE - sizeof(PacketHeader), data, count, level);
+            compTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - now).count();
+        }
+        if (compSize >= 0) {
             bb_pkt_hdr->type = PACKET_TYPE_BASEBAND_COMPRESSED;
-            bb_pkt_hdr->size = sizeof(PacketHeader) + (uint32_t)ZSTD_compressCCtx(cctx, &bbuf[sizeof(PacketHeader)], SERVER_MAX_PACKET_SIZE, data, count, 1);
+            bb_pkt_hdr->size = sizeof(PacketHeader) + compSize;
         }
         else {
             bb_pkt_hdr->type = PACKET_TYPE_BASEBAND;
@@ -238,17 +337,266 @@ namespace server {
             memcpy(&bbuf[sizeof(PacketHeader)], data, count);
         }
 
-        // Write to network
-        if (client && client->isOpen()) { client->write(bb_pkt_hdr->size, bbuf); }
+        // Queue for the network, the buffer is reused so the data has to be copied
+        if (!client || !client->isOpen()) { return; }
+        client->writeAsync(bb_pkt_hdr->size, bbuf, true, false);
+
+        // Update statistics and adapt to the link
+        statsInBytes += count;
+        statsOutBytes += bb_pkt_hdr->size;
+        if (compression && adaptive) {
+            adaptCompression(compTime, interval);
+        }
+        if (std::chrono::duration<double>(now - lastStats).count() >= 1.0) {
+            sendCompressionStats(std::chrono::duration<double>(now - lastStats).count());
+            lastStats = now;
+        }
+    }
+
+    void _spectrumHandler(SpectrumFrameRef frame, void* ctx) {
+        if (streamingMode != STREAMING_MODE_FFT || !client || !client->isOpen()) { return; }
+        int count = frame->size();
+        if (!count) { return; }
+
+        // Quantize to 8 bits over the range of this frame
+        const float* data = frame->data.data();
+        float min = data[0];
+        float max = data[0];
+        for (int i = 1; i < count; i++) {
+            min = std::min<float>(min, data[i]);
+            max = std::max<float>(max, data[i]);
+        }
+        float step = std::max<float>((max - min) / 255.0f, SERVER_FFT_MIN_STEP);
+
+        int size = sizeof(PacketHeader) + sizeof(FFTHeader) + count;
+        if (fftBuf.size() < size) { fftBuf.resize(size); }
+        PacketHeader* hdr = (PacketHeader*)fftBuf.data();
+        FFTHeader* fhdr = (FFTHeader*)&fftBuf[sizeof(PacketHeader)];
+        uint8_t* bins = &fftBuf[sizeof(PacketHeader) + sizeof(FFTHeader)];
+        hdr->type = PACKET_TYPE_FFT;
+        hdr->size = size;
+        fhdr->centerFrequency = frame->centerFrequency;
+        fhdr->sampleRate = frame->sampleRate;
+        fhdr->offset = min;
+        fhdr->step = step;
+        float scale = 1.0f / step;
+        for (int i = 0; i < count; i++) {
+            bins[i] = std::min<int>(((data[i] - min) * scale) + 0.5f, 255);
+        }
+
+        client->writeAsync(size, fftBuf.data(), true);
+    }
+
+    void _vfoHandler(dsp::complex_t* data, int count, void* ctx) {
+        ServerVFO* vfo = (ServerVFO*)ctx;
+        if (!client || !client->isOpen()) { return; }
+
+        // Narrowband streams are small enough to always be sent as uncompressed 16 bit samples
+        int maxSize = sizeof(PacketHeader) + sizeof(VFOHeader) + 8 + (count * sizeof(int16_t) * 2);
+        if (vfo->buf.size() < maxSize) { vfo->buf.resize(maxSize); }
+        PacketHeader* hdr = (PacketHeader*)vfo->buf.data();
+        VFOHeader* vhdr = (VFOHeader*)&vfo->buf[sizeof(PacketHeader)];
+        uint8_t* samples = &vfo->buf[sizeof(PacketHeader) + sizeof(VFOHeader)];
+        vhdr->id = vfo->id;
+        int size = dsp::compression::SampleStreamCompressor::process(count, dsp::compression::PCM_TYPE_I16, data, samples);
+        hdr->type = PACKET_TYPE_VFO;
+        hdr->size = sizeof(PacketHeader) + sizeof(VFOHeader) + size;
+
+        client->writeAsync(hdr->size, vfo->buf.data(), true, false);
+    }
+
+    void setStreamingMode(StreamingMode mode) {
+        std::lock_guard<std::mutex> lck(streamingModeMtx);
+        streamingMode = mode;
+        updateRouting();
+    }
+
+    void updateRouting() {
+        // The compressor only gets samples in baseband mode, the front end for the spectrum or any narrowband stream
+        bool baseband = (streamingMode == STREAMING_MODE_BASEBAND);
+        bool frontEnd = (streamingMode == STREAMING_MODE_FFT || vfoCount > 0);
+        if (baseband != basebandBound) {
+            if (baseband) { inputSplit.bindStream(&basebandInput); }
+            else { inputSplit.unbindStream(&basebandInput); }
+            basebandBound = baseband;
+        }
+        if (frontEnd != frontEndBound) {
+            if (frontEnd) { inputSplit.bindStream(&frontEndInput); }
+            else { inputSplit.unbindStream(&frontEndInput); }
+            frontEndBound = frontEnd;
+        }
+    }
+
+    bool setVFO(const VFOSettings& settings) {
+        if (settings.sampleRate <= 0.0 || settings.bandwidth <= 0.0) { return false; }
+        double bandwidth = std::min<double>(settings.bandwidth, settings.sampleRate);
+        std::unique_lock<std::mutex> lck(vfoMtx);
+
+        // Update the VFO if it already exists
+        auto it = vfos.find(settings.id);
+        if (it != vfos.end()) {
+            it->second->vfo->setOutSamplerate(settings.sampleRate, bandwidth);
+            it->second->vfo->setOffset(settings.offset);
+            return true;
+        }
+
+        if (vfos.size() >= SERVER_MAX_VFO_COUNT) { return false; }
+        ServerVFO* vfo = new ServerVFO;
+        vfo->id = settings.id;
+        vfo->name = "server_vfo_" + std::to_string(settings.id);
+        vfo->vfo = sigpath::iqFrontEnd.addVFO(vfo->name, settings.sampleRate, bandwidth, settings.offset);
+        if (!vfo->vfo) {
+            delete vfo;
+            return false;
+        }
+        vfo->sink.init(&vfo->vfo->out, _vfoHandler, vfo);
+        vfo->sink.start();
+        vfos[settings.id] = vfo;
+        vfoCount = vfos.size();
+        lck.unlock();
+
+        // Narrowband streams are sent in either mode, feed the front end if it wasn't already
+        std::lock_guard<std::mutex> lck2(streamingModeMtx);
+        updateRouting();
+        return true;
+    }
+
+    void removeVFO(uint32_t id) {
+        std::unique_lock<std::mutex> lck(vfoMtx);
+        auto it = vfos.find(id);
+        if (it == vfos.end()) { return; }
+        destroyVFO(it->second);
+        vfos.erase(it);
+        vfoCount = vfos.size();
+        lck.unlock();
+
+        std::lock_guard<std::mutex> lck2(streamingModeMtx);
+        updateRouting();
+    }
+
+    void removeAllVFOs() {
+        std::unique_lock<std::mutex> lck(vfoMtx);
+        for (auto& [id, vfo] : vfos) { destroyVFO(vfo); }
+        vfos.clear();
+        vfoCount = 0;
+        lck.unlock();
+
+        std::lock_guard<std::mutex> lck2(streamingModeMtx);
+        updateRouting();
+    }
+
+    void destroyVFO(ServerVFO* vfo) {
+        vfo->sink.stop();
+        sigpath::iqFrontEnd.removeVFO(vfo->name);
+        delete vfo;
+    }
+
+    void adaptCompression(double compTime, double interval) {
+        // The link is the bottleneck if buffers pile up or get dropped,
+        // the CPU is if compressing takes most of the time between buffers
+        int queued = client->getWriteQueueSize();
+        int dropped = client->getDroppedWrites();
+        if (dropped > lastDropped || queued >= SERVER_MAX_WRITE_QUEUE / 2) { linkPressure++; }
+        if (compTime > 0.75 * interval) { cpuPressure++; }
+        lastDropped = dropped;
+        if (++adaptCounter < adaptPeriod) { return; }
+
+        if (cpuPressure > adaptPeriod / 2) {
+            // Compress faster even if it costs bandwidth
+            if (adaptiveLevelId > 0) { adaptiveLevelId--; }
+        }
+        else if (linkPressure > adaptPeriod / 4) {
+            // Compress harder, then reduce bit depth if that still isn't enough
+            if (adaptiveLevelId < adaptiveLevelCount - 1) { adaptiveLevelId++; }
+            else if (currentPCMType == dsp::compression::PCM_TYPE_F32) { setPCMType(dsp::compression::PCM_TYPE_I16); }
+            else if (currentPCMType != dsp::compression::PCM_TYPE_I8) { setPCMType(dsp::compression::PCM_TYPE_I8); }
+        }
+        else if (!linkPressure) {
+            // Restore the bit depth the client asked for before spending less CPU
+            dsp::compression::PCMType requested = requestedPCMType;
+            if (currentPCMType == dsp::compression::PCM_TYPE_I8 && requested == dsp::compression::PCM_TYPE_BFP) {
+                setPCMType(dsp::compression::PCM_TYPE_BFP);
+            }
+            else if (currentPCMType != requested) {
+                setPCMType((currentPCMType == dsp::compression::PCM_TYPE_I8) ? dsp::compression::PCM_TYPE_I16 : dsp::compression::PCM_TYPE_F32);
+            }
+        }
+
+        linkPressure = 0;
+        cpuPressure = 0;
+        adaptCounter = 0;
+    }
+
+    void resetAdaptiveCompression() {
+        adaptiveLevelId = 2;
+        linkPressure = 0;
+        cpuPressure = 0;
+        adaptCounter = 0;
+        lastDropped = client ? client->getDroppedWrites() : 0;
+        currentPCMType = requestedPCMType;
+        comp.setPCMType(currentPCMType);
+    }
+
+    void requestPCMType(dsp::compression::PCMType type) {
+        // The compressor switches on its next buffer, the adaptive state follows in the handler
+        requestedPCMType = type;
+        comp.setPCMType(type);
+        adaptiveResetPending = true;
+    }
+
+    int pcmTypeRank(dsp::compression::PCMType type) {
+        // Precision of each type, block floating point is normally used below 16 bits
+        switch (type) {
+            case dsp::compression::PCM_TYPE_I8:     return 0;
+            case dsp::compression::PCM_TYPE_BFP:    return 1;
+            case dsp::compression::PCM_TYPE_I16:    return 2;
+            case dsp::compression::PCM_TYPE_F32:    return 3;
+            default:                                return 0;
+        }
+    }
+
+    void setPCMType(dsp::compression::PCMType type) {
+        // Never go above what the client asked for
+        dsp::compression::PCMType requested = requestedPCMType;
+        if (pcmTypeRank(type) > pcmTypeRank(requested)) { type = requested; }
+        if (type == currentPCMType) { return; }
+        currentPCMType = type;
+        comp.setPCMType(type);
+    }
+
+    void sendCompressionStats(double period) {
+        // The command buffer belongs to the network thread, use a separate one
+        uint8_t buf[sizeof(PacketHeader) + sizeof(CommandHeader) + sizeof(CompressionStats)];
+        PacketHeader* hdr = (PacketHeader*)buf;
+        CommandHeader* chdr = (CommandHeader*)&buf[sizeof(PacketHeader)];
+        CompressionStats* stats = (CompressionStats*)&buf[sizeof(PacketHeader) + sizeof(CommandHeader)];
+        hdr->type = PACKET_TYPE_COMMAND;
+        hdr->size = sizeof(buf);
+        chdr->cmd = COMMAND_COMPRESSION_STATS;
+
+        stats->ratio = statsOutBytes ? ((float)statsInBytes / (float)statsOutBytes) : 1.0f;
+        stats->bandwidth = (float)statsOutBytes / period;
+        int level = compressionLevel;
+        if (level == SERVER_COMPRESSION_LEVEL_ADAPTIVE) { level = adaptiveLevels[adaptiveLevelId]; }
+        stats->level = compression ? level : 0;
+        stats->sampleType = currentPCMType;
+        stats->queueDepth = client->getWriteQueueSize();
+        stats->dropped = client->getDroppedWrites();
+        client->writeAsync(sizeof(buf), buf, true, false);
+
+        statsInBytes = 0;
+        statsOutBytes = 0;
     }
 
     void setInput(dsp::stream<dsp::complex_t>* stream) {
-        comp.setInput(stream);
+        inputSplit.setInput(stream);
     }
 
     void commandHandler(Command cmd, uint8_t* data, int len) {
         if (cmd == COMMAND_GET_UI) {
-            sendUI(COMMAND_GET_UI, "", dummyElem);
+            // The client can send the hash of the UI it has to avoid getting it again
+            bool hashed = (len == sizeof(uint64_t));
+            sendUI(COMMAND_GET_UI, "", dummyElem, hashed, hashed ? *(uint64_t*)data : 0);
         }
         else if (cmd == COMMAND_UI_ACTION && len >= 3) {
             // Check if sending back data is needed
@@ -271,9 +619,12 @@ namespace server {
             i += count;
             len -= count;
 
+            // Optionally followed by the hash of the client's UI
+            bool hashed = (len == sizeof(uint64_t));
+
             // Render and send back
             if (sendback) {
-                sendUI(COMMAND_UI_ACTION, diffId.str, diffValue);
+                sendUI(COMMAND_UI_ACTION, diffId.str, diffValue, hashed, hashed ? *(uint64_t*)&data[i] : 0);
             }
             else {
                 renderUI(NULL, diffId.str, diffValue);
@@ -291,13 +642,45 @@ namespace server {
             sigpath::sourceManager.tune(*(double*)data);
             sendCommandAck(COMMAND_SET_FREQUENCY, 0);
         }
-        else if (cmd == COMMAND_SET_SAMPLE_TYPE && len == 1) {
-            dsp::compression::PCMType type = (dsp::compression::PCMType)*(uint8_t*)data;
-            comp.setPCMType(type);
+        else if (cmd == COMMAND_SET_SAMPLE_TYPE && (len == 1 || len == 3)) {
+            // Packed types are followed by their bit depth and flags
+            uint8_t type = data[0];
+            if (type > dsp::compression::PCM_TYPE_BFP) { sendError(ERROR_INVALID_ARGUMENT); return; }
+            if (len == 3) {
+                if (data[1] < BFP_MIN_BITS || data[1] > BFP_MAX_BITS) { sendError(ERROR_INVALID_ARGUMENT); return; }
+                comp.setBitDepth(data[1], data[2] & BFP_FLAG_DELTA);
+            }
+            requestPCMType((dsp::compression::PCMType)type);
         }
         else if (cmd == COMMAND_SET_COMPRESSION && len == 1) {
             compression = *(uint8_t*)data;
         }
+        else if (cmd == COMMAND_SET_COMPRESSION_LEVEL && len == 1) {
+            int level = *(int8_t*)data;
+            if (level < ZSTD_minCLevel() || level > ZSTD_maxCLevel()) { sendError(ERROR_INVALID_ARGUMENT); return; }
+            compressionLevel = level;
+            adaptiveResetPending = true;
+        }
+        else if (cmd == COMMAND_SET_STREAMING_MODE && len == 1) {
+            if (data[0] > STREAMING_MODE_FFT) { sendError(ERROR_INVALID_ARGUMENT); return; }
+            setStreamingMode((StreamingMode)data[0]);
+        }
+        else if (cmd == COMMAND_SET_FFT && len == sizeof(FFTSettings)) {
+            FFTSettings* settings = (FFTSettings*)data;
+            if (!(settings->rate > 0.0f)) { sendError(ERROR_INVALID_ARGUMENT); return; }
+            sigpath::iqFrontEnd.setFFTSize(std::clamp<int>(settings->size, SERVER_MIN_FFT_SIZE, SERVER_MAX_FFT_SIZE));
+            sigpath::iqFrontEnd.setFFTRate(std::min<float>(settings->rate, SERVER_MAX_FFT_RATE));
+        }
+        else if (cmd == COMMAND_SET_VFO && len == sizeof(VFOSettings)) {
+            if (!setVFO(*(VFOSettings*)data)) { sendError(ERROR_INVALID_ARGUMENT); }
+        }
+        else if (cmd == COMMAND_REMOVE_VFO && len == sizeof(uint32_t)) {
+            removeVFO(*(uint32_t*)data);
+        }
+        else if (cmd == COMMAND_GET_VERSION) {
+            *(uint32_t*)s_cmd_data = SERVER_PROTOCOL_VERSION;
+            sendCommandAck(COMMAND_GET_VERSION, sizeof(uint32_t));
+        }
         else {
             spdlog::error("Invalid Command: {0} (len = {1})", cmd, len);
             sendError(ERROR_INVALID_COMMAND);
@@ -339,17 +722,29 @@ namespace server {
         }
     }
 
-    void sendUI(Command originCmd, std::string diffId, SmGui::DrawListElem diffValue) {
+    void sendUI(Command originCmd, std::string diffId, SmGui::DrawListElem diffValue, bool hashed, uint64_t knownHash) {
         // Render UI
         SmGui::DrawList dl;
         renderUI(&dl, diffId, diffValue);
 
+        // Clients that sent the hash of their UI get a status byte first and nothing else if it's up to date
+        int offset = 0;
+        if (hashed) {
+            if (dl.getHash() == knownHash) {
+                s_cmd_data[0] = UI_REPLY_UNCHANGED;
+                sendCommandAck(originCmd, 1);
+                return;
+            }
+            s_cmd_data[0] = UI_REPLY_FULL;
+            offset = 1;
+        }
+
         // Create response
         int size = dl.getSize();
-        dl.store(s_cmd_data, size);
+        dl.store(&s_cmd_data[offset], size);
 
         // Send to network
-        sendCommandAck(originCmd, size);
+        sendCommandAck(originCmd, offset + size);
     }
 
     void sendError(Error err) {
@@ -365,6 +760,7 @@ namespace server {
 
     void setInputSampleRate(double samplerate) {
         sampleRate = samplerate;
+        sigpath::iqFrontEnd.setSampleRate(sampleRate);
         if (!client || !client->isOpen()) { return; }
         sendSampleRate(sampleRate);
     }
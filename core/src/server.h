@@ -2,21 +2,41 @@
 #include <utils/networking.h>
 #include <dsp/stream.h>
 #include <dsp/types.h>
+#include <dsp/compression/pcm_type.h>
 #include <server_protocol.h>
+#include <signal_path/spectrum.h>
 
 namespace server {
+    struct ServerVFO;
+
     void setInput(dsp::stream<dsp::complex_t>* stream);
     int main();
 
     void _clientHandler(net::Conn conn, void* ctx);
     void _packetHandler(int count, uint8_t* buf, void* ctx);
     void _testServerHandler(uint8_t* data, int count, void* ctx);
+    void _spectrumHandler(SpectrumFrameRef frame, void* ctx);
+    void _vfoHandler(dsp::complex_t* data, int count, void* ctx);
+
+    void setStreamingMode(StreamingMode mode);
+    void updateRouting();
+    bool setVFO(const VFOSettings& settings);
+    void removeVFO(uint32_t id);
+    void removeAllVFOs();
+    void destroyVFO(ServerVFO* vfo);
+
+    void adaptCompression(double compTime, double interval);
+    void resetAdaptiveCompression();
+    void requestPCMType(dsp::compression::PCMType type);
+    int pcmTypeRank(dsp::compression::PCMType type);
+    void setPCMType(dsp::compression::PCMType type);
+    void sendCompressionStats(double period);
 
     void drawMenu();
 
     void commandHandler(Command cmd, uint8_t* data, int len);
     void renderUI(SmGui::DrawList* dl, std::string diffId, SmGui::DrawListElem diffValue);
-    void sendUI(Command originCmd, std::string diffId, SmGui::DrawListElem diffValue);
+    void sendUI(Command originCmd, std::string diffId, SmGui::DrawListElem diffValue, bool hashed = false, uint64_t knownHash = 0);
     void sendError(Error err);
     void sendSampleRate(double sampleRate);
     void setInputSampleRate(double samplerate);
@@ -4,6 +4,24 @@
 #include <dsp/types.h>
 
 #define SERVER_MAX_PACKET_SIZE  (STREAM_BUFFER_SIZE * sizeof(dsp::complex_t) * 2)
+#define SERVER_READ_BUFFER_SIZE 0x10000
+#define SERVER_MAX_WRITE_QUEUE  8
+
+// Sent in reply to COMMAND_GET_VERSION, servers that don't know that command are version 0
+// 1: UI requests can carry the hash of the client's UI, replies to those start with a UIReply
+#define SERVER_PROTOCOL_VERSION 1
+
+// Compression level requested by the client to let the server pick one
+#define SERVER_COMPRESSION_LEVEL_ADAPTIVE   0
+
+// Limits for the spectrum and narrowband streams a client can ask for
+#define SERVER_MIN_FFT_SIZE     256
+#define SERVER_MAX_FFT_SIZE     65536
+#define SERVER_MAX_FFT_RATE     60.0f
+#define SERVER_MAX_VFO_COUNT    8
+
+// Smallest dB step of the quantized spectrum
+#define SERVER_FFT_MIN_STEP     0.1f
 
 namespace server {
     enum PacketType {
@@ -27,10 +45,28 @@ namespace server {
         COMMAND_GET_SAMPLERATE,
         COMMAND_SET_SAMPLE_TYPE,
         COMMAND_SET_COMPRESSION,
+        COMMAND_SET_COMPRESSION_LEVEL,
+        COMMAND_SET_STREAMING_MODE,
+        COMMAND_SET_FFT,
+        COMMAND_SET_VFO,
+        COMMAND_REMOVE_VFO,
+        COMMAND_GET_VERSION,
 
         // Server to client
         COMMAND_SET_SAMPLERATE = 0x80,
-        COMMAND_DISCONNECT
+        COMMAND_DISCONNECT,
+        COMMAND_COMPRESSION_STATS
+    };
+
+    enum StreamingMode {
+        STREAMING_MODE_BASEBAND,    // Full rate baseband, the client computes everything
+        STREAMING_MODE_FFT          // Server side spectrum and narrowband VFO streams only
+    };
+
+    // First byte of a UI reply to a client that sent the hash of the UI it has
+    enum UIReply {
+        UI_REPLY_FULL,      // Followed by the whole UI
+        UI_REPLY_UNCHANGED  // The client's UI is up to date, nothing follows
     };
 
     enum Error {
@@ -49,5 +85,40 @@ namespace server {
     struct CommandHeader {
         uint32_t cmd;
     };
+
+    struct CompressionStats {
+        float ratio;
+        float bandwidth;
+        int8_t level;
+        uint8_t sampleType;
+        uint16_t queueDepth;
+        uint32_t dropped;
+    };
+
+    struct FFTSettings {
+        uint32_t size;
+        float rate;
+    };
+
+    // Followed by one byte per bin, the level of a bin in dB is offset + (value * step)
+    struct FFTHeader {
+        double centerFrequency;
+        double sampleRate;
+        float offset;
+        float step;
+    };
+
+    // Creates the VFO or updates it if the id is already in use
+    struct VFOSettings {
+        uint32_t id;
+        double sampleRate;
+        double bandwidth;
+        double offset;
+    };
+
+    // Followed by the samples in the same format as uncompressed baseband
+    struct VFOHeader {
+        uint32_t id;
+    };
 #pragma pack(pop)
 }
\ No newline at end of file
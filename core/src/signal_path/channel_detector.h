@@ -0,0 +1,110 @@
+#pragma once
+#include <vector>
+#include <math.h>
+#include <algorithm>
+#include <signal_path/spectrum.h>
+#include <dsp/detector/noise_floor.h>
+
+// Evaluates every channel of a frequency plan that falls within a spectrum frame in a
+// single pass, tracking the noise floor of each channel and applying hysteresis.
+class ChannelDetector {
+public:
+    struct Channel {
+        float level = -INFINITY;
+        float floor = NAN;
+        bool active = false;
+        uint64_t lastSeen = 0;  // Id of the last frame that covered the channel
+    };
+
+    void configure(double start, double stop, double interval, double width) {
+        _start = start;
+        _interval = std::max<double>(interval, 1.0);
+        _width = width;
+        int count = std::max<int>(floor((stop - start) / _interval) + 1, 1);
+        channels.assign(count, Channel());
+        floors.init(count, FLOOR_SUB_WINDOW);
+    }
+
+    void setThreshold(float threshold, float hysteresis) {
+        _threshold = threshold;
+        _hysteresis = hysteresis;
+    }
+
+    void setMinimumLevel(float level) {
+        _minLevel = level;
+    }
+
+    // Range of channels whose passband lies entirely within [start, end], last < first if none
+    void coveredRange(double start, double end, int& first, int& last) {
+        first = std::max<int>(ceil((start + (_width / 2.0) - _start) / _interval), 0);
+        last = std::min<int>(floor((end - (_width / 2.0) - _start) / _interval), channels.size() - 1);
+    }
+
+    // Updates every channel covered by [start, end] of the frame, returns the number of active ones
+    int process(const SpectrumFrame& frame, double start, double end) {
+        if (channels.empty() || frame.data.empty()) { return 0; }
+        int first, last;
+        coveredRange(start, end, first, last);
+
+        // Pre-compute the bin span of a channel, it's identical for all channels of the frame
+        double binWidth = frame.binWidth();
+        int halfBins = std::max<int>(round((_width / 2.0) / binWidth), 0);
+        const float* data = frame.data.data();
+        int size = frame.size();
+
+        int activeCount = 0;
+        for (int i = first; i <= last; i++) {
+            Channel& ch = channels[i];
+            int center = frame.frequencyBin(_start + (i * _interval));
+            int lo = std::max<int>(center - halfBins, 0);
+            int hi = std::min<int>(center + halfBins, size - 1);
+
+            float level = -INFINITY;
+            for (int j = lo; j <= hi; j++) { level = std::max<float>(level, data[j]); }
+            ch.level = level;
+            ch.lastSeen = frame.id;
+
+            // Track the noise floor, only letting it drop while the channel is active
+            if (ch.active) { floors.hold(i, level); }
+            else { floors.update(i, level); }
+            ch.floor = floors[i];
+
+            // Apply hysteresis around the threshold
+            float snr = level - ch.floor;
+            if (ch.active) {
+                ch.active = (snr >= _threshold - _hysteresis) && (level >= _minLevel - _hysteresis);
+            }
+            else {
+                ch.active = (snr >= _threshold) && (level >= _minLevel);
+            }
+            if (ch.active) { activeCount++; }
+        }
+
+        return activeCount;
+    }
+
+    inline int channelCount() { return channels.size(); }
+
+    inline double width() { return _width; }
+
+    inline double frequency(int id) { return _start + (id * _interval); }
+
+    inline int channelId(double freq) {
+        return std::clamp<int>(round((freq - _start) / _interval), 0, channels.size() - 1);
+    }
+
+    inline Channel& operator[](int id) { return channels[id]; }
+
+private:
+    // Number of observations of a channel per noise floor sub-window
+    static constexpr int FLOOR_SUB_WINDOW = 16;
+
+    std::vector<Channel> channels;
+    dsp::detector::NoiseFloor floors;
+    double _start = 0.0;
+    double _interval = 1.0;
+    double _width = 0.0;
+    float _threshold = 10.0f;
+    float _hysteresis = 3.0f;
+    float _minLevel = -INFINITY;
+};
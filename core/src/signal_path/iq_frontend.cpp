@@ -4,6 +4,7 @@
 #include <spdlog/spdlog.h>
 #include <gui/gui.h>
 #include <core.h>
+#include "signal_path.h"
 
 IQFrontEnd::~IQFrontEnd() {
     if (!_init) { return; }
@@ -12,6 +13,7 @@ IQFrontEnd::~IQFrontEnd() {
     fftwf_destroy_plan(fftwPlan);
     fftwf_free(fftInBuf);
     fftwf_free(fftOutBuf);
+    dsp::buffer::free(fftDbOut);
 }
 
 void IQFrontEnd::init(dsp::stream<dsp::complex_t>* in, double sampleRate, bool buffering, int decimRatio, bool dcBlocking, int fftSize, double fftRate, FFTWindow fftWindow, float* (*acquireFFTBuffer)(void* ctx), void (*releaseFFTBuffer)(void* ctx), void* fftCtx) {
@@ -60,6 +62,7 @@ void IQFrontEnd::init(dsp::stream<dsp::complex_t>* in, double sampleRate, bool b
     fftInBuf = (fftwf_complex*)fftwf_malloc(_fftSize * sizeof(fftwf_complex));
     fftOutBuf = (fftwf_complex*)fftwf_malloc(_fftSize * sizeof(fftwf_complex));
     fftwPlan = fftwf_plan_dft_1d(_fftSize, fftInBuf, fftOutBuf, FFTW_FORWARD, FFTW_ESTIMATE);
+    fftDbOut = dsp::buffer::alloc<float>(_fftSize);
 
     // Clear the rest of the FFT input buffer
     dsp::buffer::clear(fftInBuf, _fftSize - _nzFFTSize, _nzFFTSize);
@@ -137,6 +140,21 @@ void IQFrontEnd::unbindIQStream(dsp::stream<dsp::complex_t>* stream) {
     split.unbindStream(stream);
 }
 
+void IQFrontEnd::setVFOExecutor(dsp::Executor* executor) {
+    vfoExecutor = executor;
+    for (auto& [name, vfo] : vfos) {
+        vfo->setExecutor(executor);
+    }
+}
+
+void IQFrontEnd::setPreprocCores(std::vector<int> cores) {
+    inBuf.setThreadOptions("iq_buffer", cores);
+    decim.setThreadOptions("iq_decim", cores);
+    dcBlock.setThreadOptions("iq_dc_block", cores);
+    conjugate.setThreadOptions("iq_conjugate", cores);
+    split.setThreadOptions("iq_split", cores);
+}
+
 dsp::channel::RxVFO* IQFrontEnd::addVFO(std::string name, double sampleRate, double bandwidth, double offset) {
     // Make sure no other VFO with that name already exists
     if (vfos.find(name) != vfos.end()) {
@@ -154,6 +172,7 @@ dsp::channel::RxVFO* IQFrontEnd::addVFO(std::string name, double sampleRate, dou
     bindIQStream(vfoIn);
 
     // Start VFO
+    if (vfoExecutor) { vfo->setExecutor(vfoExecutor); }
     vfo->start();
 
     return vfo;
@@ -245,8 +264,33 @@ double IQFrontEnd::getEffectiveSamplerate() {
     return effectiveSr;
 }
 
+void IQFrontEnd::pushExternalFFT(const float* data, int count) {
+    if (count <= 0) { return; }
+    std::lock_guard<std::mutex> lck(fftMtx);
+
+    // Resample to the FFT size, keeping the peak of the bins that get merged
+    double ratio = (double)count / (double)_fftSize;
+    for (int i = 0; i < _fftSize; i++) {
+        int start = std::min<int>(i * ratio, count - 1);
+        int end = std::clamp<int>((i + 1) * ratio, start + 1, count);
+        float peak = data[start];
+        for (int j = start + 1; j < end; j++) { peak = std::max<float>(peak, data[j]); }
+        fftDbOut[i] = peak;
+    }
+
+    // Publish the frame just like a local one
+    sigpath::spectrum.publish(fftDbOut, _fftSize, sigpath::sourceManager.getCurrentFrequency(), effectiveSr);
+    if (!_acquireFFTBuffer) { return; }
+    float* fftBuf = _acquireFFTBuffer(_fftCtx);
+    if (fftBuf) {
+        memcpy(fftBuf, fftDbOut, _fftSize * sizeof(float));
+    }
+    _releaseFFTBuffer(_fftCtx);
+}
+
 void IQFrontEnd::handler(dsp::complex_t* data, int count, void* ctx) {
     IQFrontEnd* _this = (IQFrontEnd*)ctx;
+    std::lock_guard<std::mutex> lck(_this->fftMtx);
 
     // Apply window
     volk_32fc_32f_multiply_32fc((lv_32fc_t*)_this->fftInBuf, (lv_32fc_t*)data, _this->fftWindowBuf, _this->_nzFFTSize);
@@ -254,15 +298,18 @@ void IQFrontEnd::handler(dsp::complex_t* data, int count, void* ctx) {
     // Execute FFT
     fftwf_execute(_this->fftwPlan);
 
-    // Aquire buffer
-    float* fftBuf = _this->_acquireFFTBuffer(_this->_fftCtx);
-
     // Convert the complex output of the FFT to dB amplitude
+    volk_32fc_s32f_power_spectrum_32f(_this->fftDbOut, (lv_32fc_t*)_this->fftOutBuf, _this->_fftSize, _this->_fftSize);
+
+    // Publish the full resolution frame
+    sigpath::spectrum.publish(_this->fftDbOut, _this->_fftSize, sigpath::sourceManager.getCurrentFrequency(), _this->effectiveSr);
+
+    // Hand a copy to the display if it wants one
+    if (!_this->_acquireFFTBuffer) { return; }
+    float* fftBuf = _this->_acquireFFTBuffer(_this->_fftCtx);
     if (fftBuf) {
-        volk_32fc_s32f_power_spectrum_32f(fftBuf, (lv_32fc_t*)_this->fftOutBuf, _this->_fftSize, _this->_fftSize);
+        memcpy(fftBuf, _this->fftDbOut, _this->_fftSize * sizeof(float));
     }
-
-    // Release buffer
     _this->_releaseFFTBuffer(_this->_fftCtx);
 }
 
@@ -270,6 +317,7 @@ void IQFrontEnd::updateFFTPath(bool updateWaterfall) {
     // Temp stop branch
     reshape.tempStop();
     fftSink.tempStop();
+    std::unique_lock<std::mutex> lck(fftMtx);
 
     // Update reshaper settings
     int skip;
@@ -296,14 +344,18 @@ void IQFrontEnd::updateFFTPath(bool updateWaterfall) {
     fftInBuf = (fftwf_complex*)fftwf_malloc(_fftSize * sizeof(fftwf_complex));
     fftOutBuf = (fftwf_complex*)fftwf_malloc(_fftSize * sizeof(fftwf_complex));
     fftwPlan = fftwf_plan_dft_1d(_fftSize, fftInBuf, fftOutBuf, FFTW_FORWARD, FFTW_ESTIMATE);
+    dsp::buffer::free(fftDbOut);
+    fftDbOut = dsp::buffer::alloc<float>(_fftSize);
 
     // Clear the rest of the FFT input buffer
     dsp::buffer::clear(fftInBuf, _fftSize - _nzFFTSize, _nzFFTSize);
 
     // Update waterfall (TODO: This is annoying, it makes this module non testable and will constantly clear the waterfall for any reason)
-    if (updateWaterfall) { gui::waterfall.setRawFFTSize(_fftSize); }
+    // Skipped when there is no display, like on the server
+    if (updateWaterfall && _acquireFFTBuffer) { gui::waterfall.setRawFFTSize(_fftSize); }
 
     // Restart branch
+    lck.unlock();
     reshape.tempStart();
     fftSink.tempStart();
 }
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include "../dsp/sink/handler_sink.h"
 #include "../dsp/math/conjugate.h"
 #include <fftw3.h>
+#include <mutex>
 
 class IQFrontEnd {
 public:
@@ -37,10 +38,20 @@ public:
     dsp::channel::RxVFO* addVFO(std::string name, double sampleRate, double bandwidth, double offset);
     void removeVFO(std::string name);
 
+    // Runs the VFOs on the executor instead of their own threads, NULL to go back to threads
+    void setVFOExecutor(dsp::Executor* executor);
+
+    // Pins the input buffer and pre-processing to the given cores, applied at the next start
+    void setPreprocCores(std::vector<int> cores);
+
     void setFFTSize(int size);
     void setFFTRate(double rate);
     void setFFTWindow(FFTWindow fftWindow);
 
+    // Shows a spectrum computed elsewhere, e.g. by a remote server, as if it came from the local FFT.
+    // The bins cover the current samplerate and are resampled to the FFT size.
+    void pushExternalFFT(const float* data, int count);
+
     void flushInputBuffer();
 
     void start();
@@ -82,6 +93,7 @@ protected:
     // VFOs
     std::map<std::string, dsp::stream<dsp::complex_t>*> vfoStreams;
     std::map<std::string, dsp::channel::RxVFO*> vfos;
+    dsp::Executor* vfoExecutor = NULL;
 
     // Parameters
     double _sampleRate;
@@ -99,6 +111,7 @@ protected:
     fftwf_complex *fftInBuf, *fftOutBuf;
     fftwf_plan fftwPlan;
     float* fftDbOut;
+    std::mutex fftMtx;
 
     double effectiveSr;
 
@@ -5,4 +5,6 @@ namespace sigpath {
     VFOManager vfoManager;
     SourceManager sourceManager;
     SinkManager sinkManager;
+    SpectrumService spectrum;
+    dsp::Executor executor;
 };
\ No newline at end of file
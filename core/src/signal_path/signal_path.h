@@ -3,6 +3,8 @@
 #include "vfo_manager.h"
 #include "source.h"
 #include "sink.h"
+#include "spectrum.h"
+#include "../dsp/executor.h"
 #include <module.h>
 
 namespace sigpath {
@@ -10,4 +12,9 @@ namespace sigpath {
     SDRPP_EXPORT VFOManager vfoManager;
     SDRPP_EXPORT SourceManager sourceManager;
     SDRPP_EXPORT SinkManager sinkManager;
+    SDRPP_EXPORT SpectrumService spectrum;
+
+    // Shared pool for the DSP of the VFOs and of the modules that opt in, only running if
+    // enabled in the threading config
+    SDRPP_EXPORT dsp::Executor executor;
 };
\ No newline at end of file
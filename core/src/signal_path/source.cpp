@@ -26,7 +26,12 @@ void SourceManager::unregisterSource(std::string name) {
         if (selectedHandler != NULL) {
             sources[selectedName]->deselectHandler(sources[selectedName]->ctx);
         }
-        sigpath::iqFrontEnd.setInput(&nullSource);
+        if (core::args["server"].b()) {
+            server::setInput(&nullSource);
+        }
+        else {
+            sigpath::iqFrontEnd.setInput(&nullSource);
+        }
         selectedHandler = NULL;
     }
     sources.erase(name);
@@ -92,15 +97,19 @@ void SourceManager::tune(double freq) {
 
 void SourceManager::setTuningOffset(double offset) {
     tuneOffset = offset;
-    tune(currentFreq);
+    tune(currentFreq.load());
 }
 
 void SourceManager::setTuningMode(TuningMode mode) {
     tuneMode = mode;
-    tune(currentFreq);
+    tune(currentFreq.load());
 }
 
 void SourceManager::setPanadpterIF(double freq) {
     ifFreq = freq;
-    tune(currentFreq);
+    tune(currentFreq.load());
+}
+
+double SourceManager::getCurrentFrequency() {
+    return currentFreq;
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <atomic>
 #include <dsp/stream.h>
 #include <dsp/types.h>
 #include <utils/event.h>
@@ -36,6 +37,7 @@ public:
     void setTuningOffset(double offset);
     void setTuningMode(TuningMode mode);
     void setPanadpterIF(double freq);
+    double getCurrentFrequency();
 
     std::vector<std::string> getSourceNames();
 
@@ -49,7 +51,7 @@ private:
     std::string selectedName;
     SourceHandler* selectedHandler = NULL;
     double tuneOffset;
-    double currentFreq;
+    std::atomic<double> currentFreq = 0.0;
     double ifFreq = 0.0;
     TuningMode tuneMode = TuningMode::NORMAL;
     dsp::stream<dsp::complex_t> nullSource;
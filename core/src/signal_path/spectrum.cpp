@@ -0,0 +1,197 @@
+#include "spectrum.h"
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+
+float SpectrumFrame::maxLevel(double start, double end, bool averaged) const {
+    if (data.empty()) { return -INFINITY; }
+    const float* buf = averaged ? average.data() : data.data();
+    int startBin = frequencyBin(start);
+    int endBin = frequencyBin(end);
+    float max = -INFINITY;
+    for (int i = startBin; i <= endBin; i++) {
+        if (buf[i] > max) { max = buf[i]; }
+    }
+    return max;
+}
+
+float SpectrumFrame::meanLevel(double start, double end, bool averaged) const {
+    if (data.empty()) { return -INFINITY; }
+    const float* buf = averaged ? average.data() : data.data();
+    int startBin = frequencyBin(start);
+    int endBin = frequencyBin(end);
+    double sum = 0.0;
+    for (int i = startBin; i <= endBin; i++) { sum += buf[i]; }
+    return sum / (double)(endBin - startBin + 1);
+}
+
+float SpectrumFrame::noiseFloor(double start, double end) const {
+    if (floor.empty()) { return NAN; }
+    int startBin = frequencyBin(start);
+    int endBin = frequencyBin(end);
+    double sum = 0.0;
+    for (int i = startBin; i <= endBin; i++) { sum += floor[i]; }
+    return sum / (double)(endBin - startBin + 1);
+}
+
+float SpectrumFrame::snr(double start, double end, bool averaged) const {
+    return maxLevel(start, end, averaged) - noiseFloor(start, end);
+}
+
+SpectrumService::SpectrumService() {
+    pool = std::make_shared<FramePool>();
+    latestId = 0;
+    subscriberCount = 0;
+    floorSubscriberCount = 0;
+    handlerCount = 0;
+    avgAlpha = 0.1f;
+    detThreshold = 6.0f;
+    cfar.init(2, 16, detThreshold);
+}
+
+void SpectrumService::publish(const float* data, int size, double centerFrequency, double sampleRate) {
+    // Don't spend anything on frames nobody looks at, and start the averages over once someone does
+    if (!subscriberCount && !handlerCount) {
+        idle = true;
+        return;
+    }
+    if (idle) {
+        avgBuf.clear();
+        lastSampleRate = 0.0;
+        idle = false;
+    }
+
+    // The frame belongs to the producer until it gets published
+    SpectrumFrame* frame = pool->alloc();
+    frame->data.resize(size);
+    frame->average.resize(size);
+    memcpy(frame->data.data(), data, size * sizeof(float));
+
+    // Update the running average, restarting it if the FFT size changed
+    float alpha = avgAlpha;
+    if (avgBuf.size() != size) {
+        avgBuf.assign(data, data + size);
+    }
+    else {
+        for (int i = 0; i < size; i++) { avgBuf[i] += alpha * (data[i] - avgBuf[i]); }
+    }
+    memcpy(frame->average.data(), avgBuf.data(), size * sizeof(float));
+
+    // Track the noise floor of every bin, the detection and tracking only run if someone uses the result
+    if (floorSubscriberCount) {
+        // A retune only moves the bins, so keep the floor of the frequencies still in view
+        if (noiseFloor.size() != size || sampleRate != lastSampleRate) {
+            noiseFloor.init(size, 16);
+            signalMask.resize(size);
+            lastCenterFreq = centerFrequency;
+            lastSampleRate = sampleRate;
+        }
+        else if (centerFrequency != lastCenterFreq) {
+            double binWidth = sampleRate / (double)size;
+            int offset = std::clamp<double>(round((centerFrequency - lastCenterFreq) / binWidth), -size, size);
+            noiseFloor.shift(offset);
+            lastCenterFreq += offset * binWidth;
+        }
+        cfar.setThreshold(detThreshold);
+        cfar.process(avgBuf.data(), size, signalMask.data());
+        noiseFloor.update(data, signalMask.data());
+        frame->floor.resize(size);
+        memcpy(frame->floor.data(), noiseFloor.data(), size * sizeof(float));
+    }
+    else {
+        // Start over once someone needs it again
+        frame->floor.clear();
+        lastSampleRate = 0.0;
+    }
+
+    frame->centerFrequency = centerFrequency;
+    frame->sampleRate = sampleRate;
+    frame->timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    frame->id = ++frameCounter;
+
+    // Publish the frame, it's handed back to the pool once the last reference to it is dropped
+    std::shared_ptr<FramePool> framePool = pool;
+    SpectrumFrameRef ref(frame, [framePool](const SpectrumFrame* f) { framePool->release((SpectrumFrame*)f); });
+    std::atomic_store(&history[frame->id % SPECTRUM_HISTORY_SIZE], ref);
+    latestId.store(frame->id);
+
+    // Notify subscribers
+    std::lock_guard lck(handlerMtx);
+    onFrame.emit(ref);
+}
+
+SpectrumFrameRef SpectrumService::getLatest() {
+    uint64_t id = latestId.load();
+    if (!id) { return NULL; }
+    return getFrame(id);
+}
+
+SpectrumFrameRef SpectrumService::getFrame(uint64_t id) {
+    SpectrumFrameRef frame = std::atomic_load(&history[id % SPECTRUM_HISTORY_SIZE]);
+    if (!frame || frame->id != id) { return NULL; }
+    return frame;
+}
+
+uint64_t SpectrumService::getLatestId() {
+    return latestId.load();
+}
+
+void SpectrumService::setAveraging(float alpha) {
+    avgAlpha = std::clamp<float>(alpha, 0.0f, 1.0f);
+}
+
+float SpectrumService::getAveraging() {
+    return avgAlpha;
+}
+
+void SpectrumService::setDetectionThreshold(float threshold) {
+    detThreshold = threshold;
+}
+
+float SpectrumService::getDetectionThreshold() {
+    return detThreshold;
+}
+
+void SpectrumService::bindHandler(EventHandler<SpectrumFrameRef>* handler) {
+    std::lock_guard lck(handlerMtx);
+    onFrame.bindHandler(handler);
+    handlerCount++;
+}
+
+void SpectrumService::unbindHandler(EventHandler<SpectrumFrameRef>* handler) {
+    std::lock_guard lck(handlerMtx);
+    onFrame.unbindHandler(handler);
+    handlerCount--;
+}
+
+void SpectrumService::subscribe(bool noiseFloor) {
+    subscriberCount++;
+    if (noiseFloor) { floorSubscriberCount++; }
+}
+
+void SpectrumService::unsubscribe(bool noiseFloor) {
+    subscriberCount--;
+    if (noiseFloor) { floorSubscriberCount--; }
+}
+
+SpectrumService::FramePool::~FramePool() {
+    for (auto& frame : frames) { delete frame; }
+}
+
+SpectrumFrame* SpectrumService::FramePool::alloc() {
+    std::lock_guard lck(mtx);
+    if (frames.empty()) { return new SpectrumFrame; }
+    SpectrumFrame* frame = frames.back();
+    frames.pop_back();
+    return frame;
+}
+
+void SpectrumService::FramePool::release(SpectrumFrame* frame) {
+    std::lock_guard lck(mtx);
+    if (frames.size() >= SPECTRUM_POOL_SIZE) {
+        delete frame;
+        return;
+    }
+    frames.push_back(frame);
+}
\ No newline at end of file
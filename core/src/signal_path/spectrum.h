@@ -0,0 +1,127 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <stdint.h>
+#include <math.h>
+#include <algorithm>
+#include <utils/event.h>
+#include <dsp/detector/noise_floor.h>
+#include <dsp/detector/cfar.h>
+
+// Number of past frames kept for subscribers that want every frame
+#define SPECTRUM_HISTORY_SIZE   8
+
+// Maximum number of released frames kept around for reuse
+#define SPECTRUM_POOL_SIZE      (4 * SPECTRUM_HISTORY_SIZE)
+
+struct SpectrumFrame {
+    std::vector<float> data;    // Power in dB, DC bin in the middle
+    std::vector<float> average; // Exponential average of the power in dB
+    std::vector<float> floor;   // Noise floor estimate in dB, empty if nobody asked for it
+    double centerFrequency = 0.0;
+    double sampleRate = 0.0;
+    uint64_t timestamp = 0;     // Nanoseconds since the unix epoch
+    uint64_t id = 0;
+
+    inline int size() const { return data.size(); }
+    inline double binWidth() const { return sampleRate / (double)data.size(); }
+    inline double startFrequency() const { return centerFrequency - (sampleRate / 2.0); }
+    inline double endFrequency() const { return centerFrequency + (sampleRate / 2.0); }
+
+    inline double binFrequency(int bin) const {
+        return centerFrequency + (((double)bin - (double)(data.size() / 2)) * binWidth());
+    }
+
+    inline int frequencyBin(double freq) const {
+        int bin = (int)round((freq - centerFrequency) / binWidth()) + (data.size() / 2);
+        return std::clamp<int>(bin, 0, data.size() - 1);
+    }
+
+    // Highest level in [start, end]
+    float maxLevel(double start, double end, bool averaged = false) const;
+
+    // Mean level in [start, end]
+    float meanLevel(double start, double end, bool averaged = false) const;
+
+    // Mean noise floor in [start, end]
+    float noiseFloor(double start, double end) const;
+
+    // Highest level in [start, end] relative to the noise floor there
+    float snr(double start, double end, bool averaged = false) const;
+};
+
+typedef std::shared_ptr<const SpectrumFrame> SpectrumFrameRef;
+
+// Publishes full resolution spectrum frames independently from the display. Frames are
+// immutable once published so subscribers can keep a reference for as long as they like
+// without copying and without ever holding up the producer. Nothing is computed while
+// there are neither handlers nor subscribers.
+class SpectrumService {
+public:
+    SpectrumService();
+
+    // Producer side, only one thread may publish
+    void publish(const float* data, int size, double centerFrequency, double sampleRate);
+
+    // Newest frame or null if none was published yet
+    SpectrumFrameRef getLatest();
+
+    // Frame with the given id or null if it was already dropped from the history
+    SpectrumFrameRef getFrame(uint64_t id);
+
+    uint64_t getLatestId();
+
+    // Averaging factor between 0 (frozen) and 1 (no averaging)
+    void setAveraging(float alpha);
+    float getAveraging();
+
+    // Threshold in dB above which the CFAR detector considers a bin as signal, those bins
+    // are excluded from the noise floor tracking
+    void setDetectionThreshold(float threshold);
+    float getDetectionThreshold();
+
+    // Handlers are called from the DSP thread and must return quickly
+    void bindHandler(EventHandler<SpectrumFrameRef>* handler);
+    void unbindHandler(EventHandler<SpectrumFrameRef>* handler);
+
+    // Consumers polling with getLatest() or getFrame() must be subscribed for frames to be published.
+    // The noise floor is only tracked while at least one subscriber asked for it.
+    void subscribe(bool noiseFloor = false);
+    void unsubscribe(bool noiseFloor = false);
+
+private:
+    // Frames only go back to the pool once the last reference to them was released
+    struct FramePool {
+        ~FramePool();
+        SpectrumFrame* alloc();
+        void release(SpectrumFrame* frame);
+
+        std::mutex mtx;
+        std::vector<SpectrumFrame*> frames;
+    };
+
+    std::shared_ptr<FramePool> pool;
+    std::shared_ptr<const SpectrumFrame> history[SPECTRUM_HISTORY_SIZE];
+    std::atomic<uint64_t> latestId;
+    uint64_t frameCounter = 0;
+
+    std::vector<float> avgBuf;
+    std::atomic<float> avgAlpha;
+
+    dsp::detector::NoiseFloor noiseFloor;
+    dsp::detector::CFAR cfar;
+    std::vector<uint8_t> signalMask;
+    std::atomic<float> detThreshold;
+    double lastCenterFreq = 0.0;
+    double lastSampleRate = 0.0;
+
+    std::atomic<int> subscriberCount;
+    std::atomic<int> floorSubscriberCount;
+    std::atomic<int> handlerCount;
+    bool idle = true;
+
+    std::mutex handlerMtx;
+    Event<SpectrumFrameRef> onFrame;
+};
@@ -0,0 +1,118 @@
+#include "mapped_file.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(std::string path, bool create) {
+    if (_open) { close(); }
+
+#ifdef _WIN32
+    file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, create ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) { return false; }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        file = INVALID_HANDLE_VALUE;
+        return false;
+    }
+    _size = fileSize.QuadPart;
+#else
+    fd = ::open(path.c_str(), O_RDWR | (create ? O_CREAT : 0), 0644);
+    if (fd < 0) { return false; }
+    struct stat st;
+    if (fstat(fd, &st)) {
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    _size = st.st_size;
+#endif
+
+    _open = true;
+    if (!map()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+    if (!_open) { return; }
+    unmap();
+#ifdef _WIN32
+    CloseHandle(file);
+    file = INVALID_HANDLE_VALUE;
+#else
+    ::close(fd);
+    fd = -1;
+#endif
+    _size = 0;
+    _open = false;
+}
+
+bool MappedFile::resize(size_t size) {
+    if (!_open) { return false; }
+    unmap();
+
+#ifdef _WIN32
+    LARGE_INTEGER newSize;
+    newSize.QuadPart = size;
+    bool ok = SetFilePointerEx(file, newSize, NULL, FILE_BEGIN) && SetEndOfFile(file);
+#else
+    bool ok = !ftruncate(fd, size);
+#endif
+    if (ok) { _size = size; }
+
+    // Map again even on failure so that the existing data stays accessible
+    return map() && ok;
+}
+
+void MappedFile::flush() {
+    if (!_data) { return; }
+#ifdef _WIN32
+    FlushViewOfFile(_data, 0);
+#else
+    msync(_data, _size, MS_ASYNC);
+#endif
+}
+
+bool MappedFile::map() {
+    // Empty files can't be mapped, this isn't an error
+    if (!_size) { return true; }
+
+#ifdef _WIN32
+    mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, 0, 0, NULL);
+    if (!mapping) { return false; }
+    _data = (uint8_t*)MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    if (!_data) {
+        CloseHandle(mapping);
+        mapping = NULL;
+        return false;
+    }
+#else
+    void* ptr = mmap(NULL, _size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED) { return false; }
+    _data = (uint8_t*)ptr;
+#endif
+    return true;
+}
+
+void MappedFile::unmap() {
+    if (!_data) { return; }
+#ifdef _WIN32
+    UnmapViewOfFile(_data);
+    CloseHandle(mapping);
+    mapping = NULL;
+#else
+    munmap(_data, _size);
+#endif
+    _data = NULL;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <string>
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+// File mapped into memory for reading and writing. The mapping covers the whole file
+// and is recreated when the file is resized, invalidating any pointer to the data.
+class MappedFile {
+public:
+    MappedFile() {}
+    ~MappedFile();
+
+    // Opens or creates the file, returns false on error
+    bool open(std::string path, bool create = true);
+    void close();
+
+    // Changes the size of the file and remaps it
+    bool resize(size_t size);
+
+    // Writes dirty pages back to disk
+    void flush();
+
+    inline bool isOpen() { return _open; }
+    inline uint8_t* data() { return _data; }
+    inline size_t size() { return _size; }
+
+private:
+    bool map();
+    void unmap();
+
+    bool _open = false;
+    uint8_t* _data = NULL;
+    size_t _size = 0;
+
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+#else
+    int fd = -1;
+#endif
+};
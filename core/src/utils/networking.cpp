@@ -1,5 +1,8 @@
 #include <utils/networking.h>
 #include <assert.h>
+#include <limits.h>
+#include <errno.h>
+#include <algorithm>
 #include <spdlog/spdlog.h>
 
 namespace net {
@@ -8,6 +11,16 @@ namespace net {
     extern bool winsock_init = false;
 #endif
 
+    // Send errors after which a datagram socket is still usable, only the datagram is lost
+    static bool isTransientSendError() {
+#ifdef _WIN32
+        int err = WSAGetLastError();
+        return (err == WSAENOBUFS || err == WSAEWOULDBLOCK || err == WSAEINTR);
+#else
+        return (errno == ENOBUFS || errno == ENOMEM || errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+#endif
+    }
+
     ConnClass::ConnClass(Socket sock, struct sockaddr_in raddr, bool udp) {
         _sock = sock;
         _udp = udp;
@@ -33,6 +46,7 @@ namespace net {
         // Notify the workers of the change
         readQueueCnd.notify_all();
         writeQueueCnd.notify_all();
+        writeQueueSpaceCnd.notify_all();
 
         if (connectionOpen) {
 #ifdef _WIN32
@@ -43,10 +57,23 @@ namespace net {
 #endif
         }
 
-        // Wait for the theads to terminate
-        if (readWorkerThread.joinable()) { readWorkerThread.join(); }
+        // Wait for the theads to terminate. A read handler can close the connection from the read
+        // worker itself, that one exits once the handler returns and is joined by the next close
+        if (readWorkerThread.joinable() && readWorkerThread.get_id() != std::this_thread::get_id()) { readWorkerThread.join(); }
         if (writeWorkerThread.joinable()) { writeWorkerThread.join(); }
 
+        // Free any data that was never sent
+        {
+            std::lock_guard lck(writeQueueMtx);
+            for (auto& entry : writeQueue) { releaseWriteEntry(entry); }
+            writeQueue.clear();
+        }
+        {
+            std::lock_guard lck(bufferPoolMtx);
+            for (auto& pb : bufferPool) { delete[] pb.buf; }
+            bufferPool.clear();
+        }
+
         {
             std::lock_guard lck(connectionOpenMtx);
             connectionOpen = false;
@@ -72,26 +99,31 @@ namespace net {
             socklen_t fromLen = sizeof(remoteAddr);
             ret = recvfrom(_sock, (char*)buf, count, 0, (struct sockaddr*)&remoteAddr, &fromLen);
             if (ret <= 0) {
-                {
-                    std::lock_guard lck(connectionOpenMtx);
-                    connectionOpen = false;
-                }
-                connectionOpenCnd.notify_all();
+                setClosed();
                 return -1;
             }
-            return count;
+            return ret;
         }
 
+        // Serve what's left in the lookahead buffer first
         int beenRead = 0;
+        if (rxBufPos < rxBufLen) {
+            beenRead = std::min<int>(count, rxBufLen - rxBufPos);
+            memcpy(buf, &rxBuf[rxBufPos], beenRead);
+            rxBufPos += beenRead;
+            if (!enforceSize || beenRead == count) { return beenRead; }
+        }
+
         while (beenRead < count) {
-            ret = recv(_sock, (char*)&buf[beenRead], count - beenRead, 0);
+            if (rxBuf.empty()) {
+                ret = recv(_sock, (char*)&buf[beenRead], count - beenRead, 0);
+            }
+            else {
+                ret = recvLookahead(count - beenRead, &buf[beenRead]);
+            }
 
             if (ret <= 0) {
-                {
-                    std::lock_guard lck(connectionOpenMtx);
-                    connectionOpen = false;
-                }
-                connectionOpenCnd.notify_all();
+                setClosed();
                 return -1;
             }
 
@@ -110,25 +142,15 @@ namespace net {
 
         if (_udp) {
             ret = sendto(_sock, (char*)buf, count, 0, (struct sockaddr*)&remoteAddr, sizeof(remoteAddr));
-            if (ret <= 0) {
-                {
-                    std::lock_guard lck(connectionOpenMtx);
-                    connectionOpen = false;
-                }
-                connectionOpenCnd.notify_all();
-            }
+            if (ret < 0 && !isTransientSendError()) { setClosed(); }
             return (ret > 0);
         }
 
         int beenWritten = 0;
         while (beenWritten < count) {
-            ret = send(_sock, (char*)buf, count, 0);
+            ret = send(_sock, (char*)&buf[beenWritten], count - beenWritten, 0);
             if (ret <= 0) {
-                {
-                    std::lock_guard lck(connectionOpenMtx);
-                    connectionOpen = false;
-                }
-                connectionOpenCnd.notify_all();
+                setClosed();
                 return false;
             }
             beenWritten += ret;
@@ -137,6 +159,116 @@ namespace net {
         return true;
     }
 
+    bool ConnClass::writeBatch(int entryCount, const ConnWriteEntry* entries) {
+        if (!connectionOpen) { return false; }
+        if (entryCount <= 0) { return true; }
+        std::lock_guard lck(writeMtx);
+
+#if defined(_WIN32)
+        // Each entry is one datagram in UDP mode, one WSASend is enough otherwise
+        if (_udp) {
+            for (int i = 0; i < entryCount; i++) {
+                int ret = sendto(_sock, (char*)entries[i].buf, entries[i].count, 0, (struct sockaddr*)&remoteAddr, sizeof(remoteAddr));
+                if (ret < 0) {
+                    // Drop the rest of the batch on transient errors
+                    if (!isTransientSendError()) { setClosed(); }
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Gather all entries into one WSASend, resuming after partial sends
+        std::vector<WSABUF> wbufs(entryCount);
+        for (int i = 0; i < entryCount; i++) {
+            wbufs[i].buf = (char*)entries[i].buf;
+            wbufs[i].len = entries[i].count;
+        }
+        int cur = 0;
+        while (cur < entryCount) {
+            DWORD sent = 0;
+            if (WSASend(_sock, &wbufs[cur], entryCount - cur, &sent, 0, NULL, NULL) || !sent) {
+                setClosed();
+                return false;
+            }
+
+            // Skip over everything that was fully sent
+            while (cur < entryCount && sent >= wbufs[cur].len) {
+                sent -= wbufs[cur].len;
+                cur++;
+            }
+            if (cur < entryCount) {
+                wbufs[cur].buf += sent;
+                wbufs[cur].len -= sent;
+            }
+        }
+        return true;
+#else
+        if (_udp) {
+#if defined(__linux__)
+            // Send all datagrams with as few syscalls as possible
+            std::vector<struct mmsghdr> msgs(entryCount);
+            std::vector<struct iovec> iovs(entryCount);
+            for (int i = 0; i < entryCount; i++) {
+                iovs[i].iov_base = entries[i].buf;
+                iovs[i].iov_len = entries[i].count;
+                memset(&msgs[i], 0, sizeof(struct mmsghdr));
+                msgs[i].msg_hdr.msg_name = &remoteAddr;
+                msgs[i].msg_hdr.msg_namelen = sizeof(remoteAddr);
+                msgs[i].msg_hdr.msg_iov = &iovs[i];
+                msgs[i].msg_hdr.msg_iovlen = 1;
+            }
+            int beenSent = 0;
+            while (beenSent < entryCount) {
+                int ret = sendmmsg(_sock, &msgs[beenSent], entryCount - beenSent, 0);
+                if (ret <= 0) {
+                    // Drop the rest of the batch on transient errors
+                    if (ret < 0 && !isTransientSendError()) { setClosed(); }
+                    return false;
+                }
+                beenSent += ret;
+            }
+#else
+            for (int i = 0; i < entryCount; i++) {
+                int ret = sendto(_sock, (char*)entries[i].buf, entries[i].count, 0, (struct sockaddr*)&remoteAddr, sizeof(remoteAddr));
+                if (ret < 0) {
+                    // Drop the rest of the batch on transient errors
+                    if (!isTransientSendError()) { setClosed(); }
+                    return false;
+                }
+            }
+#endif
+            return true;
+        }
+
+        // Gather all entries into one vectored write, resuming after partial writes
+        std::vector<struct iovec> iovs(entryCount);
+        for (int i = 0; i < entryCount; i++) {
+            iovs[i].iov_base = entries[i].buf;
+            iovs[i].iov_len = entries[i].count;
+        }
+        int cur = 0;
+        while (cur < entryCount) {
+            ssize_t ret = ::writev(_sock, &iovs[cur], std::min<int>(entryCount - cur, IOV_MAX));
+            if (ret <= 0) {
+                setClosed();
+                return false;
+            }
+
+            // Skip over everything that was fully written
+            while (cur < entryCount && ret >= (ssize_t)iovs[cur].iov_len) {
+                ret -= iovs[cur].iov_len;
+                cur++;
+            }
+            if (cur < entryCount) {
+                iovs[cur].iov_base = (uint8_t*)iovs[cur].iov_base + ret;
+                iovs[cur].iov_len -= ret;
+            }
+        }
+        return true;
+#endif
+    }
+
     void ConnClass::readAsync(int count, uint8_t* buf, void (*handler)(int count, uint8_t* buf, void* ctx), void* ctx, bool enforceSize) {
         if (!connectionOpen) { return; }
         // Create entry
@@ -157,21 +289,215 @@ namespace net {
         readQueueCnd.notify_all();
     }
 
-    void ConnClass::writeAsync(int count, uint8_t* buf) {
-        if (!connectionOpen) { return; }
+    bool ConnClass::writeAsync(int count, uint8_t* buf, bool copy, bool droppable) {
+        if (!connectionOpen) { return false; }
         // Create entry
         ConnWriteEntry entry;
         entry.count = count;
         entry.buf = buf;
+        entry.owned = false;
+        entry.droppable = droppable;
+        entry.capacity = 0;
+
+        // Copy into a recycled buffer without holding up the writer
+        if (copy) {
+            entry.buf = acquireWriteBuffer(count, entry.capacity);
+            entry.owned = true;
+            memcpy(entry.buf, buf, count);
+        }
 
-        // Add entry to queue
+        // Add entry to queue, applying the drop policy if it is full. Entries that can't be dropped
+        // take the place of the oldest one that can, or wait for room if there isn't any
         {
-            std::lock_guard lck(writeQueueMtx);
+            std::unique_lock lck(writeQueueMtx);
+            bool full = (maxWriteQueue > 0 && (int)writeQueue.size() >= maxWriteQueue);
+            bool dropNew = (full && droppable && dropPolicy == WRITE_DROP_POLICY_NEWEST);
+            if (full && !dropNew && dropPolicy != WRITE_DROP_POLICY_BLOCK) {
+                auto it = std::find_if(writeQueue.begin(), writeQueue.end(), [](const ConnWriteEntry& e) { return e.droppable; });
+                if (it != writeQueue.end()) {
+                    releaseWriteEntry(*it);
+                    writeQueue.erase(it);
+                    droppedWrites++;
+                    full = false;
+                }
+                else {
+                    dropNew = droppable;
+                }
+            }
+            if (dropNew) {
+                droppedWrites++;
+                lck.unlock();
+                releaseWriteEntry(entry);
+                return false;
+            }
+            if (full) {
+                writeQueueSpaceCnd.wait(lck, [this]() { return ((int)writeQueue.size() < maxWriteQueue || stopWorkers); });
+                if (stopWorkers) {
+                    lck.unlock();
+                    releaseWriteEntry(entry);
+                    return false;
+                }
+            }
             writeQueue.push_back(entry);
         }
 
         // Notify write worker
         writeQueueCnd.notify_all();
+        return true;
+    }
+
+    void ConnClass::setWriteQueue(int maxEntries, WriteDropPolicy policy) {
+        {
+            std::lock_guard lck(writeQueueMtx);
+            maxWriteQueue = maxEntries;
+            dropPolicy = policy;
+
+            // Keep about as many buffers as can be queued, or a few if the queue is unbounded
+            std::lock_guard lck2(bufferPoolMtx);
+            maxPooledBuffers = std::max<int>(maxEntries, 4) + 2;
+        }
+        writeQueueSpaceCnd.notify_all();
+    }
+
+    int ConnClass::getDroppedWrites() {
+        std::lock_guard lck(writeQueueMtx);
+        return droppedWrites;
+    }
+
+    int ConnClass::getWriteQueueSize() {
+        std::lock_guard lck(writeQueueMtx);
+        return writeQueue.size();
+    }
+
+    void ConnClass::setReadBuffer(int size) {
+        std::lock_guard lck(readMtx);
+        if (rxBufPos < rxBufLen) {
+            spdlog::warn("Resizing the read buffer of a connection with pending data");
+        }
+        rxBuf.resize(size);
+        rxBufPos = 0;
+        rxBufLen = 0;
+    }
+
+    bool ConnClass::setSendBufferSize(int size) {
+        return !setsockopt(_sock, SOL_SOCKET, SO_SNDBUF, (char*)&size, sizeof(int));
+    }
+
+    bool ConnClass::setRecvBufferSize(int size) {
+        return !setsockopt(_sock, SOL_SOCKET, SO_RCVBUF, (char*)&size, sizeof(int));
+    }
+
+    bool ConnClass::setNoDelay(bool enabled) {
+        if (_udp) { return false; }
+        int val = enabled;
+        return !setsockopt(_sock, IPPROTO_TCP, TCP_NODELAY, (char*)&val, sizeof(int));
+    }
+
+    bool ConnClass::setCork(bool enabled) {
+        if (_udp) { return false; }
+        int val = enabled;
+#if defined(TCP_CORK)
+        return !setsockopt(_sock, IPPROTO_TCP, TCP_CORK, (char*)&val, sizeof(int));
+#elif defined(TCP_NOPUSH)
+        return !setsockopt(_sock, IPPROTO_TCP, TCP_NOPUSH, (char*)&val, sizeof(int));
+#else
+        return false;
+#endif
+    }
+
+    bool ConnClass::joinMulticastGroup(std::string group) {
+        if (!_udp) { return false; }
+        struct ip_mreq mreq;
+        if (inet_pton(AF_INET, group.c_str(), &mreq.imr_multiaddr) != 1) { return false; }
+        mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+        return !setsockopt(_sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, (char*)&mreq, sizeof(mreq));
+    }
+
+    bool ConnClass::setMulticastTTL(int ttl) {
+        if (!_udp) { return false; }
+#ifdef _WIN32
+        DWORD val = ttl;
+#else
+        uint8_t val = ttl;
+#endif
+        return !setsockopt(_sock, IPPROTO_IP, IP_MULTICAST_TTL, (char*)&val, sizeof(val));
+    }
+
+    bool ConnClass::setMulticastLoopback(bool enabled) {
+        if (!_udp) { return false; }
+#ifdef _WIN32
+        DWORD val = enabled;
+#else
+        uint8_t val = enabled;
+#endif
+        return !setsockopt(_sock, IPPROTO_IP, IP_MULTICAST_LOOP, (char*)&val, sizeof(val));
+    }
+
+    int ConnClass::recvLookahead(int count, uint8_t* buf) {
+        // Read the requested data and whatever follows it in a single syscall.
+        // Must only be called with the lookahead buffer empty and readMtx held.
+        int ret;
+#ifdef _WIN32
+        WSABUF wbufs[2];
+        wbufs[0].buf = (char*)buf;
+        wbufs[0].len = count;
+        wbufs[1].buf = (char*)rxBuf.data();
+        wbufs[1].len = rxBuf.size();
+        DWORD recvd = 0;
+        DWORD flags = 0;
+        ret = WSARecv(_sock, wbufs, 2, &recvd, &flags, NULL, NULL) ? -1 : recvd;
+#else
+        struct iovec iovs[2];
+        iovs[0].iov_base = buf;
+        iovs[0].iov_len = count;
+        iovs[1].iov_base = rxBuf.data();
+        iovs[1].iov_len = rxBuf.size();
+        ret = ::readv(_sock, iovs, 2);
+#endif
+        if (ret <= count) {
+            rxBufPos = 0;
+            rxBufLen = 0;
+            return ret;
+        }
+        rxBufPos = 0;
+        rxBufLen = ret - count;
+        return count;
+    }
+
+    uint8_t* ConnClass::acquireWriteBuffer(int count, int& capacity) {
+        {
+            std::lock_guard lck(bufferPoolMtx);
+            for (int i = bufferPool.size() - 1; i >= 0; i--) {
+                if (bufferPool[i].capacity < count) { continue; }
+                uint8_t* buf = bufferPool[i].buf;
+                capacity = bufferPool[i].capacity;
+                bufferPool.erase(bufferPool.begin() + i);
+                return buf;
+            }
+        }
+        capacity = count;
+        return new uint8_t[count];
+    }
+
+    void ConnClass::releaseWriteEntry(ConnWriteEntry& entry) {
+        if (entry.owned) {
+            std::lock_guard lck(bufferPoolMtx);
+            if ((int)bufferPool.size() < maxPooledBuffers) {
+                bufferPool.push_back({ entry.buf, entry.capacity });
+            }
+            else {
+                delete[] entry.buf;
+            }
+        }
+        entry.buf = NULL;
+    }
+
+    void ConnClass::setClosed() {
+        {
+            std::lock_guard lck(connectionOpenMtx);
+            connectionOpen = false;
+        }
+        connectionOpenCnd.notify_all();
     }
 
     void ConnClass::readWorker() {
@@ -189,11 +515,7 @@ namespace net {
             // Read from socket and send data to the handler
             int ret = read(entry.count, entry.buf, entry.enforceSize);
             if (ret <= 0) {
-                {
-                    std::lock_guard lck(connectionOpenMtx);
-                    connectionOpen = false;
-                }
-                connectionOpenCnd.notify_all();
+                setClosed();
                 return;
             }
             entry.handler(ret, entry.buf, entry.ctx);
@@ -201,24 +523,24 @@ namespace net {
     }
 
     void ConnClass::writeWorker() {
+        std::vector<ConnWriteEntry> batch;
         while (true) {
             // Wait for wakeup and exit if it's for terminating the thread
             std::unique_lock lck(writeQueueMtx);
             writeQueueCnd.wait(lck, [this]() { return (writeQueue.size() > 0 || stopWorkers); });
             if (stopWorkers || !connectionOpen) { return; }
 
-            // Pop first element off the list
-            ConnWriteEntry entry = writeQueue[0];
-            writeQueue.erase(writeQueue.begin());
+            // Take everything that's queued so it can go out in a single vectored write
+            batch.swap(writeQueue);
             lck.unlock();
+            writeQueueSpaceCnd.notify_all();
 
             // Write to socket
-            if (!write(entry.count, entry.buf)) {
-                {
-                    std::lock_guard lck(connectionOpenMtx);
-                    connectionOpen = false;
-                }
-                connectionOpenCnd.notify_all();
+            bool ok = writeBatch(batch.size(), batch.data());
+            for (auto& entry : batch) { releaseWriteEntry(entry); }
+            batch.clear();
+            if (!ok) {
+                setClosed();
                 return;
             }
         }
@@ -441,7 +763,7 @@ namespace net {
         return Listener(new ListenerClass(listenSock));
     }
 
-    Conn openUDP(std::string host, uint16_t port, std::string remoteHost, uint16_t remotePort, bool bindSocket) {
+    Conn openUDP(std::string host, uint16_t port, std::string remoteHost, uint16_t remotePort, bool bindSocket, bool reuseAddress) {
         Socket sock;
 
 #ifdef _WIN32
@@ -493,6 +815,15 @@ namespace net {
         raddr.sin_family = AF_INET;
         raddr.sin_port = htons(remotePort);
 
+        // Allow several processes to bind the same port, needed to share a multicast group
+        if (reuseAddress) {
+            int enable = 1;
+            setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, (char*)&enable, sizeof(int));
+#ifdef SO_REUSEPORT
+            setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, (char*)&enable, sizeof(int));
+#endif
+        }
+
         // Bind socket
         if (bindSocket) {
             int err = bind(sock, (struct sockaddr*)&addr, sizeof(addr));
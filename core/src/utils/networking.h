@@ -16,7 +16,10 @@
 #include <strings.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
 #include <netdb.h>
 #include <signal.h>
 #endif
@@ -39,6 +42,15 @@ namespace net {
     struct ConnWriteEntry {
         int count;
         uint8_t* buf;
+        bool owned;
+        bool droppable;
+        int capacity;
+    };
+
+    enum WriteDropPolicy {
+        WRITE_DROP_POLICY_BLOCK,
+        WRITE_DROP_POLICY_NEWEST,
+        WRITE_DROP_POLICY_OLDEST
     };
 
     class ConnClass {
@@ -52,12 +64,31 @@ namespace net {
 
         int read(int count, uint8_t* buf, bool enforceSize = true);
         bool write(int count, uint8_t* buf);
+        bool writeBatch(int entryCount, const ConnWriteEntry* entries);
         void readAsync(int count, uint8_t* buf, void (*handler)(int count, uint8_t* buf, void* ctx), void* ctx, bool enforceSize = true);
-        void writeAsync(int count, uint8_t* buf);
+        bool writeAsync(int count, uint8_t* buf, bool copy = false, bool droppable = true);
+
+        void setWriteQueue(int maxEntries, WriteDropPolicy policy);
+        int getDroppedWrites();
+        int getWriteQueueSize();
+        void setReadBuffer(int size);
+
+        bool setSendBufferSize(int size);
+        bool setRecvBufferSize(int size);
+        bool setNoDelay(bool enabled);
+        bool setCork(bool enabled);
+
+        bool joinMulticastGroup(std::string group);
+        bool setMulticastTTL(int ttl);
+        bool setMulticastLoopback(bool enabled);
 
     private:
         void readWorker();
         void writeWorker();
+        int recvLookahead(int count, uint8_t* buf);
+        uint8_t* acquireWriteBuffer(int count, int& capacity);
+        void releaseWriteEntry(ConnWriteEntry& entry);
+        void setClosed();
 
         bool stopWorkers = false;
         bool connectionOpen = false;
@@ -70,12 +101,32 @@ namespace net {
         std::mutex closeMtx;
         std::condition_variable readQueueCnd;
         std::condition_variable writeQueueCnd;
+        std::condition_variable writeQueueSpaceCnd;
         std::condition_variable connectionOpenCnd;
         std::vector<ConnReadEntry> readQueue;
         std::vector<ConnWriteEntry> writeQueue;
         std::thread readWorkerThread;
         std::thread writeWorkerThread;
 
+        // Write queue limits (0 means unbounded)
+        int maxWriteQueue = 0;
+        WriteDropPolicy dropPolicy = WRITE_DROP_POLICY_BLOCK;
+        int droppedWrites = 0;
+
+        // Buffers for copied writes, recycled so the writer doesn't allocate for every write
+        struct PooledBuffer {
+            uint8_t* buf;
+            int capacity;
+        };
+        std::mutex bufferPoolMtx;
+        std::vector<PooledBuffer> bufferPool;
+        int maxPooledBuffers = 6;
+
+        // Lookahead buffer filled by the same syscall as the requested data
+        std::vector<uint8_t> rxBuf;
+        int rxBufPos = 0;
+        int rxBufLen = 0;
+
         Socket _sock;
         bool _udp;
         struct sockaddr_in remoteAddr;
@@ -118,7 +169,7 @@ namespace net {
 
     Conn connect(std::string host, uint16_t port);
     Listener listen(std::string host, uint16_t port);
-    Conn openUDP(std::string host, uint16_t port, std::string remoteHost, uint16_t remotePort, bool bindSocket = true);
+    Conn openUDP(std::string host, uint16_t port, std::string remoteHost, uint16_t remotePort, bool bindSocket = true, bool reuseAddress = false);
 
 #ifdef _WIN32
     extern bool winsock_init;
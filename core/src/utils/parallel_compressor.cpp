@@ -0,0 +1,110 @@
+#include <utils/parallel_compressor.h>
+#include <string.h>
+#include <algorithm>
+
+ParallelCompressor::~ParallelCompressor() {
+    if (!_init) { return; }
+    {
+        std::lock_guard lck(jobMtx);
+        stopWorkers = true;
+    }
+    jobCnd.notify_all();
+    for (auto& w : workers) {
+        if (w.joinable()) { w.join(); }
+    }
+    for (auto& job : jobs) {
+        ZSTD_freeCCtx(job.cctx);
+    }
+}
+
+void ParallelCompressor::init(int workerCount, int minChunkSize) {
+    _minChunkSize = minChunkSize;
+
+    // The calling thread always compresses the first chunk itself
+    jobs.resize(std::max<int>(workerCount, 1));
+    for (auto& job : jobs) {
+        job.cctx = ZSTD_createCCtx();
+    }
+    for (int i = 1; i < jobs.size(); i++) {
+        workers.push_back(std::thread(&ParallelCompressor::worker, this, i));
+    }
+
+    _init = true;
+}
+
+int ParallelCompressor::compress(uint8_t* out, int outSize, const uint8_t* in, int count, int level) {
+    // Split into as many chunks as is worth it
+    int chunkCount = std::clamp<int>(count / _minChunkSize, 1, jobs.size());
+    int chunkSize = count / chunkCount;
+
+    // Small buffers aren't worth waking up the workers
+    if (chunkCount == 1) {
+        size_t ret = ZSTD_compressCCtx(jobs[0].cctx, out, outSize, in, count, level);
+        return ZSTD_isError(ret) ? -1 : (int)ret;
+    }
+
+    // Prepare the jobs, the last one takes the remainder
+    for (int i = 0; i < chunkCount; i++) {
+        Job& job = jobs[i];
+        job.in = &in[i * chunkSize];
+        job.count = (i == chunkCount - 1) ? (count - (i * chunkSize)) : chunkSize;
+        job.level = level;
+        size_t bound = ZSTD_compressBound(job.count);
+        if (job.out.size() < bound) { job.out.resize(bound); }
+    }
+
+    // Wake up the workers
+    {
+        std::lock_guard lck(jobMtx);
+        activeJobs = chunkCount;
+        pending = chunkCount - 1;
+        generation++;
+    }
+    jobCnd.notify_all();
+
+    // Do the first chunk on this thread and wait for the rest
+    compressChunk(jobs[0]);
+    {
+        std::unique_lock lck(jobMtx);
+        doneCnd.wait(lck, [this]() { return pending == 0; });
+    }
+
+    // Concatenate the frames
+    int outCount = 0;
+    for (int i = 0; i < chunkCount; i++) {
+        Job& job = jobs[i];
+        if (job.result < 0 || outCount + job.result > outSize) { return -1; }
+        memcpy(&out[outCount], job.out.data(), job.result);
+        outCount += job.result;
+    }
+    return outCount;
+}
+
+int ParallelCompressor::compressChunk(Job& job) {
+    size_t ret = ZSTD_compressCCtx(job.cctx, job.out.data(), job.out.size(), job.in, job.count, job.level);
+    job.result = ZSTD_isError(ret) ? -1 : (int)ret;
+    return job.result;
+}
+
+void ParallelCompressor::worker(int id) {
+    uint64_t lastGeneration = 0;
+    while (true) {
+        // Wait for a new batch of jobs
+        {
+            std::unique_lock lck(jobMtx);
+            jobCnd.wait(lck, [&]() { return generation != lastGeneration || stopWorkers; });
+            if (stopWorkers) { return; }
+            lastGeneration = generation;
+            if (id >= activeJobs) { continue; }
+        }
+
+        compressChunk(jobs[id]);
+
+        // Notify the caller if this was the last chunk
+        {
+            std::lock_guard lck(jobMtx);
+            pending--;
+        }
+        doneCnd.notify_all();
+    }
+}
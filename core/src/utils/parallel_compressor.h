@@ -0,0 +1,51 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <zstd.h>
+
+// Compresses a buffer as a sequence of independent zstd frames, one per chunk, with
+// the chunks being compressed in parallel by a pool of worker threads. The output
+// is a valid zstd stream that any decompressor accepting concatenated frames can read.
+class ParallelCompressor {
+public:
+    ParallelCompressor() {}
+    ParallelCompressor(int workerCount, int minChunkSize = 0x40000) { init(workerCount, minChunkSize); }
+    ~ParallelCompressor();
+
+    void init(int workerCount, int minChunkSize = 0x40000);
+
+    // Returns the size of the compressed data or -1 on error
+    int compress(uint8_t* out, int outSize, const uint8_t* in, int count, int level);
+
+    int getWorkerCount() { return workers.size() + 1; }
+
+private:
+    struct Job {
+        const uint8_t* in;
+        int count;
+        int level;
+        int result;
+        ZSTD_CCtx* cctx;
+        std::vector<uint8_t> out;
+    };
+
+    static int compressChunk(Job& job);
+    void worker(int id);
+
+    std::vector<Job> jobs;
+    std::vector<std::thread> workers;
+    int _minChunkSize;
+
+    std::mutex jobMtx;
+    std::condition_variable jobCnd;
+    std::condition_variable doneCnd;
+    uint64_t generation = 0;
+    int activeJobs = 0;
+    int pending = 0;
+    bool stopWorkers = false;
+
+    bool _init = false;
+};
@@ -0,0 +1,226 @@
+#include <utils/spectrum_history.h>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+namespace spectrum_history {
+    int Chunk::findLine(uint64_t timestamp) const {
+        auto it = std::lower_bound(timestamps.begin(), timestamps.end(), timestamp);
+        if (it == timestamps.end()) { return timestamps.size() - 1; }
+        if (it != timestamps.begin() && (timestamp - *(it - 1)) < (*it - timestamp)) { it--; }
+        return it - timestamps.begin();
+    }
+
+    Writer::~Writer() {
+        close();
+    }
+
+    bool Writer::open(std::string path, int bits) {
+        if (file.is_open()) { close(); }
+        file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            spdlog::error("Could not create spectrum history file '{0}'", path);
+            return false;
+        }
+
+        // 8 bit covers -150 to 0dB with ~0.6dB steps, 16 bit covers -200 to +127dB with 0.005dB steps
+        fileHeader.magic = SPECTRUM_HISTORY_MAGIC;
+        fileHeader.version = SPECTRUM_HISTORY_VERSION;
+        fileHeader.bits = (bits == 8) ? 8 : 16;
+        fileHeader.reserved = 0;
+        fileHeader.minLevel = (fileHeader.bits == 8) ? -150.0f : -200.0f;
+        fileHeader.step = (fileHeader.bits == 8) ? (150.0f / 255.0f) : 0.005f;
+        file.write((char*)&fileHeader, sizeof(FileHeader));
+
+        chunkHeader.lineCount = 0;
+        timestamps.clear();
+        lines.clear();
+        cctx = ZSTD_createCCtx();
+        return true;
+    }
+
+    void Writer::close() {
+        if (!file.is_open()) { return; }
+        flushChunk();
+        file.close();
+        ZSTD_freeCCtx(cctx);
+        cctx = NULL;
+    }
+
+    bool Writer::isOpen() {
+        return file.is_open();
+    }
+
+    void Writer::write(const float* data, int size, double centerFrequency, double sampleRate, uint64_t timestamp) {
+        if (!file.is_open()) { return; }
+
+        // Start a new chunk if the spectrum parameters changed
+        if (chunkHeader.lineCount && (chunkHeader.fftSize != size || chunkHeader.centerFrequency != centerFrequency || chunkHeader.sampleRate != sampleRate)) {
+            flushChunk();
+        }
+        if (!chunkHeader.lineCount) {
+            chunkHeader.fftSize = size;
+            chunkHeader.centerFrequency = centerFrequency;
+            chunkHeader.sampleRate = sampleRate;
+            chunkHeader.firstTimestamp = timestamp;
+        }
+        chunkHeader.lastTimestamp = timestamp;
+        chunkHeader.lineCount++;
+        timestamps.push_back(timestamp);
+
+        // Quantize the line
+        int bytes = fileHeader.bits / 8;
+        float maxVal = (fileHeader.bits == 8) ? 255.0f : 65535.0f;
+        float invStep = 1.0f / fileHeader.step;
+        size_t offset = lines.size();
+        lines.resize(offset + (size * bytes));
+        if (bytes == 1) {
+            uint8_t* out = &lines[offset];
+            for (int i = 0; i < size; i++) {
+                out[i] = std::clamp<float>(roundf((data[i] - fileHeader.minLevel) * invStep), 0.0f, maxVal);
+            }
+        }
+        else {
+            uint16_t* out = (uint16_t*)&lines[offset];
+            for (int i = 0; i < size; i++) {
+                out[i] = std::clamp<float>(roundf((data[i] - fileHeader.minLevel) * invStep), 0.0f, maxVal);
+            }
+        }
+
+        if (chunkHeader.lineCount >= SPECTRUM_HISTORY_CHUNK_LINES) { flushChunk(); }
+    }
+
+    void Writer::flushChunk() {
+        if (!chunkHeader.lineCount) { return; }
+
+        // The payload is the timestamps followed by the lines
+        size_t tsSize = timestamps.size() * sizeof(uint64_t);
+        std::vector<uint8_t> raw(tsSize + lines.size());
+        memcpy(raw.data(), timestamps.data(), tsSize);
+        memcpy(&raw[tsSize], lines.data(), lines.size());
+
+        compBuf.resize(ZSTD_compressBound(raw.size()));
+        size_t compSize = ZSTD_compressCCtx(cctx, compBuf.data(), compBuf.size(), raw.data(), raw.size(), 3);
+        if (ZSTD_isError(compSize)) {
+            spdlog::error("Could not compress spectrum history chunk: {0}", ZSTD_getErrorName(compSize));
+        }
+        else {
+            chunkHeader.magic = SPECTRUM_HISTORY_CHUNK_MAGIC;
+            chunkHeader.compressedSize = compSize;
+            file.write((char*)&chunkHeader, sizeof(ChunkHeader));
+            file.write((char*)compBuf.data(), compSize);
+            file.flush();
+        }
+
+        chunkHeader.lineCount = 0;
+        timestamps.clear();
+        lines.clear();
+    }
+
+    bool Reader::open(std::string path) {
+        if (file.is_open()) { close(); }
+        file.open(path, std::ios::in | std::ios::binary);
+        if (!file.is_open()) {
+            spdlog::error("Could not open spectrum history file '{0}'", path);
+            return false;
+        }
+
+        file.read((char*)&fileHeader, sizeof(FileHeader));
+        if (!file || fileHeader.magic != SPECTRUM_HISTORY_MAGIC || fileHeader.version != SPECTRUM_HISTORY_VERSION || (fileHeader.bits != 8 && fileHeader.bits != 16)) {
+            spdlog::error("'{0}' is not a valid spectrum history file", path);
+            file.close();
+            return false;
+        }
+
+        index.clear();
+        nextOffset = sizeof(FileHeader);
+        refresh();
+        return true;
+    }
+
+    void Reader::close() {
+        file.close();
+        index.clear();
+    }
+
+    bool Reader::isOpen() {
+        return file.is_open();
+    }
+
+    void Reader::refresh() {
+        if (!file.is_open()) { return; }
+
+        // Walk the chunk headers, stopping at the first incomplete chunk
+        file.clear();
+        file.seekg(0, std::ios::end);
+        uint64_t fileSize = file.tellg();
+        while (nextOffset + sizeof(ChunkHeader) <= fileSize) {
+            IndexEntry entry;
+            file.seekg(nextOffset);
+            file.read((char*)&entry.header, sizeof(ChunkHeader));
+            if (!file || entry.header.magic != SPECTRUM_HISTORY_CHUNK_MAGIC) { break; }
+            entry.offset = nextOffset + sizeof(ChunkHeader);
+            if (entry.offset + entry.header.compressedSize > fileSize) { break; }
+            index.push_back(entry);
+            nextOffset = entry.offset + entry.header.compressedSize;
+        }
+        file.clear();
+    }
+
+    int Reader::findChunk(uint64_t timestamp) {
+        if (index.empty()) { return -1; }
+        auto it = std::lower_bound(index.begin(), index.end(), timestamp, [](const IndexEntry& e, uint64_t ts) {
+            return e.header.lastTimestamp < ts;
+        });
+        if (it == index.end()) { return index.size() - 1; }
+        return it - index.begin();
+    }
+
+    bool Reader::readChunk(int id, Chunk& chunk) {
+        if (id < 0 || id >= index.size()) { return false; }
+        const IndexEntry& entry = index[id];
+        int bytes = fileHeader.bits / 8;
+        size_t tsSize = entry.header.lineCount * sizeof(uint64_t);
+        size_t lineCount = (size_t)entry.header.lineCount * entry.header.fftSize;
+        size_t rawSize = tsSize + (lineCount * bytes);
+
+        compBuf.resize(entry.header.compressedSize);
+        file.clear();
+        file.seekg(entry.offset);
+        file.read((char*)compBuf.data(), compBuf.size());
+        if (!file) { return false; }
+
+        rawBuf.resize(rawSize);
+        size_t ret = ZSTD_decompress(rawBuf.data(), rawBuf.size(), compBuf.data(), compBuf.size());
+        if (ZSTD_isError(ret) || ret != rawSize) {
+            spdlog::error("Corrupted spectrum history chunk {0}", id);
+            return false;
+        }
+
+        chunk.header = entry.header;
+        chunk.timestamps.resize(entry.header.lineCount);
+        memcpy(chunk.timestamps.data(), rawBuf.data(), tsSize);
+
+        // Convert back to dB
+        chunk.data.resize(lineCount);
+        float* out = chunk.data.data();
+        if (bytes == 1) {
+            const uint8_t* in = &rawBuf[tsSize];
+            for (size_t i = 0; i < lineCount; i++) { out[i] = fileHeader.minLevel + (in[i] * fileHeader.step); }
+        }
+        else {
+            const uint16_t* in = (const uint16_t*)&rawBuf[tsSize];
+            for (size_t i = 0; i < lineCount; i++) { out[i] = fileHeader.minLevel + (in[i] * fileHeader.step); }
+        }
+        return true;
+    }
+
+    uint64_t Reader::firstTimestamp() {
+        return index.empty() ? 0 : index.front().header.firstTimestamp;
+    }
+
+    uint64_t Reader::lastTimestamp() {
+        return index.empty() ? 0 : index.back().header.lastTimestamp;
+    }
+}
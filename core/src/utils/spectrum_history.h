@@ -0,0 +1,107 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+#include <stdint.h>
+#include <zstd.h>
+
+#define SPECTRUM_HISTORY_MAGIC          0x46485053  // "SPHF"
+#define SPECTRUM_HISTORY_CHUNK_MAGIC    0x43485053  // "SPHC"
+#define SPECTRUM_HISTORY_VERSION        1
+
+// Maximum number of lines per chunk, a chunk also ends when the spectrum parameters change
+#define SPECTRUM_HISTORY_CHUNK_LINES    256
+
+// Spectrum history files hold waterfall lines quantized to 8 or 16 bits, grouped in chunks that are
+// compressed independently. Each chunk header gives its time span and the spectrum parameters so that
+// a reader can index the file by only reading headers and decompress chunks on demand.
+namespace spectrum_history {
+#pragma pack(push, 1)
+    struct FileHeader {
+        uint32_t magic;
+        uint16_t version;
+        uint8_t bits;
+        uint8_t reserved;
+        float minLevel;     // Level of quantized value 0 in dB
+        float step;         // dB per quantization step
+    };
+
+    struct ChunkHeader {
+        uint32_t magic;
+        uint32_t lineCount;
+        uint32_t fftSize;
+        uint32_t compressedSize;
+        double centerFrequency;
+        double sampleRate;
+        uint64_t firstTimestamp;    // Nanoseconds since the unix epoch
+        uint64_t lastTimestamp;
+    };
+#pragma pack(pop)
+
+    struct Chunk {
+        ChunkHeader header;
+        std::vector<uint64_t> timestamps;
+        std::vector<float> data;    // lineCount lines of fftSize levels in dB
+
+        inline const float* line(int id) const { return &data[id * header.fftSize]; }
+
+        // Id of the line closest in time to the given timestamp
+        int findLine(uint64_t timestamp) const;
+    };
+
+    class Writer {
+    public:
+        ~Writer();
+
+        bool open(std::string path, int bits);
+        void close();
+        bool isOpen();
+
+        void write(const float* data, int size, double centerFrequency, double sampleRate, uint64_t timestamp);
+
+    private:
+        void flushChunk();
+
+        std::ofstream file;
+        FileHeader fileHeader;
+        ChunkHeader chunkHeader;
+        std::vector<uint64_t> timestamps;
+        std::vector<uint8_t> lines;
+        std::vector<uint8_t> compBuf;
+        ZSTD_CCtx* cctx = NULL;
+    };
+
+    class Reader {
+    public:
+        bool open(std::string path);
+        void close();
+        bool isOpen();
+
+        // Indexes chunks appended since the last call, for files still being written
+        void refresh();
+
+        inline int chunkCount() { return index.size(); }
+        inline const ChunkHeader& chunkInfo(int id) { return index[id].header; }
+
+        // Id of the chunk containing or following the timestamp, -1 if the file is empty
+        int findChunk(uint64_t timestamp);
+
+        bool readChunk(int id, Chunk& chunk);
+
+        uint64_t firstTimestamp();
+        uint64_t lastTimestamp();
+
+    private:
+        struct IndexEntry {
+            ChunkHeader header;
+            uint64_t offset;
+        };
+
+        std::ifstream file;
+        FileHeader fileHeader;
+        std::vector<IndexEntry> index;
+        uint64_t nextOffset = 0;
+        std::vector<uint8_t> compBuf;
+        std::vector<uint8_t> rawBuf;
+    };
+}
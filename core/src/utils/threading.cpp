@@ -0,0 +1,124 @@
+#include <utils/threading.h>
+#include <spdlog/spdlog.h>
+#include <thread>
+#include <set>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <fstream>
+#endif
+
+namespace threading {
+    void setName(std::string name) {
+#if defined(_WIN32)
+        std::wstring wname(name.begin(), name.end());
+        SetThreadDescription(GetCurrentThread(), wname.c_str());
+#elif defined(__APPLE__)
+        pthread_setname_np(name.c_str());
+#else
+        pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+#endif
+    }
+
+    bool setAffinity(const std::vector<int>& cores) {
+        int coreCount = std::thread::hardware_concurrency();
+#if defined(_WIN32)
+        DWORD_PTR mask = 0;
+        for (int core : cores) {
+            if (core >= 0 && core < sizeof(DWORD_PTR) * 8) { mask |= (DWORD_PTR)1 << core; }
+        }
+        if (!mask) {
+            DWORD_PTR systemMask;
+            GetProcessAffinityMask(GetCurrentProcess(), &mask, &systemMask);
+        }
+        if (!SetThreadAffinityMask(GetCurrentThread(), mask)) {
+            spdlog::warn("Could not set thread affinity");
+            return false;
+        }
+        return true;
+#elif defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int core : cores) {
+            if (core >= 0 && core < CPU_SETSIZE) { CPU_SET(core, &set); }
+        }
+        if (!CPU_COUNT(&set)) {
+            for (int i = 0; i < coreCount && i < CPU_SETSIZE; i++) { CPU_SET(i, &set); }
+        }
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set)) {
+            spdlog::warn("Could not set thread affinity");
+            return false;
+        }
+        return true;
+#else
+        // Not supported, the OS only takes affinity hints there
+        return cores.empty();
+#endif
+    }
+
+    bool setPriority(Priority priority) {
+#ifdef _WIN32
+        int prio = THREAD_PRIORITY_NORMAL;
+        if (priority == PRIORITY_HIGH) { prio = THREAD_PRIORITY_HIGHEST; }
+        else if (priority == PRIORITY_REALTIME) { prio = THREAD_PRIORITY_TIME_CRITICAL; }
+        if (!SetThreadPriority(GetCurrentThread(), prio)) {
+            spdlog::warn("Could not set thread priority");
+            return false;
+        }
+        return true;
+#else
+        sched_param param = {};
+        int policy = SCHED_OTHER;
+        if (priority == PRIORITY_HIGH) {
+            policy = SCHED_RR;
+            param.sched_priority = sched_get_priority_min(SCHED_RR);
+        }
+        else if (priority == PRIORITY_REALTIME) {
+            policy = SCHED_FIFO;
+            param.sched_priority = (sched_get_priority_min(SCHED_FIFO) + sched_get_priority_max(SCHED_FIFO)) / 2;
+        }
+        int err = pthread_setschedparam(pthread_self(), policy, &param);
+        if (err) {
+            // Usually missing privileges (CAP_SYS_NICE or rtprio limit)
+            spdlog::warn("Could not set thread priority ({0})", err);
+            return false;
+        }
+        return true;
+#endif
+    }
+
+    int physicalCoreCount() {
+        int logical = std::max<int>(std::thread::hardware_concurrency(), 1);
+#if defined(_WIN32)
+        DWORD len = 0;
+        GetLogicalProcessorInformation(NULL, &len);
+        std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(len / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+        if (info.empty() || !GetLogicalProcessorInformation(info.data(), &len)) { return logical; }
+        int count = 0;
+        for (auto& i : info) {
+            if (i.Relationship == RelationProcessorCore) { count++; }
+        }
+        return count ? count : logical;
+#elif defined(__linux__)
+        // Count unique package/core pairs
+        std::set<std::pair<int, int>> cores;
+        for (int i = 0; i < logical; i++) {
+            std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(i) + "/topology/";
+            std::ifstream pkgFile(base + "physical_package_id");
+            std::ifstream coreFile(base + "core_id");
+            int pkg, core;
+            if (!(pkgFile >> pkg) || !(coreFile >> core)) { return logical; }
+            cores.insert({ pkg, core });
+        }
+        return cores.empty() ? logical : cores.size();
+#else
+        return logical;
+#endif
+    }
+}
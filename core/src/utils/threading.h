@@ -0,0 +1,24 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// Control over the scheduling of the calling thread. Failures are logged and otherwise
+// ignored since none of these are required for correct operation.
+namespace threading {
+    enum Priority {
+        PRIORITY_NORMAL,
+        PRIORITY_HIGH,
+        PRIORITY_REALTIME
+    };
+
+    // Name shown by debuggers and system monitors, truncated to 15 characters on Linux
+    void setName(std::string name);
+
+    // Restricts the thread to the given logical cores, an empty list removes the restriction
+    bool setAffinity(const std::vector<int>& cores);
+
+    bool setPriority(Priority priority);
+
+    // Number of physical cores, falls back to the number of logical cores if it can't be determined
+    int physicalCoreCount();
+}
@@ -0,0 +1,8 @@
+#pragma once
+#include <utils/event.h>
+#include "falcon_video.h"
+
+enum {
+    FALCON9_IFACE_CMD_BIND_VIDEO_HANDLER,   // in: EventHandler<FalconVideoFrame>*
+    FALCON9_IFACE_CMD_UNBIND_VIDEO_HANDLER  // in: EventHandler<FalconVideoFrame>*
+};
@@ -0,0 +1,103 @@
+#pragma once
+#include <dsp/block.h>
+#include <inttypes.h>
+
+#define FALCON_SYNC_WORD        0x1ACFFC1D
+#define FALCON_FRAME_BITS       10232
+#define FALCON_FRAME_BYTES      (FALCON_FRAME_BITS / 8)
+
+// Number of bit errors tolerated in the sync word when looking for it and once locked
+#define FALCON_SYNC_SEARCH_ERRORS   0
+#define FALCON_SYNC_LOCKED_ERRORS   4
+
+namespace dsp {
+    // Finds frames in a bit stream and outputs them packed into bytes, sync word included
+    class FalconDeframer : public block {
+    public:
+        FalconDeframer() {}
+
+        FalconDeframer(stream<uint8_t>* in) { init(in); }
+
+        ~FalconDeframer() {
+            if (!block::_block_init) { return; }
+            block::stop();
+        }
+
+        void init(stream<uint8_t>* in) {
+            _in = in;
+            block::registerInput(_in);
+            block::registerOutput(&out);
+            block::_block_init = true;
+        }
+
+        void setInput(stream<uint8_t>* in) {
+            assert(block::_block_init);
+            std::lock_guard<std::recursive_mutex> lck(block::ctrlMtx);
+            block::tempStop();
+            block::unregisterInput(_in);
+            _in = in;
+            block::registerInput(_in);
+            block::tempStart();
+        }
+
+        int run() {
+            int count = _in->read();
+            if (count < 0) { return -1; }
+
+            for (int i = 0; i < count; i++) {
+                uint8_t bit = _in->readBuf[i] & 1;
+                shiftReg = (shiftReg << 1) | bit;
+
+                // Looking for a sync word, more leniently at the expected position if the last frame was good
+                if (bitsRead < 0) {
+                    bool expected = false;
+                    if (syncIn > 0) { expected = (--syncIn == 0); }
+                    int errors = popcount(shiftReg ^ FALCON_SYNC_WORD);
+                    if (errors > (expected ? FALCON_SYNC_LOCKED_ERRORS : FALCON_SYNC_SEARCH_ERRORS)) { continue; }
+
+                    // Write the clean sync word and start reading the frame
+                    out.writeBuf[0] = (FALCON_SYNC_WORD >> 24) & 0xFF;
+                    out.writeBuf[1] = (FALCON_SYNC_WORD >> 16) & 0xFF;
+                    out.writeBuf[2] = (FALCON_SYNC_WORD >> 8) & 0xFF;
+                    out.writeBuf[3] = FALCON_SYNC_WORD & 0xFF;
+                    bitsRead = 32;
+                    continue;
+                }
+
+                // Pack the bit
+                int byteId = bitsRead / 8;
+                if (!(bitsRead % 8)) { out.writeBuf[byteId] = 0; }
+                out.writeBuf[byteId] |= bit << (7 - (bitsRead % 8));
+                bitsRead++;
+
+                // Send the frame once complete
+                if (bitsRead >= FALCON_FRAME_BITS) {
+                    bitsRead = -1;
+                    syncIn = 32;
+                    if (!out.swap(FALCON_FRAME_BYTES)) { return -1; }
+                }
+            }
+
+            _in->flush();
+            return count;
+        }
+
+        stream<uint8_t> out;
+
+    private:
+        static inline int popcount(uint32_t x) {
+            int count = 0;
+            while (x) {
+                x &= x - 1;
+                count++;
+            }
+            return count;
+        }
+
+        stream<uint8_t>* _in;
+
+        uint32_t shiftReg = 0;
+        int bitsRead = -1;
+        int syncIn = 0; // Bits until the next sync word is fully shifted in if the last frame was good
+    };
+}
@@ -1,12 +1,22 @@
 #pragma once
 #include <dsp/block.h>
 #include <inttypes.h>
+#include <utils/threading.h>
+#include "falcon_deframer.h"
 
 // WTF???
 extern "C" {
 #include <correct.h>
 }
 
+#define FALCON_RS_BLOCKS        5
+#define FALCON_RS_BLOCK_SIZE    255
+#define FALCON_RS_DATA_SIZE     239
+#define FALCON_RS_FRAME_SIZE    (FALCON_RS_BLOCKS * FALCON_RS_BLOCK_SIZE)
+
+// Frames in flight per worker, enough to keep every worker busy while the oldest frame is sent out
+#define FALCON_RS_SLOTS_PER_WORKER  4
+
 const uint8_t toDB[] = {
     0x00, 0x7b, 0xaf, 0xd4, 0x99, 0xe2, 0x36, 0x4d, 0xfa, 0x81, 0x55, 0x2e, 0x63, 0x18, 0xcc, 0xb7, 0x86, 0xfd, 0x29, 0x52, 0x1f,
     0x64, 0xb0, 0xcb, 0x7c, 0x07, 0xd3, 0xa8, 0xe5, 0x9e, 0x4a, 0x31, 0xec, 0x97, 0x43, 0x38, 0x75, 0x0e, 0xda, 0xa1, 0x16, 0x6d, 0xb9, 0xc2, 0x8f, 0xf4,
@@ -55,86 +65,230 @@ const uint8_t randVals[] = {
 };
 
 namespace dsp {
-    class FalconRS : public generic_block<FalconRS> {
+    // Reed-Solomon decoding of the frames, done by a pool of workers since it's by far the most
+    // expensive part of the decoder. Frames are output in the order they came in.
+    class FalconRS : public block {
     public:
         FalconRS() {}
 
-        FalconRS(stream<uint8_t>* in) { init(in); }
+        FalconRS(stream<uint8_t>* in, int workerCount = 0) { init(in, workerCount); }
 
         ~FalconRS() {
-            generic_block<FalconRS>::stop();
+            if (!block::_block_init) { return; }
+            block::stop();
+            for (auto& rs : decoders) { correct_reed_solomon_destroy(rs); }
         }
 
-        void init(stream<uint8_t>* in) {
+        void init(stream<uint8_t>* in, int workerCount = 0) {
             _in = in;
 
-            for (int i = 0; i < 5; i++) { memset(buffers[i], 0, 255); }
-            for (int i = 0; i < 5; i++) { memset(outBuffers[i], 0, 255); }
-            rs = correct_reed_solomon_create(correct_rs_primitive_polynomial_ccsds, 120, 11, 16);
-            if (rs == NULL) { printf("Error creating the reed solomon decoder\n"); }
+            // Each worker needs its own decoder as they aren't thread safe
+            if (workerCount <= 0) { workerCount = std::max<int>(threading::physicalCoreCount() - 1, 1); }
+            for (int i = 0; i < workerCount; i++) {
+                correct_reed_solomon* rs = correct_reed_solomon_create(correct_rs_primitive_polynomial_ccsds, 120, 11, 16);
+                if (rs == NULL) { printf("Error creating the reed solomon decoder\n"); }
+                decoders.push_back(rs);
+            }
+            slots.resize(workerCount * FALCON_RS_SLOTS_PER_WORKER);
 
-            generic_block<FalconRS>::registerInput(_in);
-            generic_block<FalconRS>::registerOutput(&out);
+            block::registerInput(_in);
+            block::registerOutput(&out);
+            block::_block_init = true;
         }
 
+        void setInput(stream<uint8_t>* in) {
+            assert(block::_block_init);
+            std::lock_guard<std::recursive_mutex> lck(block::ctrlMtx);
+            block::tempStop();
+            block::unregisterInput(_in);
+            _in = in;
+            block::registerInput(_in);
+            block::tempStart();
+        }
+
+        int getFrameCount() { return frameCount; }
+        int getFailedFrameCount() { return failedCount; }
+
         int run() {
-            count = _in->read();
+            int count = _in->read();
             if (count < 0) { return -1; }
+            if (count != FALCON_FRAME_BYTES) {
+                _in->flush();
+                return count;
+            }
 
-            uint8_t* data = _in->readBuf + 4;
+            // Make room for the frame by sending out the oldest one if needed
+            int slotCount = slots.size();
+            if (writeId - readId >= slotCount) {
+                if (!sendOldest(true)) { return -1; }
+            }
 
-            // Deinterleave
-            for (int i = 0; i < 255 * 5; i++) {
-                buffers[i % 5][i / 5] = fromDB[data[i]];
+            // Hand it over to the workers
+            {
+                std::lock_guard<std::mutex> lck(slotMtx);
+                Slot& slot = slots[writeId % slotCount];
+                memcpy(slot.frame, _in->readBuf, FALCON_FRAME_BYTES);
+                slot.state = SLOT_PENDING;
+                writeId++;
             }
+            workCV.notify_one();
+            _in->flush();
 
-            // Reed the solomon :weary:
-            int result = 0;
-            result = correct_reed_solomon_decode(rs, buffers[0], 255, outBuffers[0]);
-            if (result == -1) {
-                _in->flush();
-                return count;
+            // Send out whatever is already done without waiting
+            while (writeId - readId > 0) {
+                int ret = sendOldest(false);
+                if (ret < 0) { return -1; }
+                if (!ret) { break; }
             }
-            result = correct_reed_solomon_decode(rs, buffers[1], 255, outBuffers[1]);
-            if (result == -1) {
-                _in->flush();
-                return count;
+
+            return count;
+        }
+
+        stream<uint8_t> out;
+
+    private:
+        enum SlotState {
+            SLOT_EMPTY,
+            SLOT_PENDING,
+            SLOT_RUNNING,
+            SLOT_DONE,
+            SLOT_FAILED
+        };
+
+        struct Slot {
+            uint8_t frame[FALCON_FRAME_BYTES];
+            uint8_t data[FALCON_RS_FRAME_SIZE];
+            SlotState state = SLOT_EMPTY;
+        };
+
+        // Sends out the oldest frame if it's decoded. Returns 1 if it was, 0 if not ready and -1 if stopped
+        int sendOldest(bool wait) {
+            Slot& slot = slots[readId % slots.size()];
+            {
+                std::unique_lock<std::mutex> lck(slotMtx);
+                if (wait) {
+                    doneCV.wait(lck, [&] { return slot.state == SLOT_DONE || slot.state == SLOT_FAILED || stopWorkers; });
+                    if (stopWorkers) { return -1; }
+                }
+                else if (slot.state != SLOT_DONE && slot.state != SLOT_FAILED) {
+                    return 0;
+                }
             }
-            result = correct_reed_solomon_decode(rs, buffers[2], 255, outBuffers[2]);
-            if (result == -1) {
-                _in->flush();
-                return count;
+
+            // The slot can't be touched by the workers until it's marked empty
+            readId++;
+            frameCount++;
+            bool ok = (slot.state == SLOT_DONE);
+            if (ok) { memcpy(out.writeBuf, slot.data, FALCON_RS_FRAME_SIZE); }
+            else { failedCount++; }
+            {
+                std::lock_guard<std::mutex> lck(slotMtx);
+                slot.state = SLOT_EMPTY;
             }
-            result = correct_reed_solomon_decode(rs, buffers[3], 255, outBuffers[3]);
-            if (result == -1) {
-                _in->flush();
-                return count;
+            if (ok && !out.swap(FALCON_RS_FRAME_SIZE)) { return -1; }
+            return 1;
+        }
+
+        void worker(int id) {
+            threading::setName("falcon_rs_" + std::to_string(id));
+            correct_reed_solomon* rs = decoders[id];
+            uint8_t buffers[FALCON_RS_BLOCKS][FALCON_RS_BLOCK_SIZE];
+            uint8_t outBuffers[FALCON_RS_BLOCKS][FALCON_RS_BLOCK_SIZE];
+
+            while (true) {
+                // Wait for a frame to decode, taking them in the order they came in so the oldest is done first
+                Slot* slot = NULL;
+                {
+                    std::unique_lock<std::mutex> lck(slotMtx);
+                    workCV.wait(lck, [&] { return stopWorkers || dispatchId < writeId; });
+                    if (stopWorkers) { return; }
+                    slot = &slots[dispatchId++ % slots.size()];
+                    slot->state = SLOT_RUNNING;
+                }
+
+                // Deinterleave
+                uint8_t* data = slot->frame + 4;
+                for (int i = 0; i < FALCON_RS_FRAME_SIZE; i++) {
+                    buffers[i % FALCON_RS_BLOCKS][i / FALCON_RS_BLOCKS] = fromDB[data[i]];
+                }
+
+                // Reed the solomon :weary:
+                bool ok = true;
+                for (int i = 0; i < FALCON_RS_BLOCKS && ok; i++) {
+                    memset(outBuffers[i], 0, FALCON_RS_BLOCK_SIZE);
+                    ok = (correct_reed_solomon_decode(rs, buffers[i], FALCON_RS_BLOCK_SIZE, outBuffers[i]) >= 0);
+                }
+
+                // Reinterleave
+                if (ok) {
+                    for (int i = 0; i < FALCON_RS_FRAME_SIZE; i++) {
+                        slot->data[i] = toDB[outBuffers[i % FALCON_RS_BLOCKS][i / FALCON_RS_BLOCKS]] ^ randVals[i % FALCON_RS_BLOCK_SIZE];
+                    }
+                }
+
+                {
+                    std::lock_guard<std::mutex> lck(slotMtx);
+                    slot->state = ok ? SLOT_DONE : SLOT_FAILED;
+                }
+                doneCV.notify_all();
             }
-            result = correct_reed_solomon_decode(rs, buffers[4], 255, outBuffers[4]);
-            if (result == -1) {
-                _in->flush();
-                return count;
+        }
+
+        void doStart() {
+            for (int i = 0; i < decoders.size(); i++) {
+                workers.push_back(std::thread(&FalconRS::worker, this, i));
             }
+            block::workerThread = std::thread(&FalconRS::workerLoop, this);
+        }
 
-            // Reinterleave
-            for (int i = 0; i < 255 * 5; i++) {
-                out.writeBuf[i] = toDB[outBuffers[i % 5][i / 5]] ^ randVals[i % 255];
+        void doStop() {
+            // Stop taking in frames, but let the workers finish the ones in flight and send them out.
+            // The blocks after this one are stopped later so the output is still being read.
+            _in->stopReader();
+            if (block::workerThread.joinable()) { block::workerThread.join(); }
+            while (writeId - readId > 0) {
+                if (sendOldest(true) < 0) { break; }
             }
 
-            out.swap(255 * 5);
+            out.stopWriter();
+            {
+                std::lock_guard<std::mutex> lck(slotMtx);
+                stopWorkers = true;
+            }
+            workCV.notify_all();
+            doneCV.notify_all();
 
-            _in->flush();
-            return count;
-        }
+            for (auto& w : workers) {
+                if (w.joinable()) { w.join(); }
+            }
+            workers.clear();
 
-        stream<uint8_t> out;
+            // Drop anything that couldn't be sent
+            for (auto& slot : slots) { slot.state = SLOT_EMPTY; }
+            readId = 0;
+            writeId = 0;
+            dispatchId = 0;
 
-    private:
-        int count;
-        uint8_t buffers[5][255];
-        uint8_t outBuffers[5][255];
-        correct_reed_solomon* rs;
+            _in->clearReadStop();
+            out.clearWriteStop();
+            stopWorkers = false;
+        }
 
         stream<uint8_t>* _in;
+
+        std::vector<correct_reed_solomon*> decoders;
+        std::vector<std::thread> workers;
+
+        std::mutex slotMtx;
+        std::condition_variable workCV;
+        std::condition_variable doneCV;
+        std::vector<Slot> slots;
+        int64_t writeId = 0;
+        int64_t readId = 0;
+        int64_t dispatchId = 0;
+        bool stopWorkers = false;
+
+        std::atomic<int> frameCount = 0;
+        std::atomic<int> failedCount = 0;
     };
-}
\ No newline at end of file
+}
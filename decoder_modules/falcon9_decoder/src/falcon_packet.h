@@ -8,25 +8,37 @@ namespace dsp {
         uint16_t packet;
     };
 
-    class FalconPacketSync : public generic_block<FalconPacketSync> {
+    class FalconPacketSync : public block {
     public:
         FalconPacketSync() {}
 
         FalconPacketSync(stream<uint8_t>* in) { init(in); }
 
         ~FalconPacketSync() {
-            generic_block<FalconPacketSync>::stop();
+            if (!block::_block_init) { return; }
+            block::stop();
         }
 
         void init(stream<uint8_t>* in) {
             _in = in;
 
-            generic_block<FalconPacketSync>::registerInput(_in);
-            generic_block<FalconPacketSync>::registerOutput(&out);
+            block::registerInput(_in);
+            block::registerOutput(&out);
+            block::_block_init = true;
+        }
+
+        void setInput(stream<uint8_t>* in) {
+            assert(block::_block_init);
+            std::lock_guard<std::recursive_mutex> lck(block::ctrlMtx);
+            block::tempStop();
+            block::unregisterInput(_in);
+            _in = in;
+            block::registerInput(_in);
+            block::tempStart();
         }
 
         int run() {
-            count = _in->read();
+            int count = _in->read();
             if (count < 0) { return -1; }
 
             // Parse frame header
@@ -46,26 +58,32 @@ namespace dsp {
 
             // If frame is just a continuation of a single packet, save it
             // If we're not currently reading a packet
-            if (header.packet == 2047 && packetRead >= 0) {
-                memcpy(packet + packetRead, data, dataLen);
-                packetRead += dataLen;
+            if (header.packet == 2047) {
+                if (packetRead >= 0 && packetRead + dataLen <= sizeof(packet)) {
+                    memcpy(packet + packetRead, data, dataLen);
+                    packetRead += dataLen;
+                }
+                else {
+                    packetRead = -1;
+                }
                 _in->flush();
-                printf("Wow, all data\n");
                 return count;
             }
-            else if (header.packet == 2047) {
-                printf("Wow, all data\n");
+
+            // A pointer past the end of the frame means the header is corrupted, drop everything and resync on the next frame
+            if (header.packet > dataLen) {
+                packetRead = -1;
                 _in->flush();
                 return count;
             }
 
             // Finish reading the last package and send it
-            if (packetRead >= 0) {
+            if (packetRead >= 0 && packetRead + header.packet <= sizeof(packet)) {
                 memcpy(packet + packetRead, data, header.packet);
                 memcpy(out.writeBuf, packet, packetRead + header.packet);
-                out.swap(packetRead + header.packet);
-                packetRead = -1;
+                if (!out.swap(packetRead + header.packet)) { return -1; }
             }
+            packetRead = -1;
 
             // Iterate through every packet of the frame
             for (int i = header.packet; i < dataLen;) {
@@ -96,7 +114,7 @@ namespace dsp {
 
                 // Here, the package fits fully, read it and jump to the next
                 memcpy(out.writeBuf, &data[i], length);
-                out.swap(length);
+                if (!out.swap(length)) { return -1; }
                 i += length;
             }
 
@@ -107,7 +125,6 @@ namespace dsp {
         stream<uint8_t> out;
 
     private:
-        int count;
         uint32_t lastCounter = 0;
 
         int packetRead = -1;
@@ -0,0 +1,92 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#define FALCON_TS_PACKET_SIZE   188
+#define FALCON_TS_SYNC          0x47
+
+// Complete video PES payload, valid only for the duration of the handler call
+struct FalconVideoFrame {
+    const uint8_t* data;
+    int size;
+};
+
+// Reassembles the video elementary stream frames from the MPEG transport stream packets
+// sent by the rocket. Locks onto the first video PID that shows up.
+class FalconVideoDemux {
+public:
+    void setHandler(void (*handler)(FalconVideoFrame frame, void* ctx), void* ctx) {
+        _handler = handler;
+        _ctx = ctx;
+    }
+
+    void reset() {
+        videoPid = -1;
+        frame.clear();
+        inFrame = false;
+    }
+
+    void process(const uint8_t* data, int count) {
+        for (int i = 0; i + FALCON_TS_PACKET_SIZE <= count; i += FALCON_TS_PACKET_SIZE) {
+            processPacket(&data[i]);
+        }
+    }
+
+    int getFrameCount() { return frameCount; }
+
+private:
+    void processPacket(const uint8_t* pkt) {
+        if (pkt[0] != FALCON_TS_SYNC) { return; }
+        bool unitStart = pkt[1] & 0x40;
+        int pid = ((pkt[1] & 0x1F) << 8) | pkt[2];
+        int adaptation = (pkt[3] >> 4) & 0b11;
+        int continuity = pkt[3] & 0xF;
+
+        // Find the payload
+        if (!(adaptation & 1)) { return; }
+        int offset = 4;
+        if (adaptation & 2) { offset += 1 + pkt[4]; }
+        if (offset >= FALCON_TS_PACKET_SIZE) { return; }
+        const uint8_t* payload = &pkt[offset];
+        int payloadSize = FALCON_TS_PACKET_SIZE - offset;
+
+        // Lock onto the first PID carrying a video PES
+        bool pesStart = unitStart && payloadSize >= 9 && payload[0] == 0 && payload[1] == 0 && payload[2] == 1 && (payload[3] & 0xF0) == 0xE0;
+        if (videoPid < 0 && pesStart) { videoPid = pid; }
+        if (pid != videoPid) { return; }
+
+        // A lost packet corrupts the current frame
+        if (inFrame && continuity != ((lastContinuity + 1) & 0xF)) { inFrame = false; }
+        lastContinuity = continuity;
+
+        if (unitStart) {
+            // The previous frame is complete
+            if (inFrame && !frame.empty() && _handler) {
+                frameCount++;
+                _handler({ frame.data(), (int)frame.size() }, _ctx);
+            }
+            frame.clear();
+            inFrame = false;
+            if (!pesStart) { return; }
+
+            // Skip the PES header
+            int headerSize = 9 + payload[8];
+            if (headerSize > payloadSize) { return; }
+            frame.insert(frame.end(), payload + headerSize, payload + payloadSize);
+            inFrame = true;
+            return;
+        }
+
+        if (inFrame) { frame.insert(frame.end(), payload, payload + payloadSize); }
+    }
+
+    void (*_handler)(FalconVideoFrame frame, void* ctx) = NULL;
+    void* _ctx = NULL;
+
+    int videoPid = -1;
+    int lastContinuity = 0;
+    bool inFrame = false;
+    std::vector<uint8_t> frame;
+    int frameCount = 0;
+};
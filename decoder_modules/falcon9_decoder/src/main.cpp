@@ -5,22 +5,24 @@
 #include <signal_path/signal_path.h>
 #include <module.h>
 #include <gui/gui.h>
-#include <dsp/pll.h>
-#include <dsp/stream.h>
-#include <dsp/demodulator.h>
-#include <dsp/window.h>
-#include <dsp/resampling.h>
-#include <dsp/processing.h>
-#include <dsp/routing.h>
-
-#include <dsp/deframing.h>
+#include <gui/widgets/folder_select.h>
+#include <dsp/demod/quadrature.h>
+#include <dsp/clock_recovery/mm.h>
+#include <dsp/routing/doubler.h>
+#include <dsp/buffer/reshaper.h>
+#include <dsp/digital/binary_slicer.h>
+#include <dsp/sink/handler_sink.h>
+
+#include <falcon_deframer.h>
 #include <falcon_fec.h>
 #include <falcon_packet.h>
-#include <dsp/sink.h>
+#include <falcon_video.h>
+#include <falcon9_interface.h>
 
 #include <gui/widgets/symbol_diagram.h>
 
 #include <fstream>
+#include <ctime>
 
 #define CONCAT(a, b) ((std::string(a) + b).c_str())
 
@@ -28,105 +30,126 @@ SDRPP_MOD_INFO{
     /* Name:            */ "falcon9_decoder",
     /* Description:     */ "Falcon9 telemetry decoder for SDR++",
     /* Author:          */ "Ryzerth",
-    /* Version:         */ 0, 1, 0,
+    /* Version:         */ 0, 2, 0,
     /* Max instances    */ -1
 };
 
-#define INPUT_SAMPLE_RATE 6000000
+ConfigManager config;
 
-std::ofstream file("output.ts");
+#define INPUT_SAMPLE_RATE   6000000
+#define SYMBOL_RATE         3571400.0
+#define FM_DEVIATION        2000000.0
+
+#define FALCON_GPS_PACKET_ID_A  0x0117FE0800320303
+#define FALCON_GPS_PACKET_ID_B  0x0112FA0800320303
+#define FALCON_VIDEO_PACKET_ID  0x01123201042E1403
+#define FALCON_VIDEO_TS_SIZE    (5 * FALCON_TS_PACKET_SIZE)
 
 class Falcon9DecoderModule : public ModuleManager::Instance {
 public:
-    Falcon9DecoderModule(std::string name) {
+    Falcon9DecoderModule(std::string name) : folderSelect("%ROOT%/recordings") {
         this->name = name;
 
+        // Load config
+        config.acquire();
+        if (config.conf.contains(name) && config.conf[name].contains("recPath")) {
+            folderSelect.setPath(config.conf[name]["recPath"]);
+        }
+        config.release();
+
         vfo = sigpath::vfoManager.createVFO(name, ImGui::WaterfallVFO::REF_CENTER, 0, 4000000, INPUT_SAMPLE_RATE, 4000000, 4000000, true);
 
-        // dsp::Splitter<float> split;
-        // dsp::Reshaper<float> reshape;
-        // dsp::HandlerSink<float> symSink;
-        // dsp::stream<float> thrInput;
-        // dsp::Threshold thr;
-
-        demod.init(vfo->output, INPUT_SAMPLE_RATE, 2000000.0f);
-        recov.init(&demod.out, (float)INPUT_SAMPLE_RATE / 3571400.0f, powf(0.01f, 2) / 4.0f, 0.01, 100e-6f); // 0.00765625f, 0.175f, 0.005f
-        split.init(&recov.out);
-        split.bindStream(&reshapeInput);
-        split.bindStream(&thrInput);
-        reshape.init(&reshapeInput, 1024, 198976);
+        demod.init(vfo->output, FM_DEVIATION, INPUT_SAMPLE_RATE);
+        recov.init(&demod.out, (double)INPUT_SAMPLE_RATE / SYMBOL_RATE, powf(0.01f, 2) / 4.0f, 0.01, 100e-6);
+        doubler.init(&recov.out);
+        reshape.init(&doubler.outA, 1024, 198976);
         symSink.init(&reshape.out, symSinkHandler, this);
-        thr.init(&thrInput);
-        deframe.init(&thr.out, 10232, syncWord, 32);
+        slicer.init(&doubler.outB);
+        deframe.init(&slicer.out);
         falconRS.init(&deframe.out);
         pkt.init(&falconRS.out);
         sink.init(&pkt.out, sinkHandler, this);
 
-        demod.start();
-        recov.start();
-        split.start();
-        reshape.start();
-        symSink.start();
-        sink.start();
-        pkt.start();
-        falconRS.start();
-        deframe.start();
-        thr.start();
+        videoDemux.setHandler(videoFrameHandler, this);
 
-#ifdef _WIN32
-        ffplay = _popen("ffplay -framedrop -infbuf -hide_banner -loglevel panic -window_title \"Falcon 9 Cameras\" -", "wb");
-#else
-        ffplay = popen("ffplay -framedrop -infbuf -hide_banner -loglevel panic -window_title \"Falcon 9 Cameras\" -", "wb");
-#endif
+        start();
 
         gui::menu.registerEntry(name, menuHandler, this, this);
+        core::modComManager.registerInterface("falcon9_decoder", name, moduleInterfaceHandler, this);
     }
 
     ~Falcon9DecoderModule() {
+        core::modComManager.unregisterInterface(name);
+        gui::menu.removeEntry(name);
+        if (enabled) { disable(); }
+        stopRecording();
     }
 
     void postInit() {}
 
     void enable() {
         vfo = sigpath::vfoManager.createVFO(name, ImGui::WaterfallVFO::REF_CENTER, 0, 4000000, INPUT_SAMPLE_RATE, 4000000, 4000000, true);
-
         demod.setInput(vfo->output);
+        start();
+        enabled = true;
+    }
+
+    void disable() {
+        stop();
+        sigpath::vfoManager.deleteVFO(vfo);
+        enabled = false;
+    }
 
+    bool isEnabled() {
+        return enabled;
+    }
+
+private:
+    void start() {
         demod.start();
         recov.start();
-        split.start();
+        doubler.start();
         reshape.start();
         symSink.start();
-        sink.start();
-        pkt.start();
-        falconRS.start();
+        slicer.start();
         deframe.start();
-        thr.start();
-
-        enabled = true;
+        falconRS.start();
+        pkt.start();
+        sink.start();
     }
 
-    void disable() {
+    void stop() {
         demod.stop();
         recov.stop();
-        split.stop();
+        doubler.stop();
         reshape.stop();
         symSink.stop();
-        sink.stop();
-        pkt.stop();
-        falconRS.stop();
+        slicer.stop();
         deframe.stop();
-        thr.stop();
+        falconRS.stop();
+        pkt.stop();
+        sink.stop();
+        videoDemux.reset();
+    }
 
-        sigpath::vfoManager.deleteVFO(vfo);
-        enabled = false;
+    void startRecording() {
+        char fileName[64];
+        time_t now = time(NULL);
+        strftime(fileName, sizeof(fileName), "/falcon9_%Y%m%d-%H%M%S.ts", localtime(&now));
+        std::string path = folderSelect.expandString(folderSelect.path + fileName);
+
+        std::lock_guard<std::mutex> lck(recMtx);
+        recFile.open(path, std::ios::out | std::ios::binary);
+        if (!recFile.is_open()) {
+            spdlog::error("Could not open '{0}' to record the Falcon 9 video", path);
+        }
     }
 
-    bool isEnabled() {
-        return enabled;
+    void stopRecording() {
+        std::lock_guard<std::mutex> lck(recMtx);
+        if (recFile.is_open()) { recFile.close(); }
     }
 
-private:
     static void menuHandler(void* ctx) {
         Falcon9DecoderModule* _this = (Falcon9DecoderModule*)ctx;
 
@@ -137,6 +160,35 @@ private:
         ImGui::SetNextItemWidth(menuWidth);
         _this->symDiag.draw();
 
+        // Decoder statistics
+        int frames = _this->falconRS.getFrameCount();
+        int failed = _this->falconRS.getFailedFrameCount();
+        ImGui::Text("Frames: %d (%d failed)", frames, failed);
+        ImGui::Text("Video frames: %d", _this->videoDemux.getFrameCount());
+
+        // Video recording
+        bool recording;
+        {
+            std::lock_guard<std::mutex> lck(_this->recMtx);
+            recording = _this->recFile.is_open();
+        }
+        if (recording) { style::beginDisabled(); }
+        if (_this->folderSelect.render("##_falcon9_rec_path_" + _this->name) && _this->folderSelect.pathIsValid()) {
+            config.acquire();
+            config.conf[_this->name]["recPath"] = _this->folderSelect.path;
+            config.release(true);
+        }
+        if (recording) { style::endDisabled(); }
+
+        if (recording) {
+            if (ImGui::Button(CONCAT("Stop recording video##_falcon9_rec_", _this->name), ImVec2(menuWidth, 0))) { _this->stopRecording(); }
+        }
+        else {
+            if (!_this->folderSelect.pathIsValid()) { style::beginDisabled(); }
+            if (ImGui::Button(CONCAT("Record video##_falcon9_rec_", _this->name), ImVec2(menuWidth, 0))) { _this->startRecording(); }
+            if (!_this->folderSelect.pathIsValid()) { style::endDisabled(); }
+        }
+
         if (_this->logsVisible) {
             if (ImGui::Button("Hide logs", ImVec2(menuWidth, 0))) { _this->logsVisible = false; }
         }
@@ -151,28 +203,29 @@ private:
             ImGui::BeginTabBar("Falcon9Tabs");
 
             // GPS Logs
-            ImGui::BeginTabItem("GPS");
-            if (ImGui::Button("Clear logs##GPSClear")) { _this->gpsLogs.clear(); }
-            ImGui::BeginChild(ImGuiID("GPSChild"));
-            ImGui::TextUnformatted(_this->gpsLogs.c_str());
-            ImGui::SetScrollHereY(1.0f);
-            ImGui::EndChild();
-            ImGui::EndTabItem();
+            if (ImGui::BeginTabItem("GPS")) {
+                if (ImGui::Button("Clear logs##GPSClear")) { _this->gpsLogs.clear(); }
+                ImGui::BeginChild("GPSChild");
+                ImGui::TextUnformatted(_this->gpsLogs.c_str());
+                ImGui::SetScrollHereY(1.0f);
+                ImGui::EndChild();
+                ImGui::EndTabItem();
+            }
 
             // STMM1A Logs
-            ImGui::BeginTabItem("STMM1A");
-
-            ImGui::EndTabItem();
+            if (ImGui::BeginTabItem("STMM1A")) {
+                ImGui::EndTabItem();
+            }
 
             // STMM1B Logs
-            ImGui::BeginTabItem("STMM1B");
-
-            ImGui::EndTabItem();
+            if (ImGui::BeginTabItem("STMM1B")) {
+                ImGui::EndTabItem();
+            }
 
             // STMM1C Logs
-            ImGui::BeginTabItem("STMM1C");
-
-            ImGui::EndTabItem();
+            if (ImGui::BeginTabItem("STMM1C")) {
+                ImGui::EndTabItem();
+            }
 
             ImGui::EndTabBar();
             ImGui::End();
@@ -183,22 +236,30 @@ private:
 
     static void sinkHandler(uint8_t* data, int count, void* ctx) {
         Falcon9DecoderModule* _this = (Falcon9DecoderModule*)ctx;
+        if (count < 25) { return; }
 
         uint16_t length = (((data[0] & 0b1111) << 8) | data[1]) + 2;
         uint64_t pktId = ((uint64_t)data[2] << 56) | ((uint64_t)data[3] << 48) | ((uint64_t)data[4] << 40) | ((uint64_t)data[5] << 32) | ((uint64_t)data[6] << 24) | ((uint64_t)data[7] << 16) | ((uint64_t)data[8] << 8) | data[9];
 
-        if (pktId == 0x0117FE0800320303 || pktId == 0x0112FA0800320303) {
+        if ((pktId == FALCON_GPS_PACKET_ID_A || pktId == FALCON_GPS_PACKET_ID_B) && length <= count) {
             data[length - 2] = 0;
             _this->logsMtx.lock();
             _this->gpsLogs += (char*)(data + 25);
             _this->logsMtx.unlock();
         }
-        else if (pktId == 0x01123201042E1403) {
-            fwrite(data + 25, 1, 940, _this->ffplay);
-            file.write((char*)(data + 25), 940);
+        else if (pktId == FALCON_VIDEO_PACKET_ID && count >= 25 + FALCON_VIDEO_TS_SIZE) {
+            {
+                std::lock_guard<std::mutex> lck(_this->recMtx);
+                if (_this->recFile.is_open()) { _this->recFile.write((char*)(data + 25), FALCON_VIDEO_TS_SIZE); }
+            }
+            _this->videoDemux.process(data + 25, FALCON_VIDEO_TS_SIZE);
         }
+    }
 
-        //printf("%016" PRIX64 ": %d bytes, %d full\n", pktId, length, count);
+    static void videoFrameHandler(FalconVideoFrame frame, void* ctx) {
+        Falcon9DecoderModule* _this = (Falcon9DecoderModule*)ctx;
+        std::lock_guard<std::mutex> lck(_this->videoMtx);
+        _this->onVideoFrame.emit(frame);
     }
 
     static void symSinkHandler(float* data, int count, void* ctx) {
@@ -208,6 +269,17 @@ private:
         _this->symDiag.releaseBuffer();
     }
 
+    static void moduleInterfaceHandler(int code, void* in, void* out, void* ctx) {
+        Falcon9DecoderModule* _this = (Falcon9DecoderModule*)ctx;
+        std::lock_guard<std::mutex> lck(_this->videoMtx);
+        if (code == FALCON9_IFACE_CMD_BIND_VIDEO_HANDLER && in) {
+            _this->onVideoFrame.bindHandler((EventHandler<FalconVideoFrame>*)in);
+        }
+        else if (code == FALCON9_IFACE_CMD_UNBIND_VIDEO_HANDLER && in) {
+            _this->onVideoFrame.unbindHandler((EventHandler<FalconVideoFrame>*)in);
+        }
+    }
+
     std::string name;
     bool enabled = true;
 
@@ -217,25 +289,27 @@ private:
     std::string gpsLogs = "";
 
     // DSP Chain
-    dsp::FloatFMDemod demod;
-    dsp::MMClockRecovery<float> recov;
+    dsp::demod::Quadrature demod;
+    dsp::clock_recovery::MM<float> recov;
+    dsp::routing::Doubler<float> doubler;
 
-    dsp::Splitter<float> split;
+    dsp::buffer::Reshaper<float> reshape;
+    dsp::sink::Handler<float> symSink;
 
-    dsp::stream<float> reshapeInput;
-    dsp::Reshaper<float> reshape;
-    dsp::HandlerSink<float> symSink;
-
-    dsp::stream<float> thrInput;
-    dsp::Threshold thr;
-
-    uint8_t syncWord[32] = { 0, 0, 0, 1, 1, 0, 1, 0, 1, 1, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 1, 1, 1, 0, 1 };
-    dsp::Deframer deframe;
+    dsp::digital::BinarySlicer slicer;
+    dsp::FalconDeframer deframe;
     dsp::FalconRS falconRS;
     dsp::FalconPacketSync pkt;
-    dsp::HandlerSink<uint8_t> sink;
+    dsp::sink::Handler<uint8_t> sink;
 
-    FILE* ffplay;
+    // Video output
+    FalconVideoDemux videoDemux;
+    std::mutex videoMtx;
+    Event<FalconVideoFrame> onVideoFrame;
+
+    FolderSelect folderSelect;
+    std::mutex recMtx;
+    std::ofstream recFile;
 
     VFOManager::VFO* vfo;
 
@@ -243,7 +317,10 @@ private:
 };
 
 MOD_EXPORT void _INIT_() {
-    // Nothing
+    json def = json({});
+    config.setPath(core::args["root"].s() + "/falcon9_decoder_config.json");
+    config.load(def);
+    config.enableAutoSave();
 }
 
 MOD_EXPORT ModuleManager::Instance* _CREATE_INSTANCE_(std::string name) {
@@ -255,5 +332,6 @@ MOD_EXPORT void _DELETE_INSTANCE_(void* instance) {
 }
 
 MOD_EXPORT void _END_() {
-    // Nothing either
-}
\ No newline at end of file
+    config.disableAutoSave();
+    config.save();
+}
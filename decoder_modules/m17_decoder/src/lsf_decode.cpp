@@ -3,7 +3,7 @@
 #include <base40.h>
 #include <stdio.h>
 #include <inttypes.h>
-#include <crc16.h>
+#include <dsp/fec/crc16.h>
 #include <spdlog/spdlog.h>
 
 bool M17CheckCRC(uint8_t* data, int len) {
@@ -35,12 +35,8 @@ M17LSF M17DecodeLSF(uint8_t* _lsf) {
     }
 
     // Check CRC
-    mobilinkd::CRC16 crc16;
-    crc16.reset();
-    for (int i = 0; i < 28; i++) {
-        crc16(_lsf[i]);
-    }
-    if (crc16.get() != lsf.rawCRC) {
+    static dsp::fec::CRC16 crc16(0x5935, 0xFFFF);
+    if (crc16.compute(_lsf, 28) != lsf.rawCRC) {
         lsf.valid = false;
         return lsf;
     }
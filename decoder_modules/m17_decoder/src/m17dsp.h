@@ -5,19 +5,21 @@
 #include <dsp/demod/gfsk.h>
 #include <dsp/routing/doubler.h>
 #include <volk/volk.h>
+#include <dsp/fec/viterbi.h>
+#include <dsp/fec/golay24.h>
 #include <codec2.h>
-#include <golay24.h>
 #include <lsf_decode.h>
 
-extern "C" {
-#include <correct.h>
-}
-
 #define M17_DEVIATION     2400.0f
 #define M17_BAUDRATE      4800.0f
 #define M17_RRC_ALPHA     0.5f
 #define M17_4FSK_HIGH_CUT 0.5f
 
+// Soft bits saturate one symbol spacing away from the decision thresholds
+#define M17_SOFT_SIGN_SCALE 384.0f
+#define M17_SOFT_MAG_SCALE  768.0f
+#define M17_SOFT_ERASURE    128
+
 #define M17_SYNC_SIZE            16
 #define M17_LICH_SIZE            96
 #define M17_PAYLOAD_SIZE         144
@@ -86,7 +88,8 @@ const uint8_t M17_PUNCTURING_P1[61] = { 1, 1, 0, 1, 1, 1, 0, 1, 1, 1, 0, 1, 1, 1
 
 const uint8_t M17_PUNCTURING_P2[12] = { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0 };
 
-static const correct_convolutional_polynomial_t correct_conv_m17_polynomial[] = { 0b11001, 0b10111 };
+const uint16_t M17_CONV_POLY_A = 0b11001;
+const uint16_t M17_CONV_POLY_B = 0b10111;
 
 namespace dsp {
     class M17Slice4FSK : public block {
@@ -116,11 +119,12 @@ namespace dsp {
             int count = _in->read();
             if (count < 0) { return -1; }
 
+            // Output soft bits, the first one is the sign of the symbol and the second its magnitude
             float val;
             for (int i = 0; i < count; i++) {
                 val = _in->readBuf[i];
-                out.writeBuf[i * 2] = (val < 0.0f);
-                out.writeBuf[(i * 2) + 1] = (fabsf(val) > M17_4FSK_HIGH_CUT);
+                out.writeBuf[i * 2] = std::clamp<float>(128.0f - (val * M17_SOFT_SIGN_SCALE), 0.0f, 255.0f);
+                out.writeBuf[(i * 2) + 1] = std::clamp<float>(128.0f + ((fabsf(val) - M17_4FSK_HIGH_CUT) * M17_SOFT_MAG_SCALE), 0.0f, 255.0f);
             }
 
             _in->flush();
@@ -186,16 +190,16 @@ namespace dsp {
                         int id = M17_INTERLEAVER[outCount - M17_SYNC_SIZE];
 
                         if (type == 0) {
-                            linkSetupOut.writeBuf[id] = delay[i++] ^ M17_SCRAMBLER[outCount - M17_SYNC_SIZE];
+                            linkSetupOut.writeBuf[id] = delay[i++] ^ (M17_SCRAMBLER[outCount - M17_SYNC_SIZE] * 0xFF);
                         }
                         else if ((type == 1 || type == 2) && id < M17_LICH_SIZE) {
-                            lichOut.writeBuf[id] = delay[i++] ^ M17_SCRAMBLER[outCount - M17_SYNC_SIZE];
+                            lichOut.writeBuf[id] = delay[i++] ^ (M17_SCRAMBLER[outCount - M17_SYNC_SIZE] * 0xFF);
                         }
                         else if (type == 1) {
-                            streamOut.writeBuf[id - M17_LICH_SIZE] = (delay[i++] ^ M17_SCRAMBLER[outCount - M17_SYNC_SIZE]);
+                            streamOut.writeBuf[id - M17_LICH_SIZE] = (delay[i++] ^ (M17_SCRAMBLER[outCount - M17_SYNC_SIZE] * 0xFF));
                         }
                         else if (type == 2) {
-                            packetOut.writeBuf[id - M17_LICH_SIZE] = (delay[i++] ^ M17_SCRAMBLER[outCount - M17_SYNC_SIZE]);
+                            packetOut.writeBuf[id - M17_LICH_SIZE] = (delay[i++] ^ (M17_SCRAMBLER[outCount - M17_SYNC_SIZE] * 0xFF));
                         }
 
                         outCount++;
@@ -219,7 +223,7 @@ namespace dsp {
                 }
 
                 // Check for link setup syncword
-                if (!memcmp(&delay[i], M17_LSF_SYNC, M17_SYNC_SIZE)) {
+                if (syncMatches(&delay[i], M17_LSF_SYNC)) {
                     detect = true;
                     outCount = 0;
                     type = 0;
@@ -228,7 +232,7 @@ namespace dsp {
                 }
 
                 // Check for stream syncword
-                if (!memcmp(&delay[i], M17_STF_SYNC, M17_SYNC_SIZE)) {
+                if (syncMatches(&delay[i], M17_STF_SYNC)) {
                     detect = true;
                     outCount = 0;
                     type = 1;
@@ -237,7 +241,7 @@ namespace dsp {
                 }
 
                 // Check for packet syncword
-                if (!memcmp(&delay[i], M17_PKF_SYNC, M17_SYNC_SIZE)) {
+                if (syncMatches(&delay[i], M17_PKF_SYNC)) {
                     detect = true;
                     outCount = 0;
                     type = 2;
@@ -261,6 +265,13 @@ namespace dsp {
         stream<uint8_t> packetOut;
 
     private:
+        static inline bool syncMatches(const uint8_t* soft, const uint8_t* sync) {
+            for (int i = 0; i < M17_SYNC_SIZE; i++) {
+                if ((soft[i] >> 7) != sync[i]) { return false; }
+            }
+            return true;
+        }
+
         stream<uint8_t>* _in;
 
         uint8_t* delay;
@@ -280,7 +291,6 @@ namespace dsp {
         ~M17LSFDecoder() {
             if (!block::_block_init) { return; }
             block::stop();
-            correct_convolutional_destroy(conv);
         }
 
         void init(stream<uint8_t>* in, void (*handler)(M17LSF& lsf, void* ctx), void* ctx) {
@@ -288,7 +298,7 @@ namespace dsp {
             _handler = handler;
             _ctx = ctx;
 
-            conv = correct_convolutional_create(2, 5, correct_conv_m17_polynomial);
+            conv.init(M17_CONV_POLY_A, M17_CONV_POLY_B);
 
             block::registerInput(_in);
             block::_block_init = true;
@@ -308,11 +318,11 @@ namespace dsp {
             int count = _in->read();
             if (count < 0) { return -1; }
 
-            // Depuncture the data
+            // Depuncture the data, punctured bits are erasures
             int inOffset = 0;
             for (int i = 0; i < M17_ENCODED_LSF_SIZE; i++) {
                 if (!M17_PUNCTURING_P1[i % 61]) {
-                    depunctured[i] = 0;
+                    depunctured[i] = M17_SOFT_ERASURE;
                     continue;
                 }
                 depunctured[i] = _in->readBuf[inOffset++];
@@ -320,14 +330,8 @@ namespace dsp {
 
             _in->flush();
 
-            // Pack into bytes
-            memset(packed, 0, 61);
-            for (int i = 0; i < M17_ENCODED_LSF_SIZE; i++) {
-                packed[i / 8] |= depunctured[i] << (7 - (i % 8));
-            }
-
             // Run through convolutional decoder
-            correct_convolutional_decode(conv, packed, M17_ENCODED_LSF_SIZE, lsf);
+            conv.decode(depunctured, M17_ENCODED_LSF_SIZE / 2, lsf);
 
             // Decode it and call the handler
             M17LSF decLsf = M17DecodeLSF(lsf);
@@ -343,10 +347,9 @@ namespace dsp {
         void* _ctx;
 
         uint8_t depunctured[488];
-        uint8_t packed[61];
         uint8_t lsf[30];
 
-        correct_convolutional* conv;
+        fec::Viterbi<5> conv;
     };
 
     class M17PayloadFEC : public block {
@@ -358,13 +361,12 @@ namespace dsp {
         ~M17PayloadFEC() {
             if (!block::_block_init) { return; }
             block::stop();
-            correct_convolutional_destroy(conv);
         }
 
         void init(stream<uint8_t>* in) {
             _in = in;
 
-            conv = correct_convolutional_create(2, 5, correct_conv_m17_polynomial);
+            conv.init(M17_CONV_POLY_A, M17_CONV_POLY_B);
 
             block::registerInput(_in);
             block::registerOutput(&out);
@@ -385,25 +387,18 @@ namespace dsp {
             int count = _in->read();
             if (count < 0) { return -1; }
 
-            // Depuncture the data
+            // Depuncture the data, punctured bits are erasures
             int inOffset = 0;
             for (int i = 0; i < M17_ENCODED_PAYLOAD_SIZE; i++) {
                 if (!M17_PUNCTURING_P2[i % 12]) {
-                    depunctured[i] = 0;
+                    depunctured[i] = M17_SOFT_ERASURE;
                     continue;
                 }
                 depunctured[i] = _in->readBuf[inOffset++];
             }
 
-            // Pack into bytes
-            memset(packed, 0, 37);
-            for (int i = 0; i < M17_ENCODED_PAYLOAD_SIZE; i++) {
-                if (!(i % 8)) { packed[i / 8] = 0; }
-                packed[i / 8] |= depunctured[i] << (7 - (i % 8));
-            }
-
             // Run through convolutional decoder
-            correct_convolutional_decode(conv, packed, M17_ENCODED_PAYLOAD_SIZE, out.writeBuf);
+            conv.decode(depunctured, M17_ENCODED_PAYLOAD_SIZE / 2, out.writeBuf);
 
             _in->flush();
 
@@ -417,9 +412,8 @@ namespace dsp {
         stream<uint8_t>* _in;
 
         uint8_t depunctured[296];
-        uint8_t packed[37];
 
-        correct_convolutional* conv;
+        fec::Viterbi<5> conv;
     };
 
     class M17Codec2Decode : public block {
@@ -528,13 +522,13 @@ namespace dsp {
             uint32_t encodedBlock;
             uint32_t decodedBlock;
             for (int b = 0; b < 4; b++) {
-                // Pack the 24bit block into a byte
+                // Slice the soft bits and pack the 24bit block into a word
                 encodedBlock = 0;
                 decodedBlock = 0;
-                for (int i = 0; i < 24; i++) { encodedBlock |= _in->readBuf[(b * 24) + i] << (23 - i); }
+                for (int i = 0; i < 24; i++) { encodedBlock |= (_in->readBuf[(b * 24) + i] >> 7) << (23 - i); }
 
                 // Decode
-                if (!mobilinkd::Golay24::decode(encodedBlock, decodedBlock)) {
+                if (!golay.decode(encodedBlock, decodedBlock)) {
                     _in->flush();
                     return count;
                 }
@@ -587,6 +581,8 @@ namespace dsp {
         void (*_handler)(M17LSF& lsf, void* ctx);
         void* _ctx;
 
+        fec::Golay24 golay;
+
         uint8_t chunk[6];
         uint8_t lsf[240];
         bool newFrame = false;
@@ -9,6 +9,10 @@ enum {
     RADIO_IFACE_CMD_SET_SQUELCH_ENABLED,
     RADIO_IFACE_CMD_GET_SQUELCH_LEVEL,
     RADIO_IFACE_CMD_SET_SQUELCH_LEVEL,
+    RADIO_IFACE_CMD_GET_SQUELCH_RELATIVE,
+    RADIO_IFACE_CMD_SET_SQUELCH_RELATIVE,
+    RADIO_IFACE_CMD_GET_SQUELCH_SNR,
+    RADIO_IFACE_CMD_SET_SQUELCH_SNR,
 };
 
 enum {
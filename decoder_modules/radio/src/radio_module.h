@@ -86,6 +86,12 @@ public:
         afChain.addBlock(&resamp, true);
         afChain.addBlock(&deemp, false);
 
+        // Run the chains on the shared executor if it's enabled
+        if (sigpath::executor.isRunning()) {
+            ifChain.setExecutor(&sigpath::executor);
+            afChain.setExecutor(&sigpath::executor);
+        }
+
         // Initialize the sink
         srChangeHandler.ctx = this;
         srChangeHandler.handler = sampleRateChangeHandler;
@@ -254,8 +260,18 @@ private:
         if (!_this->squelchEnabled && _this->enabled) { style::beginDisabled(); }
         ImGui::SameLine();
         ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
-        if (ImGui::SliderFloat(("##_radio_sqelch_lvl_" + _this->name).c_str(), &_this->squelchLevel, _this->MIN_SQUELCH, _this->MAX_SQUELCH, "%.3fdB")) {
-            _this->setSquelchLevel(_this->squelchLevel);
+        if (_this->squelchRelative) {
+            if (ImGui::SliderFloat(("##_radio_sqelch_snr_" + _this->name).c_str(), &_this->squelchSnr, _this->MIN_SQUELCH_SNR, _this->MAX_SQUELCH_SNR, "+%.1fdB")) {
+                _this->setSquelchSnr(_this->squelchSnr);
+            }
+        }
+        else {
+            if (ImGui::SliderFloat(("##_radio_sqelch_lvl_" + _this->name).c_str(), &_this->squelchLevel, _this->MIN_SQUELCH, _this->MAX_SQUELCH, "%.3fdB")) {
+                _this->setSquelchLevel(_this->squelchLevel);
+            }
+        }
+        if (ImGui::Checkbox(("Relative to noise floor##_radio_sqelch_rel_" + _this->name).c_str(), &_this->squelchRelative)) {
+            _this->setSquelchRelative(_this->squelchRelative);
         }
         if (!_this->squelchEnabled && _this->enabled) { style::endDisabled(); }
 
@@ -360,6 +376,8 @@ private:
         bandwidthLocked = selectedDemod->getBandwidthLocked();
         snapInterval = selectedDemod->getDefaultSnapInterval();
         squelchLevel = MIN_SQUELCH;
+        squelchRelative = false;
+        squelchSnr = DEFAULT_SQUELCH_SNR;
         deempAllowed = selectedDemod->getDeempAllowed();
         deempId = deempModes.valueId((DeemphasisMode)selectedDemod->getDefaultDeemphasisMode());
         squelchEnabled = false;
@@ -385,6 +403,12 @@ private:
         if (config.conf[name][selectedDemod->getName()].contains("squelchEnabled")) {
             squelchEnabled = config.conf[name][selectedDemod->getName()]["squelchEnabled"];
         }
+        if (config.conf[name][selectedDemod->getName()].contains("squelchRelative")) {
+            squelchRelative = config.conf[name][selectedDemod->getName()]["squelchRelative"];
+        }
+        if (config.conf[name][selectedDemod->getName()].contains("squelchSnr")) {
+            squelchSnr = config.conf[name][selectedDemod->getName()]["squelchSnr"];
+        }
         if (config.conf[name][selectedDemod->getName()].contains("deempMode")) {
             if (!config.conf[name][selectedDemod->getName()]["deempMode"].is_string()) {
                 config.conf[name][selectedDemod->getName()]["deempMode"] = deempModes.key(deempId);
@@ -433,7 +457,8 @@ private:
         setFMIFNREnabled(FMIFNRAllowed ? FMIFNREnabled : false);
 
         // Configure squelch
-        setSquelchLevel(squelchLevel);
+        squelch.setSampleRate(ifSamplerate);
+        setSquelchRelative(squelchRelative);
         setSquelchEnabled(squelchEnabled);
 
         // Configure AF chain
@@ -541,7 +566,7 @@ private:
 
     void setSquelchLevel(float level) {
         squelchLevel = std::clamp<float>(level, MIN_SQUELCH, MAX_SQUELCH);
-        squelch.setLevel(squelchLevel);
+        if (!squelchRelative) { squelch.setLevel(squelchLevel); }
 
         // Save config
         config.acquire();
@@ -549,6 +574,27 @@ private:
         config.release(true);
     }
 
+    void setSquelchSnr(float snr) {
+        squelchSnr = std::clamp<float>(snr, MIN_SQUELCH_SNR, MAX_SQUELCH_SNR);
+        if (squelchRelative) { squelch.setLevel(squelchSnr); }
+
+        // Save config
+        config.acquire();
+        config.conf[name][selectedDemod->getName()]["squelchSnr"] = squelchSnr;
+        config.release(true);
+    }
+
+    void setSquelchRelative(bool relative) {
+        squelchRelative = relative;
+        squelch.setMode(squelchRelative ? dsp::noise_reduction::Squelch::MODE_RELATIVE : dsp::noise_reduction::Squelch::MODE_ABSOLUTE);
+        squelch.setLevel(squelchRelative ? squelchSnr : squelchLevel);
+
+        // Save config
+        config.acquire();
+        config.conf[name][selectedDemod->getName()]["squelchRelative"] = squelchRelative;
+        config.release(true);
+    }
+
     void setFMIFNREnabled(bool enabled) {
         FMIFNREnabled = enabled;
         if (!selectedDemod) { return; }
@@ -632,6 +678,22 @@ private:
             float* _in = (float*)in;
             _this->setSquelchLevel(*_in);
         }
+        else if (code == RADIO_IFACE_CMD_GET_SQUELCH_RELATIVE && out) {
+            bool* _out = (bool*)out;
+            *_out = _this->squelchRelative;
+        }
+        else if (code == RADIO_IFACE_CMD_SET_SQUELCH_RELATIVE && in) {
+            bool* _in = (bool*)in;
+            _this->setSquelchRelative(*_in);
+        }
+        else if (code == RADIO_IFACE_CMD_GET_SQUELCH_SNR && out) {
+            float* _out = (float*)out;
+            *_out = _this->squelchSnr;
+        }
+        else if (code == RADIO_IFACE_CMD_SET_SQUELCH_SNR && in) {
+            float* _in = (float*)in;
+            _this->setSquelchSnr(*_in);
+        }
         else {
             return;
         }
@@ -678,6 +740,8 @@ private:
 
     bool squelchEnabled = false;
     float squelchLevel;
+    bool squelchRelative = false;
+    float squelchSnr;
 
     int deempId = 0;
     bool deempAllowed;
@@ -698,6 +762,9 @@ private:
     const double MAX_NB = 10.0;
     const double MIN_SQUELCH = -100.0;
     const double MAX_SQUELCH = 0.0;
+    const double MIN_SQUELCH_SNR = 0.0;
+    const double MAX_SQUELCH_SNR = 40.0;
+    const double DEFAULT_SQUELCH_SNR = 10.0;
 
     bool enabled = true;
 };
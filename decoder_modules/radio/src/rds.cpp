@@ -1,23 +1,14 @@
 #include "rds.h"
 #include <string.h>
-#include <map>
 #include <algorithm>
 
 namespace rds {
-    std::map<uint16_t, BlockType> SYNDROMES = {
-        { 0b1111011000, BLOCK_TYPE_A  },
-        { 0b1111010100, BLOCK_TYPE_B  },
-        { 0b1001011100, BLOCK_TYPE_C  },
-        { 0b1111001100, BLOCK_TYPE_CP },
-        { 0b1001011000, BLOCK_TYPE_D  }
-    };
-
-    std::map<BlockType, uint16_t> OFFSETS = {
-        { BLOCK_TYPE_A,  0b0011111100 },
-        { BLOCK_TYPE_B,  0b0110011000 },
-        { BLOCK_TYPE_C,  0b0101101000 },
-        { BLOCK_TYPE_CP, 0b1101010000 },
-        { BLOCK_TYPE_D,  0b0110110100 }
+    const uint16_t OFFSETS[_BLOCK_TYPE_COUNT] = {
+        0b0011111100, // BLOCK_TYPE_A
+        0b0110011000, // BLOCK_TYPE_B
+        0b0101101000, // BLOCK_TYPE_C
+        0b1101010000, // BLOCK_TYPE_CP
+        0b0110110100  // BLOCK_TYPE_D
     };
 
     //                           9876543210
@@ -27,35 +18,117 @@ namespace rds {
     const int BLOCK_LEN = 26;
     const int DATA_LEN = 16;
     const int POLY_LEN = 10;
+    const int SYNDROME_COUNT = 1 << POLY_LEN;
+
+    // Longest burst of errors to correct. The code can correct bursts of up to 5 bits, but bursts that long
+    // cover about a third of all syndromes, so most random blocks would come out as "corrected"
+    const int MAX_BURST_LEN = 2;
+
+    const uint8_t NO_BLOCK = 0xFF;
+
+    // Reference bit-serial syndrome calculation, only used to build the tables
+    static uint16_t serialSyndrome(uint32_t block) {
+        uint16_t syn = 0;
+
+        // Calculate the syndrome using a LFSR
+        for (int i = BLOCK_LEN - 1; i >= 0; i--) {
+            // Shift the syndrome and keep the output
+            uint8_t outBit = (syn >> (POLY_LEN - 1)) & 1;
+            syn = (syn << 1) & (SYNDROME_COUNT - 1);
+
+            // Apply LFSR polynomial
+            syn ^= LFSR_POLY * outBit;
+
+            // Apply input polynomial.
+            syn ^= IN_POLY * ((block >> i) & 1);
+        }
+
+        return syn;
+    }
+
+    // The syndrome is linear in the block, so everything can be derived from the syndromes of single bits
+    struct SyndromeTables {
+        SyndromeTables() {
+            // Syndrome of the block shifted left by one, the bit leaving the block is accounted for separately
+            for (int i = 0; i < SYNDROME_COUNT; i++) {
+                uint16_t syn = (i << 1) & (SYNDROME_COUNT - 1);
+                shift[i] = (i >> (POLY_LEN - 1)) ? (syn ^ LFSR_POLY) : syn;
+            }
+            inBit = serialSyndrome(1);
+            outBit = shift[serialSyndrome(1 << (BLOCK_LEN - 1))];
+
+            // Syndrome of each byte of a block
+            for (int i = 0; i < 4; i++) {
+                for (int j = 0; j < 256; j++) {
+                    bytes[i][j] = serialSyndrome(((uint32_t)j << (i * 8)) & ((1 << BLOCK_LEN) - 1));
+                }
+            }
+
+            // Syndromes of error free blocks, which are those of their offset words
+            memset(blockType, NO_BLOCK, sizeof(blockType));
+            for (int i = 0; i < _BLOCK_TYPE_COUNT; i++) {
+                blockType[serialSyndrome(OFFSETS[i])] = i;
+            }
+
+            // Syndromes of all correctable bursts: first and last bit set, anything in between
+            memset(burst, 0, sizeof(burst));
+            for (int len = 1; len <= MAX_BURST_LEN; len++) {
+                int innerCount = (len > 2) ? (1 << (len - 2)) : 1;
+                for (int inner = 0; inner < innerCount; inner++) {
+                    uint32_t pattern = (len > 1) ? (1 | (inner << 1) | (1 << (len - 1))) : 1;
+                    for (int pos = 0; pos <= BLOCK_LEN - len; pos++) {
+                        burst[serialSyndrome(pattern << pos)] = pattern << pos;
+                    }
+                }
+            }
+        }
+
+        uint16_t shift[SYNDROME_COUNT];
+        uint16_t inBit;
+        uint16_t outBit;
+        uint16_t bytes[4][256];
+        uint8_t blockType[SYNDROME_COUNT];
+        uint32_t burst[SYNDROME_COUNT];
+    };
+
+    static const SyndromeTables TABLES;
 
     void RDSDecoder::process(uint8_t* symbols, int count) {
         for (int i = 0; i < count; i++) {
-            // Shift in the bit
-            shiftReg = ((shiftReg << 1) & 0x3FFFFFF) | (symbols[i] & 1);
+            // Shift in the bit and update the syndrome of the register accordingly
+            uint8_t inBit = symbols[i] & 1;
+            uint8_t outBit = (shiftReg >> (BLOCK_LEN - 1)) & 1;
+            shiftReg = ((shiftReg << 1) & 0x3FFFFFF) | inBit;
+            syndrome = TABLES.shift[syndrome] ^ (TABLES.inBit * inBit) ^ (TABLES.outBit * outBit);
 
             // Skip if we need to shift in new data
             if (--skip > 0) { continue; }
 
-            // Calculate the syndrome and update sync status
-            uint16_t syn = calcSyndrome(shiftReg);
-            auto synIt = SYNDROMES.find(syn);
-            bool knownSyndrome = synIt != SYNDROMES.end();
-            sync = std::clamp<int>(knownSyndrome ? ++sync : --sync, 0, 4);
-            
-            // If we're still no longer in sync, try to resync
-            if (!sync) { continue; }
-
             // Figure out which block we've got
+            uint8_t synType = TABLES.blockType[syndrome];
+            bool knownSyndrome = (synType != NO_BLOCK);
             BlockType type;
             if (knownSyndrome) {
-                type = SYNDROMES[syn];
+                type = (BlockType)synType;
             }
             else {
                 type = (BlockType)((lastType + 1) % _BLOCK_TYPE_COUNT);
             }
 
-            // Save block while correcting errors (NOT YET)
-            blocks[type] = correctErrors(shiftReg, type, blockAvail[type]);
+            // Update sync status, a block with errors counts against it even if it can be corrected
+            if (knownSyndrome) { sync = std::min<int>(sync + 1, 4); }
+            else { sync = std::max<int>(sync - 1, 0); }
+            
+            // If we're still no longer in sync, try to resync
+            if (!sync) { continue; }
+
+            // Only correct errors once in sync, the block type is only known for sure then
+            bool recovered;
+            uint32_t block = correctErrors(shiftReg, type, recovered);
+
+            // Save block
+            blocks[type] = block;
+            blockAvail[type] = recovered;
 
             // Update continous group count
             if (type == BLOCK_TYPE_A) { contGroup = 1; }
@@ -77,51 +150,20 @@ namespace rds {
     }
 
     uint16_t RDSDecoder::calcSyndrome(uint32_t block) {
-        uint16_t syn = 0;
-
-        // Calculate the syndrome using a LFSR
-        for (int i = BLOCK_LEN - 1; i >= 0; i--) {
-            // Shift the syndrome and keep the output
-            uint8_t outBit = (syn >> (POLY_LEN - 1)) & 1;
-            syn = (syn << 1) & 0b1111111111;
-
-            // Apply LFSR polynomial
-            syn ^= LFSR_POLY * outBit;
-
-            // Apply input polynomial.
-            syn ^= IN_POLY * ((block >> i) & 1);
-        }
-
-        return syn;
+        return TABLES.bytes[0][block & 0xFF] ^ TABLES.bytes[1][(block >> 8) & 0xFF] ^
+               TABLES.bytes[2][(block >> 16) & 0xFF] ^ TABLES.bytes[3][(block >> 24) & 0x03];
     }
 
-    uint32_t RDSDecoder::correctErrors(uint32_t block, BlockType type, bool& recovered) {        
+    uint32_t RDSDecoder::correctErrors(uint32_t block, BlockType type, bool& recovered) {
         // Subtract the offset from block
         block ^= (uint32_t)OFFSETS[type];
-        uint32_t out = block;
 
-        // Calculate syndrome of corrected block
+        // A non-zero syndrome is corrected if it matches a burst error the code can correct
         uint16_t syn = calcSyndrome(block);
+        uint32_t error = TABLES.burst[syn];
+        recovered = (!syn || error);
 
-        // Use the syndrome register to do error correction if errors are present
-        uint8_t errorFound = 0;
-        if (syn) {
-            for (int i = DATA_LEN - 1; i >= 0; i--) {
-                // Check if the 5 leftmost bits are all zero
-                errorFound |= !(syn & 0b11111);
-
-                // Write output
-                uint8_t outBit = (syn >> (POLY_LEN - 1)) & 1;
-                out ^= (errorFound & outBit) << (i + POLY_LEN);
-
-                // Shift syndrome
-                syn = (syn << 1) & 0b1111111111;
-                syn ^= LFSR_POLY * outBit * !errorFound;
-            }
-        }
-        recovered = !(syn & 0b11111);
-
-        return out;
+        return block ^ error;
     }
 
     void RDSDecoder::decodeGroup() {
@@ -147,6 +147,7 @@ namespace rds {
 
         // State machine
         uint32_t shiftReg = 0;
+        uint16_t syndrome = 0;
         int sync = 0;
         int skip = 0;
         BlockType lastType = BLOCK_TYPE_A;
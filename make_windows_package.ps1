@@ -27,6 +27,8 @@ cp 'C:/Program Files/PothosSDR/bin/hackrf.dll' sdrpp_windows_x64/
 
 cp $build_dir/source_modules/hermes_source/Release/hermes_source.dll sdrpp_windows_x64/modules/
 
+cp $build_dir/source_modules/iq_multicast_source/Release/iq_multicast_source.dll sdrpp_windows_x64/modules/
+
 cp $build_dir/source_modules/limesdr_source/Release/limesdr_source.dll sdrpp_windows_x64/modules/
 cp 'C:/Program Files/PothosSDR/bin/LimeSuite.dll' sdrpp_windows_x64/
 
@@ -74,12 +76,18 @@ cp $build_dir/misc_modules/discord_integration/Release/discord_integration.dll s
 
 cp $build_dir/misc_modules/frequency_manager/Release/frequency_manager.dll sdrpp_windows_x64/modules/
 
+cp $build_dir/misc_modules/iq_multicast_server/Release/iq_multicast_server.dll sdrpp_windows_x64/modules/
+
+cp $build_dir/misc_modules/occupancy_monitor/Release/occupancy_monitor.dll sdrpp_windows_x64/modules/
+
 cp $build_dir/misc_modules/recorder/Release/recorder.dll sdrpp_windows_x64/modules/
 
 cp $build_dir/misc_modules/rigctl_server/Release/rigctl_server.dll sdrpp_windows_x64/modules/
 
 cp $build_dir/misc_modules/scanner/Release/scanner.dll sdrpp_windows_x64/modules/
 
+cp $build_dir/misc_modules/waterfall_history/Release/waterfall_history.dll sdrpp_windows_x64/modules/
+
 
 # Copy supporting libs
 cp 'C:/Program Files/PothosSDR/bin/libusb-1.0.dll' sdrpp_windows_x64/
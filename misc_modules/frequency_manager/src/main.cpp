@@ -67,6 +67,8 @@ public:
         config.acquire();
         std::string selList = config.conf["selectedList"];
         bookmarkDisplayMode = config.conf["bookmarkDisplayMode"];
+        activityThreshold = config.conf["activityThreshold"];
+        showActivity = config.conf["showActivity"];
         config.release();
 
         refreshLists();
@@ -84,6 +86,7 @@ public:
     }
 
     ~FrequencyManagerModule() {
+        setSpectrumSubscribed(false);
         gui::menu.removeEntry(name);
         gui::waterfall.onFFTRedraw.unbindHandler(&fftRedrawHandler);
         gui::waterfall.onInputProcess.unbindHandler(&inputHandler);
@@ -97,6 +100,7 @@ public:
 
     void disable() {
         enabled = false;
+        setSpectrumSubscribed(false);
     }
 
     bool isEnabled() {
@@ -485,10 +489,14 @@ private:
         }
 
         // Bookmark list
-        if (ImGui::BeginTable(("freq_manager_bkm_table" + _this->name).c_str(), 2, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY, ImVec2(0, 200))) {
+        _this->menuShownFrame = ImGui::GetFrameCount();
+        SpectrumFrameRef frame = _this->getSpectrumFrame();
+        int columns = _this->showActivity ? 3 : 2;
+        if (ImGui::BeginTable(("freq_manager_bkm_table" + _this->name).c_str(), columns, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY, ImVec2(0, 200))) {
             ImGui::TableSetupColumn("Name");
             ImGui::TableSetupColumn("Bookmark");
-            ImGui::TableSetupScrollFreeze(2, 1);
+            if (_this->showActivity) { ImGui::TableSetupColumn("SNR", ImGuiTableColumnFlags_WidthFixed); }
+            ImGui::TableSetupScrollFreeze(columns, 1);
             ImGui::TableHeadersRow();
             for (auto& [name, bm] : _this->bookmarks) {
                 ImGui::TableNextRow();
@@ -510,6 +518,19 @@ private:
 
                 ImGui::TableSetColumnIndex(1);
                 ImGui::Text("%s %s", utils::formatFreq(bm.frequency).c_str(), demodModeList[bm.mode]);
+
+                if (!_this->showActivity) { continue; }
+                ImGui::TableSetColumnIndex(2);
+                float snr = bookmarkSnr(frame, bm);
+                if (isnan(snr)) {
+                    ImGui::TextUnformatted("-");
+                }
+                else if (snr >= _this->activityThreshold) {
+                    ImGui::TextColored(ImVec4(0, 1, 0, 1), "%.1fdB", snr);
+                }
+                else {
+                    ImGui::Text("%.1fdB", snr);
+                }
                 ImVec2 max = ImGui::GetCursorPos();
             }
             ImGui::EndTable();
@@ -561,6 +582,22 @@ private:
             config.release(true);
         }
 
+        if (ImGui::Checkbox(("Show activity##_freq_mgr_show_act_" + _this->name).c_str(), &_this->showActivity)) {
+            config.acquire();
+            config.conf["showActivity"] = _this->showActivity;
+            config.release(true);
+        }
+
+        if (_this->showActivity) {
+            ImGui::LeftLabel("Activity threshold");
+            ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+            if (ImGui::SliderFloat(("##_freq_mgr_act_thr_" + _this->name).c_str(), &_this->activityThreshold, 0.0f, 40.0f, "%.1fdB")) {
+                config.acquire();
+                config.conf["activityThreshold"] = _this->activityThreshold;
+                config.release(true);
+            }
+        }
+
         if (_this->selectedListName == "") { style::endDisabled(); }
 
         if (_this->createOpen) {
@@ -602,16 +639,47 @@ private:
         }
     }
 
+    // Strongest level within the bookmark's bandwidth above the noise floor, NAN if it's not in the spectrum
+    static float bookmarkSnr(const SpectrumFrameRef& frame, const FrequencyBookmark& bm) {
+        if (!frame || frame->floor.empty()) { return NAN; }
+        double halfBw = std::max<double>(bm.bandwidth / 2.0, frame->binWidth());
+        if (bm.frequency - halfBw < frame->startFrequency() || bm.frequency + halfBw > frame->endFrequency()) { return NAN; }
+        return frame->snr(bm.frequency - halfBw, bm.frequency + halfBw, true);
+    }
+
+    // The spectrum and its noise floor are only needed while the activity is shown somewhere,
+    // that is in the menu or on the waterfall markers
+    void updateSpectrumSubscription() {
+        bool menuShown = (ImGui::GetFrameCount() - menuShownFrame) <= 1;
+        setSpectrumSubscribed(enabled && showActivity && (menuShown || bookmarkDisplayMode != BOOKMARK_DISP_MODE_OFF));
+    }
+
+    void setSpectrumSubscribed(bool subscribed) {
+        if (subscribed == spectrumSubscribed) { return; }
+        spectrumSubscribed = subscribed;
+        if (subscribed) { sigpath::spectrum.subscribe(true); }
+        else { sigpath::spectrum.unsubscribe(true); }
+    }
+
+    SpectrumFrameRef getSpectrumFrame() {
+        updateSpectrumSubscription();
+        return spectrumSubscribed ? sigpath::spectrum.getLatest() : NULL;
+    }
+
     static void fftRedraw(ImGui::WaterFall::FFTRedrawArgs args, void* ctx) {
         FrequencyManagerModule* _this = (FrequencyManagerModule*)ctx;
+        SpectrumFrameRef frame = _this->getSpectrumFrame();
         if (_this->bookmarkDisplayMode == BOOKMARK_DISP_MODE_OFF) { return; }
 
+        // Bookmarks with a signal above the activity threshold are drawn in green
+
         if (_this->bookmarkDisplayMode == BOOKMARK_DISP_MODE_TOP) {
             for (auto const bm : _this->waterfallBookmarks) {
                 double centerXpos = args.min.x + std::round((bm.bookmark.frequency - args.lowFreq) * args.freqToPixelRatio);
+                ImU32 color = (bookmarkSnr(frame, bm.bookmark) >= _this->activityThreshold) ? IM_COL32(0, 255, 0, 255) : IM_COL32(255, 255, 0, 255);
 
                 if (bm.bookmark.frequency >= args.lowFreq && bm.bookmark.frequency <= args.highFreq) {
-                    args.window->DrawList->AddLine(ImVec2(centerXpos, args.min.y), ImVec2(centerXpos, args.max.y), IM_COL32(255, 255, 0, 255));
+                    args.window->DrawList->AddLine(ImVec2(centerXpos, args.min.y), ImVec2(centerXpos, args.max.y), color);
                 }
 
                 ImVec2 nameSize = ImGui::CalcTextSize(bm.bookmarkName.c_str());
@@ -621,7 +689,7 @@ private:
                 ImVec2 clampedRectMax = ImVec2(std::clamp<double>(rectMax.x, args.min.x, args.max.x), rectMax.y);
 
                 if (clampedRectMax.x - clampedRectMin.x > 0) {
-                    args.window->DrawList->AddRectFilled(clampedRectMin, clampedRectMax, IM_COL32(255, 255, 0, 255));
+                    args.window->DrawList->AddRectFilled(clampedRectMin, clampedRectMax, color);
                 }
                 if (rectMin.x >= args.min.x && rectMax.x <= args.max.x) {
                     args.window->DrawList->AddText(ImVec2(centerXpos - (nameSize.x / 2), args.min.y), IM_COL32(0, 0, 0, 255), bm.bookmarkName.c_str());
@@ -631,9 +699,10 @@ private:
         else if (_this->bookmarkDisplayMode == BOOKMARK_DISP_MODE_BOTTOM) {
             for (auto const bm : _this->waterfallBookmarks) {
                 double centerXpos = args.min.x + std::round((bm.bookmark.frequency - args.lowFreq) * args.freqToPixelRatio);
+                ImU32 color = (bookmarkSnr(frame, bm.bookmark) >= _this->activityThreshold) ? IM_COL32(0, 255, 0, 255) : IM_COL32(255, 255, 0, 255);
 
                 if (bm.bookmark.frequency >= args.lowFreq && bm.bookmark.frequency <= args.highFreq) {
-                    args.window->DrawList->AddLine(ImVec2(centerXpos, args.min.y), ImVec2(centerXpos, args.max.y), IM_COL32(255, 255, 0, 255));
+                    args.window->DrawList->AddLine(ImVec2(centerXpos, args.min.y), ImVec2(centerXpos, args.max.y), color);
                 }
 
                 ImVec2 nameSize = ImGui::CalcTextSize(bm.bookmarkName.c_str());
@@ -643,7 +712,7 @@ private:
                 ImVec2 clampedRectMax = ImVec2(std::clamp<double>(rectMax.x, args.min.x, args.max.x), rectMax.y);
 
                 if (clampedRectMax.x - clampedRectMin.x > 0) {
-                    args.window->DrawList->AddRectFilled(clampedRectMin, clampedRectMax, IM_COL32(255, 255, 0, 255));
+                    args.window->DrawList->AddRectFilled(clampedRectMin, clampedRectMax, color);
                 }
                 if (rectMin.x >= args.min.x && rectMax.x <= args.max.x) {
                     args.window->DrawList->AddText(ImVec2(centerXpos - (nameSize.x / 2), args.max.y - nameSize.y), IM_COL32(0, 0, 0, 255), bm.bookmarkName.c_str());
@@ -822,12 +891,18 @@ private:
     std::vector<WaterfallBookmark> waterfallBookmarks;
 
     int bookmarkDisplayMode = 0;
+    float activityThreshold = 10.0f;
+    bool showActivity = false;
+    bool spectrumSubscribed = false;
+    int menuShownFrame = -2;
 };
 
 MOD_EXPORT void _INIT_() {
     json def = json({});
     def["selectedList"] = "General";
     def["bookmarkDisplayMode"] = BOOKMARK_DISP_MODE_TOP;
+    def["activityThreshold"] = 10.0f;
+    def["showActivity"] = false;
     def["lists"]["General"]["showOnWaterfall"] = true;
     def["lists"]["General"]["bookmarks"] = json::object();
 
@@ -840,6 +915,12 @@ MOD_EXPORT void _INIT_() {
     if (!config.conf.contains("bookmarkDisplayMode")) {
         config.conf["bookmarkDisplayMode"] = BOOKMARK_DISP_MODE_TOP;
     }
+    if (!config.conf.contains("activityThreshold")) {
+        config.conf["activityThreshold"] = 10.0f;
+    }
+    if (!config.conf.contains("showActivity")) {
+        config.conf["showActivity"] = false;
+    }
     for (auto [listName, list] : config.conf["lists"].items()) {
         if (list.contains("bookmarks") && list.contains("showOnWaterfall") && list["showOnWaterfall"].is_boolean()) { continue; }
         json newList;
@@ -0,0 +1,426 @@
+#include <utils/networking.h>
+#include <imgui.h>
+#include <module.h>
+#include <gui/gui.h>
+#include <gui/style.h>
+#include <signal_path/signal_path.h>
+#include <dsp/sink/handler_sink.h>
+#include <utils/optionlist.h>
+#include <iq_multicast_protocol.h>
+#include <spdlog/spdlog.h>
+#include <config.h>
+#include <core.h>
+#include <chrono>
+#include <atomic>
+#include <math.h>
+
+#define CONCAT(a, b) ((std::string(a) + b).c_str())
+
+SDRPP_MOD_INFO{
+    /* Name:            */ "iq_multicast_server",
+    /* Description:     */ "Publishes baseband or VFO IQ over UDP multicast",
+    /* Author:          */ "Ryzerth",
+    /* Version:         */ 0, 1, 0,
+    /* Max instances    */ -1
+};
+
+ConfigManager config;
+
+enum Mode {
+    MODE_BASEBAND,
+    MODE_VFO
+};
+
+class IQMulticastServerModule : public ModuleManager::Instance {
+public:
+    IQMulticastServerModule(std::string name) {
+        this->name = name;
+
+        // Define option lists
+        sampleTypes.define("int8", "Int8", iq_multicast::SAMPLE_TYPE_INT8);
+        sampleTypes.define("int16", "Int16", iq_multicast::SAMPLE_TYPE_INT16);
+        sampleTypes.define("float32", "Float32", iq_multicast::SAMPLE_TYPE_FLOAT32);
+        vfoSampleRates.define(12500, "12.5KHz", 12500.0);
+        vfoSampleRates.define(25000, "25KHz", 25000.0);
+        vfoSampleRates.define(50000, "50KHz", 50000.0);
+        vfoSampleRates.define(100000, "100KHz", 100000.0);
+        vfoSampleRates.define(250000, "250KHz", 250000.0);
+        vfoSampleRates.define(500000, "500KHz", 500000.0);
+        vfoSampleRates.define(1000000, "1MHz", 1000000.0);
+        sampleTypeId = sampleTypes.valueId(iq_multicast::SAMPLE_TYPE_INT16);
+        vfoSrId = vfoSampleRates.valueId(250000.0);
+        strcpy(group, IQ_MULTICAST_DEFAULT_GROUP);
+
+        // Load config
+        config.acquire();
+        if (config.conf[name].contains("mode")) {
+            mode = config.conf[name]["mode"];
+        }
+        if (config.conf[name].contains("group")) {
+            std::string _group = config.conf[name]["group"];
+            strcpy(group, _group.substr(0, sizeof(group) - 1).c_str());
+        }
+        if (config.conf[name].contains("port")) {
+            port = config.conf[name]["port"];
+        }
+        if (config.conf[name].contains("ttl")) {
+            ttl = config.conf[name]["ttl"];
+        }
+        if (config.conf[name].contains("mtu")) {
+            mtu = config.conf[name]["mtu"];
+        }
+        if (config.conf[name].contains("streamId")) {
+            streamId = config.conf[name]["streamId"];
+        }
+        if (config.conf[name].contains("sampleType") && sampleTypes.keyExists(config.conf[name]["sampleType"])) {
+            sampleTypeId = sampleTypes.keyId(config.conf[name]["sampleType"]);
+        }
+        if (config.conf[name].contains("vfoSampleRate") && vfoSampleRates.keyExists(config.conf[name]["vfoSampleRate"])) {
+            vfoSrId = vfoSampleRates.keyId(config.conf[name]["vfoSampleRate"]);
+        }
+        bool startNow = config.conf[name].contains("running") && config.conf[name]["running"];
+        config.release();
+
+        sink.init(NULL, handler, this);
+
+        gui::menu.registerEntry(name, menuHandler, this);
+
+        if (startNow) { start(); }
+    }
+
+    ~IQMulticastServerModule() {
+        gui::menu.removeEntry(name);
+        stop();
+    }
+
+    void postInit() {}
+
+    void enable() {
+        enabled = true;
+    }
+
+    void disable() {
+        stop();
+        enabled = false;
+    }
+
+    bool isEnabled() {
+        return enabled;
+    }
+
+    void start() {
+        std::lock_guard lck(runMtx);
+        if (running) { return; }
+
+        // Open the socket
+        try {
+            conn = net::openUDP("0.0.0.0", port, group, port, false);
+        }
+        catch (std::exception& e) {
+            spdlog::error("IQMulticastServerModule '{0}': Could not open socket: {1}", name, e.what());
+            return;
+        }
+        if (!conn) { return; }
+        conn->setMulticastTTL(ttl);
+        conn->setMulticastLoopback(true);
+
+        // Allocate the packet buffer for the largest possible block
+        sampleType = sampleTypes[sampleTypeId];
+        samplesPerPacket = iq_multicast::samplesPerPacket(mtu, sampleType);
+        if (samplesPerPacket <= 0) {
+            spdlog::error("IQMulticastServerModule '{0}': MTU of {1} is too small", name, mtu);
+            conn->close();
+            conn.reset();
+            return;
+        }
+        packetStride = sizeof(iq_multicast::PacketHeader) + (samplesPerPacket * iq_multicast::sampleSize(sampleType));
+        int maxPackets = (STREAM_BUFFER_SIZE + samplesPerPacket - 1) / samplesPerPacket;
+        packetBuf.resize(maxPackets * packetStride);
+        entries.resize(maxPackets);
+        sequence = 0;
+        sampleIndex = 0;
+        packetsSent = 0;
+        packetsDropped = 0;
+
+        // Bind the selected stream
+        if (mode == MODE_VFO) {
+            double sr = vfoSampleRates[vfoSrId];
+            vfo = sigpath::vfoManager.createVFO(name, ImGui::WaterfallVFO::REF_CENTER, 0, sr, sr, sr, sr, true);
+            sink.setInput(vfo->output);
+            sink.start();
+        }
+        else {
+            basebandStream = new dsp::stream<dsp::complex_t>();
+            sink.setInput(basebandStream);
+            sink.start();
+            sigpath::iqFrontEnd.bindIQStream(basebandStream);
+        }
+
+        running = true;
+    }
+
+    void stop() {
+        std::lock_guard lck(runMtx);
+        if (!running) { return; }
+
+        // Unbind the stream
+        if (mode == MODE_VFO) {
+            sink.stop();
+            sigpath::vfoManager.deleteVFO(vfo);
+            vfo = NULL;
+        }
+        else {
+            sigpath::iqFrontEnd.unbindIQStream(basebandStream);
+            sink.stop();
+            delete basebandStream;
+        }
+
+        conn->close();
+        conn.reset();
+
+        running = false;
+    }
+
+private:
+    static void menuHandler(void* ctx) {
+        IQMulticastServerModule* _this = (IQMulticastServerModule*)ctx;
+        float menuWidth = ImGui::GetContentRegionAvail().x;
+
+        if (_this->running) { style::beginDisabled(); }
+
+        ImGui::BeginGroup();
+        ImGui::Columns(2, CONCAT("IQMulticastModeColumns##_", _this->name), false);
+        if (ImGui::RadioButton(CONCAT("Baseband##_iq_multicast_mode_", _this->name), _this->mode == MODE_BASEBAND)) {
+            _this->mode = MODE_BASEBAND;
+            config.acquire();
+            config.conf[_this->name]["mode"] = _this->mode;
+            config.release(true);
+        }
+        ImGui::NextColumn();
+        if (ImGui::RadioButton(CONCAT("VFO##_iq_multicast_mode_", _this->name), _this->mode == MODE_VFO)) {
+            _this->mode = MODE_VFO;
+            config.acquire();
+            config.conf[_this->name]["mode"] = _this->mode;
+            config.release(true);
+        }
+        ImGui::Columns(1, CONCAT("EndIQMulticastModeColumns##_", _this->name), false);
+        ImGui::EndGroup();
+
+        ImGui::SetNextItemWidth(menuWidth * 0.65f);
+        if (ImGui::InputText(CONCAT("##_iq_multicast_group_", _this->name), _this->group, sizeof(_this->group) - 1)) {
+            config.acquire();
+            config.conf[_this->name]["group"] = _this->group;
+            config.release(true);
+        }
+        ImGui::SameLine();
+        ImGui::FillWidth();
+        if (ImGui::InputInt(CONCAT("##_iq_multicast_port_", _this->name), &_this->port, 0, 0)) {
+            _this->port = std::clamp<int>(_this->port, 1, 65535);
+            config.acquire();
+            config.conf[_this->name]["port"] = _this->port;
+            config.release(true);
+        }
+
+        ImGui::LeftLabel("Sample type");
+        ImGui::FillWidth();
+        if (ImGui::Combo(CONCAT("##_iq_multicast_st_", _this->name), &_this->sampleTypeId, _this->sampleTypes.txt)) {
+            config.acquire();
+            config.conf[_this->name]["sampleType"] = _this->sampleTypes.key(_this->sampleTypeId);
+            config.release(true);
+        }
+
+        if (_this->mode == MODE_VFO) {
+            ImGui::LeftLabel("Samplerate");
+            ImGui::FillWidth();
+            if (ImGui::Combo(CONCAT("##_iq_multicast_sr_", _this->name), &_this->vfoSrId, _this->vfoSampleRates.txt)) {
+                config.acquire();
+                config.conf[_this->name]["vfoSampleRate"] = _this->vfoSampleRates.key(_this->vfoSrId);
+                config.release(true);
+            }
+        }
+
+        ImGui::LeftLabel("Stream ID");
+        ImGui::FillWidth();
+        if (ImGui::InputInt(CONCAT("##_iq_multicast_stream_id_", _this->name), &_this->streamId, 0, 0)) {
+            _this->streamId = std::clamp<int>(_this->streamId, 0, 65535);
+            config.acquire();
+            config.conf[_this->name]["streamId"] = _this->streamId;
+            config.release(true);
+        }
+
+        ImGui::LeftLabel("MTU");
+        ImGui::FillWidth();
+        if (ImGui::InputInt(CONCAT("##_iq_multicast_mtu_", _this->name), &_this->mtu, 0, 0)) {
+            _this->mtu = std::clamp<int>(_this->mtu, 576, IQ_MULTICAST_MAX_PACKET + IQ_MULTICAST_IP_OVERHEAD);
+            config.acquire();
+            config.conf[_this->name]["mtu"] = _this->mtu;
+            config.release(true);
+        }
+
+        ImGui::LeftLabel("TTL");
+        ImGui::FillWidth();
+        if (ImGui::InputInt(CONCAT("##_iq_multicast_ttl_", _this->name), &_this->ttl, 0, 0)) {
+            _this->ttl = std::clamp<int>(_this->ttl, 0, 255);
+            config.acquire();
+            config.conf[_this->name]["ttl"] = _this->ttl;
+            config.release(true);
+        }
+
+        if (_this->running) { style::endDisabled(); }
+
+        if (_this->running && ImGui::Button(CONCAT("Stop##_iq_multicast_stop_", _this->name), ImVec2(menuWidth, 0))) {
+            _this->stop();
+            config.acquire();
+            config.conf[_this->name]["running"] = false;
+            config.release(true);
+        }
+        else if (!_this->running && ImGui::Button(CONCAT("Start##_iq_multicast_start_", _this->name), ImVec2(menuWidth, 0))) {
+            _this->start();
+            config.acquire();
+            config.conf[_this->name]["running"] = true;
+            config.release(true);
+        }
+
+        ImGui::TextUnformatted("Status:");
+        ImGui::SameLine();
+        if (_this->running && _this->conn && _this->conn->isOpen()) {
+            ImGui::TextColored(ImVec4(0.0, 1.0, 0.0, 1.0), "Sending (%" PRIu64 " packets)", _this->packetsSent.load());
+            if (_this->packetsDropped) { ImGui::Text("Dropped: %" PRIu64 " packets", _this->packetsDropped.load()); }
+        }
+        else if (_this->running) {
+            ImGui::TextColored(ImVec4(1.0, 0.0, 0.0, 1.0), "Error");
+        }
+        else {
+            ImGui::TextUnformatted("Idle");
+        }
+    }
+
+    static void handler(dsp::complex_t* data, int count, void* ctx) {
+        IQMulticastServerModule* _this = (IQMulticastServerModule*)ctx;
+        if (!_this->conn || !_this->conn->isOpen()) { return; }
+
+        // Get the metadata of the block
+        double sampleRate, centerFreq;
+        if (_this->mode == MODE_VFO) {
+            sampleRate = _this->vfoSampleRates[_this->vfoSrId];
+            centerFreq = gui::waterfall.getCenterFrequency() + _this->vfo->getOffset();
+        }
+        else {
+            sampleRate = sigpath::iqFrontEnd.getSampleRate();
+            centerFreq = gui::waterfall.getCenterFrequency();
+        }
+        uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        uint64_t firstTime = now - (uint64_t)((double)count * 1e9 / sampleRate);
+
+        // Integer types are scaled to the peak magnitude of the block
+        float scale = 1.0f;
+        float convScale = 1.0f;
+        if (_this->sampleType != iq_multicast::SAMPLE_TYPE_FLOAT32) {
+            uint32_t maxIdx;
+            volk_32fc_index_max_32u(&maxIdx, (lv_32fc_t*)data, count);
+            float maxVal = sqrtf((data[maxIdx].re * data[maxIdx].re) + (data[maxIdx].im * data[maxIdx].im));
+            if (maxVal == 0.0f || !isfinite(maxVal)) { maxVal = 1.0f; }
+            float fullScale = (_this->sampleType == iq_multicast::SAMPLE_TYPE_INT8) ? 127.0f : 32767.0f;
+            convScale = fullScale / maxVal;
+            scale = maxVal / fullScale;
+        }
+
+        // Build one datagram per MTU-sized slice of the block
+        int packetCount = 0;
+        for (int i = 0; i < count; i += _this->samplesPerPacket) {
+            int n = std::min<int>(_this->samplesPerPacket, count - i);
+            uint8_t* pkt = &_this->packetBuf[packetCount * _this->packetStride];
+            iq_multicast::PacketHeader* hdr = (iq_multicast::PacketHeader*)pkt;
+            hdr->magic = IQ_MULTICAST_MAGIC;
+            hdr->version = IQ_MULTICAST_VERSION;
+            hdr->sampleType = _this->sampleType;
+            hdr->streamId = _this->streamId;
+            hdr->sampleCount = n;
+            hdr->scale = scale;
+            hdr->sequence = _this->sequence++;
+            hdr->timestamp = firstTime + (uint64_t)((double)i * 1e9 / sampleRate);
+            hdr->sampleIndex = _this->sampleIndex + i;
+            hdr->sampleRate = sampleRate;
+            hdr->centerFrequency = centerFreq;
+
+            uint8_t* payload = &pkt[sizeof(iq_multicast::PacketHeader)];
+            if (_this->sampleType == iq_multicast::SAMPLE_TYPE_INT8) {
+                volk_32f_s32f_convert_8i((int8_t*)payload, (float*)&data[i], convScale, n * 2);
+            }
+            else if (_this->sampleType == iq_multicast::SAMPLE_TYPE_INT16) {
+                volk_32f_s32f_convert_16i((int16_t*)payload, (float*)&data[i], convScale, n * 2);
+            }
+            else {
+                memcpy(payload, &data[i], n * sizeof(dsp::complex_t));
+            }
+
+            _this->entries[packetCount].count = sizeof(iq_multicast::PacketHeader) + (n * iq_multicast::sampleSize(_this->sampleType));
+            _this->entries[packetCount].buf = pkt;
+            _this->entries[packetCount].owned = false;
+            _this->entries[packetCount].droppable = true;
+            packetCount++;
+        }
+        _this->sampleIndex += count;
+
+        // Send the whole block in one batch. If the socket couldn't take it (full send buffer
+        // and the like), the batch is dropped and the socket kept open for the next one.
+        if (_this->conn->writeBatch(packetCount, _this->entries.data())) {
+            _this->packetsSent += packetCount;
+        }
+        else {
+            _this->packetsDropped += packetCount;
+        }
+    }
+
+    std::string name;
+    bool enabled = true;
+    bool running = false;
+    std::recursive_mutex runMtx;
+
+    int mode = MODE_BASEBAND;
+    char group[1024];
+    int port = IQ_MULTICAST_DEFAULT_PORT;
+    int ttl = 1;
+    int mtu = IQ_MULTICAST_DEFAULT_MTU;
+    int streamId = 0;
+
+    OptionList<std::string, int> sampleTypes;
+    OptionList<int, double> vfoSampleRates;
+    int sampleTypeId;
+    int vfoSrId;
+
+    dsp::stream<dsp::complex_t>* basebandStream;
+    VFOManager::VFO* vfo = NULL;
+    dsp::sink::Handler<dsp::complex_t> sink;
+
+    net::Conn conn;
+    int sampleType;
+    int samplesPerPacket;
+    int packetStride;
+    std::vector<uint8_t> packetBuf;
+    std::vector<net::ConnWriteEntry> entries;
+    uint64_t sequence = 0;
+    uint64_t sampleIndex = 0;
+    std::atomic<uint64_t> packetsSent = 0;
+    std::atomic<uint64_t> packetsDropped = 0;
+};
+
+MOD_EXPORT void _INIT_() {
+    json def = json({});
+    config.setPath(core::args["root"].s() + "/iq_multicast_server_config.json");
+    config.load(def);
+    config.enableAutoSave();
+}
+
+MOD_EXPORT ModuleManager::Instance* _CREATE_INSTANCE_(std::string name) {
+    return new IQMulticastServerModule(name);
+}
+
+MOD_EXPORT void _DELETE_INSTANCE_(ModuleManager::Instance* inst) {
+    delete (IQMulticastServerModule*)inst;
+}
+
+MOD_EXPORT void _END_() {
+    config.disableAutoSave();
+    config.save();
+}
@@ -0,0 +1,482 @@
+#include <imgui.h>
+#include <module.h>
+#include <gui/gui.h>
+#include <gui/style.h>
+#include <gui/tuner.h>
+#include <signal_path/signal_path.h>
+#include <signal_path/channel_detector.h>
+#include <utils/freq_formatting.h>
+#include <config.h>
+#include <core.h>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <time.h>
+#include "occupancy_db.h"
+
+SDRPP_MOD_INFO{
+    /* Name:            */ "occupancy_monitor",
+    /* Description:     */ "Signal activity log and spectrum occupancy database for SDR++",
+    /* Author:          */ "Ryzerth",
+    /* Version:         */ 0, 1, 0,
+    /* Max instances    */ 1
+};
+
+// Fraction of the sampled bandwidth that isn't attenuated by the anti-aliasing filters
+#define OCCUPANCY_USABLE_BANDWIDTH  0.9
+
+// Maximum number of events shown in the viewer
+#define OCCUPANCY_MAX_EVENTS        200
+
+ConfigManager config;
+
+const uint64_t viewRanges[] = {
+    3600ull,
+    6ull * 3600ull,
+    24ull * 3600ull,
+    7ull * 24ull * 3600ull,
+    0ull
+};
+
+const char* viewRangesTxt = "Last hour\0Last 6 hours\0Last day\0Last week\0Everything\0";
+
+class OccupancyMonitorModule : public ModuleManager::Instance {
+public:
+    OccupancyMonitorModule(std::string name) {
+        this->name = name;
+
+        // Load config
+        config.acquire();
+        std::string _path = config.conf["path"];
+        strcpy(path, _path.c_str());
+        plan.start = config.conf["startFreq"];
+        stopFreq = config.conf["stopFreq"];
+        plan.interval = config.conf["interval"];
+        plan.width = config.conf["width"];
+        bucketDuration = config.conf["bucketDuration"];
+        threshold = config.conf["threshold"];
+        hysteresis = config.conf["hysteresis"];
+        viewRangeId = std::clamp<int>(config.conf["viewRange"], 0, (sizeof(viewRanges) / sizeof(viewRanges[0])) - 1);
+        bool autoStart = config.conf["running"];
+        config.release();
+
+        queryRunning = true;
+        queryThread = std::thread(&OccupancyMonitorModule::queryWorker, this);
+
+        gui::menu.registerEntry(name, menuHandler, this, NULL);
+
+        if (autoStart) { start(); }
+    }
+
+    ~OccupancyMonitorModule() {
+        gui::menu.removeEntry(name);
+        stop();
+        {
+            std::lock_guard<std::mutex> lck(queryMtx);
+            queryRunning = false;
+        }
+        queryCnd.notify_all();
+        if (queryThread.joinable()) { queryThread.join(); }
+    }
+
+    void postInit() {}
+
+    void enable() {
+        enabled = true;
+    }
+
+    void disable() {
+        enabled = false;
+    }
+
+    bool isEnabled() {
+        return enabled;
+    }
+
+private:
+    static void menuHandler(void* ctx) {
+        OccupancyMonitorModule* _this = (OccupancyMonitorModule*)ctx;
+        float menuWidth = ImGui::GetContentRegionAvail().x;
+
+        if (_this->running) { ImGui::BeginDisabled(); }
+        ImGui::LeftLabel("Database");
+        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+        if (ImGui::InputText(("##occupancy_path_" + _this->name).c_str(), _this->path, sizeof(_this->path) - 1)) {
+            _this->saveConfig();
+        }
+        ImGui::LeftLabel("Start");
+        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+        if (ImGui::InputDouble(("##occupancy_start_" + _this->name).c_str(), &_this->plan.start, 100.0, 100000.0, "%0.0f")) {
+            _this->plan.start = round(_this->plan.start);
+            _this->saveConfig();
+        }
+        ImGui::LeftLabel("Stop");
+        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+        if (ImGui::InputDouble(("##occupancy_stop_" + _this->name).c_str(), &_this->stopFreq, 100.0, 100000.0, "%0.0f")) {
+            _this->stopFreq = round(_this->stopFreq);
+            _this->saveConfig();
+        }
+        ImGui::LeftLabel("Interval");
+        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+        if (ImGui::InputDouble(("##occupancy_interval_" + _this->name).c_str(), &_this->plan.interval, 100.0, 100000.0, "%0.0f")) {
+            _this->plan.interval = std::max<double>(round(_this->plan.interval), 1.0);
+            _this->saveConfig();
+        }
+        ImGui::LeftLabel("Channel Width");
+        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+        if (ImGui::InputDouble(("##occupancy_width_" + _this->name).c_str(), &_this->plan.width, 100.0, 100000.0, "%0.0f")) {
+            _this->plan.width = std::max<double>(round(_this->plan.width), 0.0);
+            _this->saveConfig();
+        }
+        ImGui::LeftLabel("Bucket Duration (s)");
+        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+        if (ImGui::InputDouble(("##occupancy_bucket_" + _this->name).c_str(), &_this->bucketDuration, 1.0, 60.0, "%0.0f")) {
+            _this->bucketDuration = std::clamp<double>(round(_this->bucketDuration), 1.0, 86400.0);
+            _this->saveConfig();
+        }
+        if (_this->running) { ImGui::EndDisabled(); }
+
+        ImGui::LeftLabel("Threshold (dB)");
+        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+        if (ImGui::SliderFloat(("##occupancy_threshold_" + _this->name).c_str(), &_this->threshold, 1.0, 50.0)) {
+            std::lock_guard<std::mutex> lck(_this->detMtx);
+            _this->detector.setThreshold(_this->threshold, _this->hysteresis);
+            _this->saveConfig();
+        }
+        ImGui::LeftLabel("Hysteresis (dB)");
+        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+        if (ImGui::SliderFloat(("##occupancy_hysteresis_" + _this->name).c_str(), &_this->hysteresis, 0.0, 20.0)) {
+            std::lock_guard<std::mutex> lck(_this->detMtx);
+            _this->detector.setThreshold(_this->threshold, _this->hysteresis);
+            _this->saveConfig();
+        }
+
+        if (!_this->running) {
+            if (ImGui::Button(("Start##occupancy_start_" + _this->name).c_str(), ImVec2(menuWidth, 0))) {
+                _this->start();
+                _this->saveConfig();
+            }
+            ImGui::Text("Status: Idle");
+        }
+        else {
+            if (ImGui::Button(("Stop##occupancy_stop_" + _this->name).c_str(), ImVec2(menuWidth, 0))) {
+                _this->stop();
+                _this->saveConfig();
+            }
+            ImGui::TextColored(ImVec4(0, 1, 0, 1), "Status: Logging");
+            ImGui::Text("Active channels: %d", _this->activeChannels.load());
+        }
+
+        if (!_this->db.isOpen()) { return; }
+        ImGui::Text("Events: %llu, Buckets: %llu", (unsigned long long)_this->db.eventCount(), (unsigned long long)_this->db.bucketCount());
+
+        // Viewer
+        ImGui::LeftLabel("Range");
+        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+        if (ImGui::Combo(("##occupancy_range_" + _this->name).c_str(), &_this->viewRangeId, viewRangesTxt)) {
+            _this->queryBucketCount = -1;
+            _this->queryEventCount = -1;
+            _this->saveConfig();
+        }
+
+        // Only query again once new data is in or the range changed, duty cycles over long ranges aren't free
+        int64_t buckets = _this->db.bucketCount();
+        int64_t events = _this->db.eventCount();
+        if (buckets != _this->queryBucketCount || events != _this->queryEventCount) {
+            _this->requestQuery();
+            _this->queryBucketCount = buckets;
+            _this->queryEventCount = events;
+        }
+
+        std::lock_guard<std::mutex> lck(_this->queryMtx);
+
+        ImGui::TextUnformatted("Duty cycle");
+        ImGui::PlotHistogram(("##occupancy_duty_" + _this->name).c_str(), _this->dutyPlot.data(), _this->dutyPlot.size(), 0, NULL, 0.0f, 1.0f, ImVec2(menuWidth, 100.0f * style::uiScale));
+        if (ImGui::IsItemHovered() && !_this->dutyPlot.empty()) {
+            float ratio = (ImGui::GetMousePos().x - ImGui::GetItemRectMin().x) / ImGui::GetItemRectSize().x;
+            int channel = std::clamp<int>(ratio * _this->dutyPlot.size(), 0, _this->dutyPlot.size() - 1);
+            ImGui::BeginTooltip();
+            ImGui::Text("%s: %.1f%%", utils::formatFreq(_this->plan.frequency(channel)).c_str(), _this->dutyPlot[channel] * 100.0f);
+            ImGui::EndTooltip();
+        }
+
+        if (ImGui::BeginTable(("occupancy_events_table" + _this->name).c_str(), 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY, ImVec2(0, 200.0f * style::uiScale))) {
+            ImGui::TableSetupColumn("Time");
+            ImGui::TableSetupColumn("Frequency");
+            ImGui::TableSetupColumn("Event");
+            ImGui::TableSetupColumn("SNR");
+            ImGui::TableSetupScrollFreeze(4, 1);
+            ImGui::TableHeadersRow();
+            for (int i = 0; i < _this->eventList.size(); i++) {
+                auto& evt = _this->eventList[i];
+                double freq = _this->plan.frequency(evt.channel);
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                if (ImGui::Selectable((formatTime(evt.time) + "##occupancy_evt_" + std::to_string(i)).c_str(), false, ImGuiSelectableFlags_SpanAllColumns | ImGuiSelectableFlags_AllowDoubleClick)) {
+                    if (ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left) && !gui::waterfall.selectedVFO.empty()) {
+                        tuner::tune(tuner::TUNER_MODE_NORMAL, gui::waterfall.selectedVFO, freq);
+                    }
+                }
+                ImGui::TableSetColumnIndex(1);
+                ImGui::TextUnformatted(utils::formatFreq(freq).c_str());
+                ImGui::TableSetColumnIndex(2);
+                ImGui::TextUnformatted((evt.type == occupancy::EVENT_START) ? "Start" : "Stop");
+                ImGui::TableSetColumnIndex(3);
+                ImGui::Text("%.1fdB", evt.snr);
+            }
+            ImGui::EndTable();
+        }
+    }
+
+    static std::string formatTime(uint64_t time) {
+        time_t t = time / 1000000000ull;
+        char buf[64];
+        strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", localtime(&t));
+        return buf;
+    }
+
+    uint64_t viewStart() {
+        uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        return viewRanges[viewRangeId] ? now - (viewRanges[viewRangeId] * 1000000000ull) : 0;
+    }
+
+    void requestQuery() {
+        {
+            std::lock_guard<std::mutex> lck(queryMtx);
+            queryStart = viewStart();
+            queryPending = true;
+        }
+        queryCnd.notify_all();
+    }
+
+    // Runs the viewer queries, scanning a long range can take longer than a frame
+    void queryWorker() {
+        std::unique_lock<std::mutex> lck(queryMtx);
+        while (true) {
+            queryCnd.wait(lck, [this]() { return queryPending || !queryRunning; });
+            if (!queryRunning) { return; }
+            queryPending = false;
+            uint64_t start = queryStart;
+            lck.unlock();
+
+            // Channels never observed in the range are shown as idle
+            std::vector<float> duty;
+            std::vector<occupancy::Event> events;
+            db.queryDutyCycle(start, UINT64_MAX, duty);
+            for (auto& d : duty) {
+                if (isnan(d)) { d = 0.0f; }
+            }
+            db.queryEvents(start, UINT64_MAX, OCCUPANCY_MAX_EVENTS, events);
+
+            lck.lock();
+            dutyPlot = std::move(duty);
+            eventList = std::move(events);
+        }
+    }
+
+    void saveConfig() {
+        config.acquire();
+        config.conf["path"] = path;
+        config.conf["startFreq"] = plan.start;
+        config.conf["stopFreq"] = stopFreq;
+        config.conf["interval"] = plan.interval;
+        config.conf["width"] = plan.width;
+        config.conf["bucketDuration"] = bucketDuration;
+        config.conf["threshold"] = threshold;
+        config.conf["hysteresis"] = hysteresis;
+        config.conf["viewRange"] = viewRangeId;
+        config.conf["running"] = running.load();
+        config.release(true);
+    }
+
+    void start() {
+        if (running) { return; }
+
+        // An existing database imposes its own channel plan
+        plan.count = std::max<int>(floor((stopFreq - plan.start) / plan.interval) + 1, 1);
+        if (!db.open(path, plan, bucketDuration)) { return; }
+        stopFreq = plan.frequency(plan.count - 1);
+
+        detector.configure(plan.start, stopFreq, plan.interval, plan.width);
+        detector.setThreshold(threshold, hysteresis);
+        wasActive.assign(plan.count, false);
+        peakSnr.assign(plan.count, -INFINITY);
+        observed.assign(plan.count, 0);
+        active.assign(plan.count, 0);
+        duty.resize(plan.count);
+        bucketStart = 0;
+        activeChannels = 0;
+        queryBucketCount = -1;
+        queryEventCount = -1;
+
+        running = true;
+        workerThread = std::thread(&OccupancyMonitorModule::worker, this);
+    }
+
+    void stop() {
+        if (!running) { return; }
+        running = false;
+        if (workerThread.joinable()) {
+            workerThread.join();
+        }
+
+        // Close the open activities and the partial bucket so the log stays consistent
+        if (bucketStart) {
+            for (int i = 0; i < plan.count; i++) {
+                if (wasActive[i]) { logEvent(lastTimestamp, i, occupancy::EVENT_STOP, peakSnr[i]); }
+            }
+            writeBucket();
+        }
+        db.close();
+    }
+
+    void worker() {
+        uint64_t lastFrameId = 0;
+        sigpath::spectrum.subscribe();
+        while (running) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+            // Only run once per spectrum frame
+            SpectrumFrameRef frame = sigpath::spectrum.getLatest();
+            if (!frame || frame->id == lastFrameId) { continue; }
+            lastFrameId = frame->id;
+            lastTimestamp = frame->timestamp;
+
+            // Start a new bucket aligned on the bucket duration when the current one is over
+            uint64_t bucketNs = bucketDuration * 1e9;
+            if (!bucketStart) {
+                bucketStart = frame->timestamp - (frame->timestamp % bucketNs);
+                bucketFirstEvent = db.eventCount();
+            }
+            else if (frame->timestamp >= bucketStart + bucketNs) {
+                writeBucket();
+                bucketStart = frame->timestamp - (frame->timestamp % bucketNs);
+                bucketFirstEvent = db.eventCount();
+            }
+
+            // Evaluate every channel of the usable part of the spectrum at once
+            double margin = frame->sampleRate * (1.0 - OCCUPANCY_USABLE_BANDWIDTH) / 2.0;
+            std::lock_guard<std::mutex> lck(detMtx);
+            activeChannels = detector.process(*frame, frame->startFrequency() + margin, frame->endFrequency() - margin);
+
+            for (int i = 0; i < plan.count; i++) {
+                ChannelDetector::Channel& ch = detector[i];
+
+                // Activity on channels that left the spectrum can't be followed anymore
+                if (ch.lastSeen != frame->id) {
+                    if (wasActive[i]) {
+                        logEvent(frame->timestamp, i, occupancy::EVENT_STOP, peakSnr[i]);
+                        wasActive[i] = false;
+                        ch.active = false;
+                    }
+                    continue;
+                }
+
+                observed[i]++;
+                float snr = ch.level - ch.floor;
+                if (ch.active) {
+                    active[i]++;
+                    if (!wasActive[i]) {
+                        logEvent(frame->timestamp, i, occupancy::EVENT_START, snr);
+                        peakSnr[i] = snr;
+                    }
+                    peakSnr[i] = std::max<float>(peakSnr[i], snr);
+                }
+                else if (wasActive[i]) {
+                    logEvent(frame->timestamp, i, occupancy::EVENT_STOP, peakSnr[i]);
+                }
+                wasActive[i] = ch.active;
+            }
+        }
+        sigpath::spectrum.unsubscribe();
+    }
+
+    void logEvent(uint64_t time, int channel, occupancy::EventType type, float snr) {
+        occupancy::Event evt;
+        evt.time = time;
+        evt.channel = channel;
+        evt.type = type;
+        evt.snr = snr;
+        db.addEvent(evt);
+    }
+
+    void writeBucket() {
+        for (int i = 0; i < plan.count; i++) {
+            duty[i] = observed[i] ? (active[i] * OCCUPANCY_DUTY_MAX) / observed[i] : OCCUPANCY_NOT_OBSERVED;
+            observed[i] = 0;
+            active[i] = 0;
+        }
+        db.addBucket(bucketStart, bucketFirstEvent, duty.data());
+    }
+
+    std::string name;
+    bool enabled = true;
+
+    char path[1024];
+    occupancy::ChannelPlan plan;
+    double stopFreq = 108000000.0;
+    double bucketDuration = 60.0;
+    float threshold = 10.0;
+    float hysteresis = 3.0;
+
+    std::atomic<bool> running = false;
+    std::thread workerThread;
+    std::mutex detMtx;
+    ChannelDetector detector;
+    std::atomic<int> activeChannels = 0;
+    occupancy::Database db;
+
+    // Activity tracking, only touched by the worker while it runs
+    std::vector<bool> wasActive;
+    std::vector<float> peakSnr;
+    std::vector<uint32_t> observed;
+    std::vector<uint32_t> active;
+    std::vector<uint8_t> duty;
+    uint64_t bucketStart = 0;
+    uint64_t bucketFirstEvent = 0;
+    uint64_t lastTimestamp = 0;
+
+    // Viewer, the results are written by the query thread under queryMtx
+    int viewRangeId = 2;
+    int64_t queryBucketCount = -1;
+    int64_t queryEventCount = -1;
+    std::vector<float> dutyPlot;
+    std::vector<occupancy::Event> eventList;
+    std::thread queryThread;
+    std::mutex queryMtx;
+    std::condition_variable queryCnd;
+    uint64_t queryStart = 0;
+    bool queryPending = false;
+    bool queryRunning = false;
+};
+
+MOD_EXPORT void _INIT_() {
+    json def = json({});
+    def["path"] = core::args["root"].s() + "/occupancy";
+    def["startFreq"] = 88000000.0;
+    def["stopFreq"] = 108000000.0;
+    def["interval"] = 100000.0;
+    def["width"] = 150000.0;
+    def["bucketDuration"] = 60.0;
+    def["threshold"] = 10.0;
+    def["hysteresis"] = 3.0;
+    def["viewRange"] = 2;
+    def["running"] = false;
+    config.setPath(core::args["root"].s() + "/occupancy_monitor_config.json");
+    config.load(def);
+    config.enableAutoSave();
+}
+
+MOD_EXPORT ModuleManager::Instance* _CREATE_INSTANCE_(std::string name) {
+    return new OccupancyMonitorModule(name);
+}
+
+MOD_EXPORT void _DELETE_INSTANCE_(void* instance) {
+    delete (OccupancyMonitorModule*)instance;
+}
+
+MOD_EXPORT void _END_() {
+    config.disableAutoSave();
+    config.save();
+}
@@ -0,0 +1,313 @@
+#include "occupancy_db.h"
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+#include <json.hpp>
+#include <spdlog/spdlog.h>
+
+using nlohmann::json;
+
+// Minimum number of elements a column grows by, to avoid remapping on every append
+#define COLUMN_MIN_GROWTH   4096
+
+// Number of buckets scanned per lock when computing duty cycles
+#define QUERY_CHUNK_SIZE    1024
+
+namespace occupancy {
+    bool Column::open(std::string path, int elementSize) {
+        _elementSize = elementSize;
+        if (!file.open(path)) {
+            spdlog::error("Could not open occupancy column '{0}'", path);
+            return false;
+        }
+
+        // Initialize new files, check existing ones
+        if (file.size() < sizeof(Header)) {
+            if (!file.resize(sizeof(Header))) {
+                file.close();
+                return false;
+            }
+            header = (Header*)file.data();
+            header->magic = OCCUPANCY_DB_MAGIC;
+            header->version = OCCUPANCY_DB_VERSION;
+            header->elementSize = elementSize;
+            header->reserved = 0;
+            header->count = 0;
+        }
+        header = (Header*)file.data();
+        if (header->magic != OCCUPANCY_DB_MAGIC || header->version != OCCUPANCY_DB_VERSION || header->elementSize != elementSize) {
+            spdlog::error("Occupancy column '{0}' is invalid or of an unsupported version", path);
+            close();
+            return false;
+        }
+
+        capacity = (file.size() - sizeof(Header)) / elementSize;
+        if (header->count > capacity) {
+            spdlog::warn("Occupancy column '{0}' is truncated, dropping the missing records", path);
+            header->count = capacity;
+        }
+        return true;
+    }
+
+    void Column::close() {
+        if (header) { file.flush(); }
+        file.close();
+        header = NULL;
+        capacity = 0;
+    }
+
+    bool Column::append(const void* element) {
+        if (!header) { return false; }
+        if (header->count >= capacity && !grow()) { return false; }
+
+        // Write the data before bumping the count so that an interrupted append is simply lost
+        memcpy(file.data() + sizeof(Header) + (header->count * _elementSize), element, _elementSize);
+        header->count++;
+        return true;
+    }
+
+    void Column::flush() {
+        file.flush();
+    }
+
+    void Column::truncate(uint64_t count) {
+        if (!header || count >= header->count) { return; }
+        header->count = count;
+    }
+
+    bool Column::grow() {
+        uint64_t newCapacity = std::max<uint64_t>(capacity * 2, COLUMN_MIN_GROWTH);
+        if (!file.resize(sizeof(Header) + (newCapacity * _elementSize))) { return false; }
+        header = (Header*)file.data();
+        capacity = newCapacity;
+        return true;
+    }
+
+    Database::~Database() {
+        close();
+    }
+
+    bool Database::open(std::string dir, ChannelPlan& plan, double& bucketDuration) {
+        std::lock_guard<std::mutex> lck(mtx);
+        if (_open) { return false; }
+
+        // Load the metadata of an existing database or create it
+        std::string metaPath = dir + "/meta.json";
+        try {
+            std::filesystem::create_directories(dir);
+            if (std::filesystem::exists(metaPath)) {
+                std::ifstream file(metaPath);
+                json meta;
+                file >> meta;
+                plan.start = meta["start"];
+                plan.interval = meta["interval"];
+                plan.width = meta["width"];
+                plan.count = meta["count"];
+                bucketDuration = meta["bucketDuration"];
+            }
+            else {
+                json meta;
+                meta["start"] = plan.start;
+                meta["interval"] = plan.interval;
+                meta["width"] = plan.width;
+                meta["count"] = plan.count;
+                meta["bucketDuration"] = bucketDuration;
+                std::ofstream file(metaPath);
+                file << meta.dump(4);
+            }
+        }
+        catch (std::exception& e) {
+            spdlog::error("Could not open occupancy database '{0}': {1}", dir, e.what());
+            return false;
+        }
+        if (plan.count <= 0) {
+            spdlog::error("Occupancy database '{0}' has an invalid channel plan", dir);
+            return false;
+        }
+        _plan = plan;
+
+        bool ok = eventTime.open(dir + "/event_time.col", sizeof(uint64_t));
+        ok = ok && eventChannel.open(dir + "/event_channel.col", sizeof(uint32_t));
+        ok = ok && eventType.open(dir + "/event_type.col", sizeof(uint8_t));
+        ok = ok && eventSnr.open(dir + "/event_snr.col", sizeof(float));
+        ok = ok && bucketTime.open(dir + "/bucket_time.col", sizeof(uint64_t));
+        ok = ok && bucketEvent.open(dir + "/bucket_event.col", sizeof(uint64_t));
+        ok = ok && bucketDuty.open(dir + "/bucket_duty.col", plan.count);
+        if (!ok) {
+            eventTime.close();
+            eventChannel.close();
+            eventType.close();
+            eventSnr.close();
+            bucketTime.close();
+            bucketEvent.close();
+            bucketDuty.close();
+            return false;
+        }
+
+        // Columns of a record may differ in length after a crash. Cut them all back to the complete
+        // records, otherwise new records would be appended at different rows in each column.
+        uint64_t events = std::min<uint64_t>({ eventTime.count(), eventChannel.count(), eventType.count(), eventSnr.count() });
+        uint64_t buckets = std::min<uint64_t>({ bucketTime.count(), bucketEvent.count(), bucketDuty.count() });
+        if (events != std::max<uint64_t>({ eventTime.count(), eventChannel.count(), eventType.count(), eventSnr.count() }) ||
+            buckets != std::max<uint64_t>({ bucketTime.count(), bucketEvent.count(), bucketDuty.count() })) {
+            spdlog::warn("Occupancy database '{0}' contains incomplete records, dropping them", dir);
+        }
+        eventTime.truncate(events);
+        eventChannel.truncate(events);
+        eventType.truncate(events);
+        eventSnr.truncate(events);
+        bucketTime.truncate(buckets);
+        bucketEvent.truncate(buckets);
+        bucketDuty.truncate(buckets);
+
+        _open = true;
+        openCount++;
+        return true;
+    }
+
+    void Database::close() {
+        std::lock_guard<std::mutex> lck(mtx);
+        if (!_open) { return; }
+        eventTime.close();
+        eventChannel.close();
+        eventType.close();
+        eventSnr.close();
+        bucketTime.close();
+        bucketEvent.close();
+        bucketDuty.close();
+        _open = false;
+    }
+
+    bool Database::isOpen() {
+        std::lock_guard<std::mutex> lck(mtx);
+        return _open;
+    }
+
+    bool Database::addEvent(const Event& evt) {
+        std::lock_guard<std::mutex> lck(mtx);
+        if (!_open) { return false; }
+        return eventChannel.append(&evt.channel) && eventType.append(&evt.type) && eventSnr.append(&evt.snr) && eventTime.append(&evt.time);
+    }
+
+    bool Database::addBucket(uint64_t time, uint64_t firstEvent, const uint8_t* duty) {
+        std::lock_guard<std::mutex> lck(mtx);
+        if (!_open) { return false; }
+        bool ok = bucketDuty.append(duty) && bucketEvent.append(&firstEvent) && bucketTime.append(&time);
+
+        // Buckets are infrequent, use them to push the data to disk
+        eventTime.flush();
+        eventChannel.flush();
+        eventType.flush();
+        eventSnr.flush();
+        bucketTime.flush();
+        bucketEvent.flush();
+        bucketDuty.flush();
+        return ok;
+    }
+
+    uint64_t Database::eventCount() {
+        std::lock_guard<std::mutex> lck(mtx);
+        return eventTime.count();
+    }
+
+    uint64_t Database::bucketCount() {
+        std::lock_guard<std::mutex> lck(mtx);
+        return bucketTime.count();
+    }
+
+    uint64_t Database::firstTime() {
+        std::lock_guard<std::mutex> lck(mtx);
+        if (!bucketTime.count()) { return 0; }
+        return bucketTime.get<uint64_t>(0);
+    }
+
+    uint64_t Database::lastTime() {
+        std::lock_guard<std::mutex> lck(mtx);
+        if (!bucketTime.count()) { return 0; }
+        return bucketTime.get<uint64_t>(bucketTime.count() - 1);
+    }
+
+    void Database::queryDutyCycle(uint64_t start, uint64_t end, std::vector<float>& duty) {
+        std::unique_lock<std::mutex> lck(mtx);
+        int channels = _plan.count;
+        duty.assign(channels, NAN);
+        if (!_open) { return; }
+        uint64_t openId = openCount;
+        uint64_t first = findBucket(start);
+        uint64_t last = findBucket(end);
+        lck.unlock();
+
+        // Scan in chunks so that long ranges don't hold up the writer and the other queries.
+        // Records are only ever appended, so the range stays valid unless the database is reopened.
+        std::vector<uint32_t> sums(channels, 0);
+        std::vector<uint32_t> counts(channels, 0);
+        for (uint64_t chunk = first; chunk < last; chunk += QUERY_CHUNK_SIZE) {
+            lck.lock();
+            if (!_open || openCount != openId) { return; }
+            uint64_t chunkEnd = std::min<uint64_t>(chunk + QUERY_CHUNK_SIZE, last);
+            for (uint64_t i = chunk; i < chunkEnd; i++) {
+                const uint8_t* row = bucketDuty.at(i);
+                for (int j = 0; j < channels; j++) {
+                    if (row[j] == OCCUPANCY_NOT_OBSERVED) { continue; }
+                    sums[j] += row[j];
+                    counts[j]++;
+                }
+            }
+            lck.unlock();
+        }
+
+        for (int i = 0; i < channels; i++) {
+            if (counts[i]) { duty[i] = (float)sums[i] / (float)(counts[i] * OCCUPANCY_DUTY_MAX); }
+        }
+    }
+
+    void Database::queryEvents(uint64_t start, uint64_t end, int maxCount, std::vector<Event>& events) {
+        std::lock_guard<std::mutex> lck(mtx);
+        events.clear();
+        if (!_open) { return; }
+
+        uint64_t first = findEvent(start);
+        uint64_t last = findEvent(end);
+        for (uint64_t i = last; i > first && events.size() < maxCount; i--) {
+            Event evt;
+            evt.time = eventTime.get<uint64_t>(i - 1);
+            evt.channel = eventChannel.get<uint32_t>(i - 1);
+            evt.type = eventType.get<uint8_t>(i - 1);
+            evt.snr = eventSnr.get<float>(i - 1);
+            events.push_back(evt);
+        }
+    }
+
+    uint64_t Database::findBucket(uint64_t time) {
+        // Id of the first bucket starting at or after the given time
+        uint64_t count = std::min<uint64_t>({ bucketTime.count(), bucketEvent.count(), bucketDuty.count() });
+        uint64_t lo = 0, hi = count;
+        while (lo < hi) {
+            uint64_t mid = lo + ((hi - lo) / 2);
+            if (bucketTime.get<uint64_t>(mid) < time) { lo = mid + 1; }
+            else { hi = mid; }
+        }
+        return lo;
+    }
+
+    uint64_t Database::findEvent(uint64_t time) {
+        // Id of the first event at or after the given time, the bucket index narrows the search
+        uint64_t count = std::min<uint64_t>({ eventTime.count(), eventChannel.count(), eventType.count(), eventSnr.count() });
+        uint64_t lo = 0, hi = count;
+        uint64_t bucket = findBucket(time);
+        if (bucket > 0) { lo = std::min<uint64_t>(bucketEvent.get<uint64_t>(bucket - 1), count); }
+        if (bucket < bucketEvent.count()) { hi = std::clamp<uint64_t>(bucketEvent.get<uint64_t>(bucket), lo, count); }
+
+        // Events of the bucket in progress aren't indexed yet
+        if (bucket >= bucketEvent.count()) { hi = count; }
+
+        while (lo < hi) {
+            uint64_t mid = lo + ((hi - lo) / 2);
+            if (eventTime.get<uint64_t>(mid) < time) { lo = mid + 1; }
+            else { hi = mid; }
+        }
+        return lo;
+    }
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <mutex>
+#include <stdint.h>
+#include <utils/mapped_file.h>
+
+#define OCCUPANCY_DB_MAGIC      0x4244434F  // "OCDB"
+#define OCCUPANCY_DB_VERSION    1
+
+// Value of a duty cycle cell for a channel that wasn't observed during the bucket
+#define OCCUPANCY_NOT_OBSERVED  0xFF
+#define OCCUPANCY_DUTY_MAX      0xFE
+
+namespace occupancy {
+    enum EventType {
+        EVENT_START,
+        EVENT_STOP
+    };
+
+    struct Event {
+        uint64_t time;      // Nanoseconds since the unix epoch
+        uint32_t channel;
+        uint8_t type;
+        float snr;          // SNR at the start, peak SNR over the activity at the stop
+    };
+
+    struct ChannelPlan {
+        double start = 0.0;
+        double interval = 1.0;
+        double width = 0.0;
+        int count = 0;
+
+        inline double frequency(int channel) const { return start + (channel * interval); }
+    };
+
+    // Array of fixed size records appended to a memory mapped file
+    class Column {
+    public:
+        bool open(std::string path, int elementSize);
+        void close();
+        bool append(const void* element);
+        void flush();
+
+        // Drops the records past the given count
+        void truncate(uint64_t count);
+
+        inline uint64_t count() const { return header ? header->count : 0; }
+        inline const uint8_t* at(uint64_t id) const { return file.data() + sizeof(Header) + (id * _elementSize); }
+
+        template <class T>
+        inline T get(uint64_t id) const { return *(const T*)at(id); }
+
+    private:
+        struct Header {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t elementSize;
+            uint32_t reserved;
+            uint64_t count;
+        };
+
+        bool grow();
+
+        mutable MappedFile file;
+        Header* header = NULL;
+        int _elementSize = 0;
+        uint64_t capacity = 0;
+    };
+
+    // Append-only columnar store of activity events and per bucket duty cycles. Events and
+    // buckets are written in time order so the time columns double as the time index, each
+    // bucket also records the id of its first event to narrow down event lookups.
+    class Database {
+    public:
+        ~Database();
+
+        // Opens or creates the database in a directory. An existing database keeps its own
+        // channel plan and bucket duration, which are returned through the arguments.
+        bool open(std::string dir, ChannelPlan& plan, double& bucketDuration);
+        void close();
+        bool isOpen();
+
+        bool addEvent(const Event& evt);
+
+        // Duty cycles are one byte per channel, 0 to OCCUPANCY_DUTY_MAX or OCCUPANCY_NOT_OBSERVED
+        bool addBucket(uint64_t time, uint64_t firstEvent, const uint8_t* duty);
+
+        uint64_t eventCount();
+        uint64_t bucketCount();
+        uint64_t firstTime();
+        uint64_t lastTime();
+
+        // Mean duty cycle of each channel in [start, end) between 0 and 1, NAN if never observed.
+        // Can take a while on long ranges, it shouldn't be called from the UI thread.
+        void queryDutyCycle(uint64_t start, uint64_t end, std::vector<float>& duty);
+
+        // Up to maxCount events in [start, end), newest first
+        void queryEvents(uint64_t start, uint64_t end, int maxCount, std::vector<Event>& events);
+
+    private:
+        uint64_t findBucket(uint64_t time);
+        uint64_t findEvent(uint64_t time);
+
+        std::mutex mtx;
+        bool _open = false;
+        uint64_t openCount = 0;
+        ChannelPlan _plan;
+
+        Column eventTime;
+        Column eventChannel;
+        Column eventType;
+        Column eventSnr;
+        Column bucketTime;
+        Column bucketEvent;
+        Column bucketDuty;
+    };
+}
@@ -2,16 +2,23 @@
 #include <module.h>
 #include <gui/gui.h>
 #include <gui/style.h>
+#include <gui/tuner.h>
 #include <signal_path/signal_path.h>
+#include <atomic>
+#include <thread>
+#include <signal_path/channel_detector.h>
 
 SDRPP_MOD_INFO{
     /* Name:            */ "scanner",
     /* Description:     */ "Frequency scanner for SDR++",
     /* Author:          */ "Ryzerth",
-    /* Version:         */ 0, 1, 0,
+    /* Version:         */ 0, 2, 0,
     /* Max instances    */ 1
 };
 
+// Fraction of the sampled bandwidth that isn't attenuated by the anti-aliasing filters
+#define SCANNER_USABLE_BANDWIDTH    0.9
+
 class ScannerModule : public ModuleManager::Instance {
 public:
     ScannerModule(std::string name) {
@@ -42,7 +49,7 @@ private:
     static void menuHandler(void* ctx) {
         ScannerModule* _this = (ScannerModule*)ctx;
         float menuWidth = ImGui::GetContentRegionAvail().x;
-        
+
         if (_this->running) { ImGui::BeginDisabled(); }
         ImGui::LeftLabel("Start");
         ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
@@ -57,7 +64,7 @@ private:
         ImGui::LeftLabel("Interval");
         ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
         if (ImGui::InputDouble("##interval_scanner", &_this->interval, 100.0, 100000.0, "%0.0f")) {
-            _this->interval = round(_this->interval);
+            _this->interval = std::max<double>(round(_this->interval), 1.0);
         }
         ImGui::LeftLabel("Passband Ratio (%)");
         ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
@@ -76,9 +83,53 @@ private:
         }
         if (_this->running) { ImGui::EndDisabled(); }
 
-        ImGui::LeftLabel("Level");
+        ImGui::LeftLabel("Min Level");
         ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
-        ImGui::SliderFloat("##scanner_level", &_this->level, -150.0, 0.0);
+        if (ImGui::SliderFloat("##scanner_level", &_this->level, -150.0, 0.0)) {
+            std::lock_guard<std::mutex> lck(_this->scanMtx);
+            _this->detector.setMinimumLevel(_this->level);
+        }
+
+        ImGui::LeftLabel("Threshold (dB)");
+        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+        if (ImGui::SliderFloat("##scanner_threshold", &_this->threshold, 1.0, 50.0)) {
+            std::lock_guard<std::mutex> lck(_this->scanMtx);
+            _this->detector.setThreshold(_this->threshold, _this->hysteresis);
+        }
+
+        ImGui::LeftLabel("Hysteresis (dB)");
+        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+        if (ImGui::SliderFloat("##scanner_hysteresis", &_this->hysteresis, 0.0, 20.0)) {
+            std::lock_guard<std::mutex> lck(_this->scanMtx);
+            _this->detector.setThreshold(_this->threshold, _this->hysteresis);
+        }
+
+        // Priority channels
+        ImGui::LeftLabel("Priority");
+        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX() - 50.0f * style::uiScale);
+        ImGui::InputDouble("##scanner_prio_freq", &_this->newPriority, 100.0, 100000.0, "%0.0f");
+        ImGui::SameLine();
+        if (ImGui::Button("Add##scanner_prio_add", ImVec2(ImGui::GetContentRegionAvail().x, 0))) {
+            std::lock_guard<std::mutex> lck(_this->scanMtx);
+            if (std::find(_this->priorities.begin(), _this->priorities.end(), round(_this->newPriority)) == _this->priorities.end()) {
+                _this->priorities.push_back(round(_this->newPriority));
+            }
+        }
+        if (!_this->priorities.empty() && ImGui::BeginTable(("scanner_prio_table" + _this->name).c_str(), 2, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+            int removeId = -1;
+            for (int i = 0; i < _this->priorities.size(); i++) {
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                ImGui::Text("%.0lf Hz", _this->priorities[i]);
+                ImGui::TableSetColumnIndex(1);
+                if (ImGui::SmallButton(("Remove##scanner_prio_rm_" + std::to_string(i)).c_str())) { removeId = i; }
+            }
+            ImGui::EndTable();
+            if (removeId >= 0) {
+                std::lock_guard<std::mutex> lck(_this->scanMtx);
+                _this->priorities.erase(_this->priorities.begin() + removeId);
+            }
+        }
 
         ImGui::BeginTable(("scanner_bottom_btn_table" + _this->name).c_str(), 2);
         ImGui::TableNextRow();
@@ -117,12 +168,25 @@ private:
             else {
                 ImGui::TextColored(ImVec4(1, 1, 0, 1), "Status: Scanning");
             }
+            ImGui::Text("Active channels: %d", _this->activeChannels.load());
         }
     }
 
     void start() {
         if (running) { return; }
+        if (gui::waterfall.selectedVFO.empty()) { return; }
         current = startFreq;
+        receiving = false;
+        tuning = false;
+        checkCurrent = true;
+        activeChannels = 0;
+
+        // Build the channel plan
+        double vfoWidth = sigpath::vfoManager.getBandwidth(gui::waterfall.selectedVFO);
+        detector.configure(startFreq, stopFreq, interval, vfoWidth * (passbandRatio * 0.01));
+        detector.setThreshold(threshold, hysteresis);
+        detector.setMinimumLevel(level);
+
         running = true;
         workerThread = std::thread(&ScannerModule::worker, this);
     }
@@ -136,141 +200,145 @@ private:
     }
 
     void worker() {
-        // 10Hz scan loop
+        uint64_t lastFrameId = 0;
+        sigpath::spectrum.subscribe();
         while (running) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
             {
                 std::lock_guard<std::mutex> lck(scanMtx);
                 auto now = std::chrono::high_resolution_clock::now();
 
-                // Enforce tuning
                 if (gui::waterfall.selectedVFO.empty()) {
                     running = false;
-                    return;
+                    break;
                 }
-                tuner::normalTuning(gui::waterfall.selectedVFO, current);
 
-                // Check if we are waiting for a tune
+                // Only run once per spectrum frame
+                SpectrumFrameRef frame = sigpath::spectrum.getLatest();
+                if (!frame || frame->id == lastFrameId) { continue; }
+                lastFrameId = frame->id;
+
+                // Ignore frames captured before the hardware settled after a retune
                 if (tuning) {
-                    spdlog::warn("Tuning");
-                    if ((std::chrono::duration_cast<std::chrono::milliseconds>(now - lastTuneTime)).count() > tuningTime) {
-                        tuning = false;
-                    }
-                    continue;
+                    if (frame->timestamp < tuneTimestamp + ((uint64_t)tuningTime * 1000000ull)) { continue; }
+                    tuning = false;
                 }
 
-                // Get FFT data
-                int dataWidth = 0;
-                float* data = gui::waterfall.acquireLatestFFT(dataWidth);
-                if (!data) { continue; }
-
-                // Get gather waterfall data
-                double wfCenter = gui::waterfall.getViewOffset() + gui::waterfall.getCenterFrequency();
-                double wfWidth = gui::waterfall.getViewBandwidth();
-                double wfStart = wfCenter - (wfWidth / 2.0);
-                double wfEnd = wfCenter + (wfWidth / 2.0);
-
-                // Gather VFO data
-                double vfoWidth = sigpath::vfoManager.getBandwidth(gui::waterfall.selectedVFO);
+                // Evaluate every channel of the usable part of the spectrum at once
+                double margin = frame->sampleRate * (1.0 - SCANNER_USABLE_BANDWIDTH) / 2.0;
+                double spanStart = frame->startFrequency() + margin;
+                double spanEnd = frame->endFrequency() - margin;
+                activeChannels = detector.process(*frame, spanStart, spanEnd);
 
                 if (receiving) {
-                    spdlog::warn("Receiving");
-                
-                    float maxLevel = getMaxLevel(data, current, vfoWidth, dataWidth, wfStart, wfWidth);
-                    if (maxLevel >= level) {
-                        lastSignalTime = now;
-                    }
-                    else if ((std::chrono::duration_cast<std::chrono::milliseconds>(now - lastSignalTime)).count() > lingerTime) {
-                        receiving = false;
-                    }
-                }
-                else {
-                    spdlog::warn("Seeking signal");
-                    double bottomLimit = current;
-                    double topLimit = current;
-                    
-                    // Search for a signal in scan direction
-                    if (findSignal(scanUp, bottomLimit, topLimit, wfStart, wfEnd, wfWidth, vfoWidth, data, dataWidth)) {
-                        gui::waterfall.releaseLatestFFT();
+                    // A priority channel preempts the one being received
+                    double prio;
+                    if (findPriority(frame->id, prio) && prio != current) {
+                        selectChannel(prio, now);
                         continue;
                     }
-                    
-                    // Search for signal in the inverse scan direction if direction isn't enforced
-                    if (!reverseLock) {
-                        if (findSignal(!scanUp, bottomLimit, topLimit, wfStart, wfEnd, wfWidth, vfoWidth, data, dataWidth)) {
-                            gui::waterfall.releaseLatestFFT();
-                            continue;
-                        }
-                    }
-                    else { reverseLock = false; }
-                    
 
-                    // There is no signal on the visible spectrum, tune in scan direction and retry
-                    if (scanUp) {
-                        current = topLimit + interval;
-                        if (current > stopFreq) { current = startFreq; }
+                    // Keep receiving until the channel has been idle for long enough. A channel the
+                    // frame doesn't cover has a stale state and counts as idle.
+                    int curId = detector.channelId(current);
+                    if (detector[curId].lastSeen == frame->id && detector[curId].active) {
+                        lastSignalTime = now;
+                        continue;
                     }
-                    else {
-                        current = bottomLimit - interval;
-                        if (current < startFreq) { current = stopFreq; }
+                    if ((std::chrono::duration_cast<std::chrono::milliseconds>(now - lastSignalTime)).count() <= lingerTime) {
+                        continue;
                     }
+                    receiving = false;
+                }
 
-                    // If the new current frequency is outside the visible bandwidth, wait for retune
-                    if (current - (vfoWidth/2.0) < wfStart || current + (vfoWidth/2.0) > wfEnd) {
-                        lastTuneTime = now;
-                        tuning = true;
-                    }
+                // Priority channels first, then the next one in scan direction, then the other direction
+                double freq;
+                if (findPriority(frame->id, freq) || findSignal(scanUp, frame->id, freq) || (!reverseLock && findSignal(!scanUp, frame->id, freq))) {
+                    selectChannel(freq, now);
+                    continue;
                 }
+                reverseLock = false;
 
-                // Release FFT Data
-                gui::waterfall.releaseLatestFFT();
+                // Nothing in this span, move on to the next unseen one
+                nextSpan(spanStart, spanEnd, frame->centerFrequency);
             }
         }
+        sigpath::spectrum.unsubscribe();
+    }
+
+    void selectChannel(double freq, std::chrono::time_point<std::chrono::high_resolution_clock> now) {
+        current = freq;
+        receiving = true;
+        lastSignalTime = now;
+        tuner::normalTuning(gui::waterfall.selectedVFO, current);
     }
 
-    bool findSignal(bool scanDir, double& bottomLimit, double& topLimit, double wfStart, double wfEnd, double wfWidth, double vfoWidth, float* data, int dataWidth) {
-        bool found = false;
-        double freq = current;
-        for (freq += scanDir ? interval : -interval;
-            scanDir ? (freq <= stopFreq) : (freq >= startFreq);
-            freq += scanDir ? interval : -interval) {
-
-            // Check if signal is within bounds
-            if (freq - (vfoWidth/2.0) < wfStart) { break; }
-            if (freq + (vfoWidth/2.0) > wfEnd) { break; }
-
-            if (freq < bottomLimit) { bottomLimit = freq; }
-            if (freq > topLimit) { topLimit = freq; }
-            
-            // Check signal level
-            float maxLevel = getMaxLevel(data, freq, vfoWidth * (passbandRatio * 0.01f), dataWidth, wfStart, wfWidth);
-            if (maxLevel >= level) {
-                found = true;
-                receiving = true;
-                current = freq;
-                break;
+    bool findPriority(uint64_t frameId, double& freq) {
+        for (double prio : priorities) {
+            if (prio < startFreq || prio > stopFreq) { continue; }
+            int id = detector.channelId(prio);
+            if (detector[id].lastSeen == frameId && detector[id].active) {
+                freq = detector.frequency(id);
+                return true;
             }
         }
-        return found;
+        return false;
     }
 
-    float getMaxLevel(float* data, double freq, double width, int dataWidth, double wfStart, double wfWidth) {
-        double low = freq - (width/2.0);
-        double high = freq + (width/2.0);
-        int lowId = std::clamp<int>((low - wfStart) * (double)dataWidth / wfWidth, 0, dataWidth - 1);
-        int highId = std::clamp<int>((high - wfStart) * (double)dataWidth / wfWidth, 0, dataWidth - 1);
-        float max = -INFINITY;
-        for (int i = lowId; i <= highId; i++) {
-            if (data[i] > max) { max = data[i]; }
+    bool findSignal(bool scanDir, uint64_t frameId, double& freq) {
+        int count = detector.channelCount();
+        int id = detector.channelId(current);
+        if (!checkCurrent) { id += scanDir ? 1 : -1; }
+        checkCurrent = false;
+        for (; id >= 0 && id < count; id += scanDir ? 1 : -1) {
+            // Stop at the edge of the channels covered by the current frame
+            if (detector[id].lastSeen != frameId) { break; }
+            if (detector[id].active) {
+                freq = detector.frequency(id);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void nextSpan(double spanStart, double spanEnd, double center) {
+        double usable = spanEnd - spanStart;
+        double halfWidth = detector.width() / 2.0;
+
+        // If the whole range fits in a single span, just make sure it's covered
+        if ((stopFreq - startFreq) + detector.width() <= usable) {
+            double rangeCenter = (startFreq + stopFreq) / 2.0;
+            if (spanStart <= startFreq - halfWidth && spanEnd >= stopFreq + halfWidth) { return; }
+            retune(rangeCenter);
+            return;
+        }
+
+        // Start the next span right after the last channel covered by this one
+        int first, last;
+        detector.coveredRange(spanStart, spanEnd, first, last);
+        double next;
+        if (scanUp) {
+            next = (last < first || last + 1 >= detector.channelCount()) ? startFreq : detector.frequency(last + 1);
+            retune(next - halfWidth + (usable / 2.0));
+        }
+        else {
+            next = (last < first || first <= 0) ? stopFreq : detector.frequency(first - 1);
+            retune(next + halfWidth - (usable / 2.0));
         }
-        return max;
+        current = next;
+        checkCurrent = true;
+    }
+
+    void retune(double center) {
+        tuner::centerTuning(gui::waterfall.selectedVFO, center);
+        tuneTimestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        tuning = true;
     }
 
     std::string name;
     bool enabled = true;
-    
+
     bool running = false;
-    //std::string selectedVFO = "Radio";
     double startFreq = 88000000.0;
     double stopFreq = 108000000.0;
     double interval = 100000.0;
@@ -279,12 +347,19 @@ private:
     int tuningTime = 250;
     int lingerTime = 1000.0;
     float level = -50.0;
+    float threshold = 10.0;
+    float hysteresis = 3.0;
     bool receiving = true;
     bool tuning = false;
     bool scanUp = true;
     bool reverseLock = false;
+    bool checkCurrent = true;
+    std::vector<double> priorities;
+    double newPriority = 0.0;
+    ChannelDetector detector;
+    std::atomic<int> activeChannels = 0;
+    uint64_t tuneTimestamp = 0;
     std::chrono::time_point<std::chrono::high_resolution_clock> lastSignalTime;
-    std::chrono::time_point<std::chrono::high_resolution_clock> lastTuneTime;
     std::thread workerThread;
     std::mutex scanMtx;
 };
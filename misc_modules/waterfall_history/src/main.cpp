@@ -0,0 +1,404 @@
+#include <imgui.h>
+#include <module.h>
+#include <gui/gui.h>
+#include <gui/style.h>
+#include <gui/tuner.h>
+#include <gui/widgets/image.h>
+#include <gui/widgets/file_select.h>
+#include <gui/widgets/folder_select.h>
+#include <signal_path/signal_path.h>
+#include <utils/spectrum_history.h>
+#include <utils/freq_formatting.h>
+#include <config.h>
+#include <core.h>
+#include <atomic>
+#include <thread>
+#include <list>
+#include <time.h>
+
+SDRPP_MOD_INFO{
+    /* Name:            */ "waterfall_history",
+    /* Description:     */ "Waterfall history recorder and viewer for SDR++",
+    /* Author:          */ "Ryzerth",
+    /* Version:         */ 0, 1, 0,
+    /* Max instances    */ 1
+};
+
+#define HISTORY_VIEW_WIDTH      512
+#define HISTORY_VIEW_HEIGHT     256
+
+// Number of decoded chunks kept around, decimated to the view width
+#define HISTORY_CACHE_SIZE      64
+
+// Chunks decoded per frame at most, the rest of the view is filled in over the next frames
+#define HISTORY_MAX_DECODES     4
+
+ConfigManager config;
+
+const int lineRates[] = { 0, 20, 10, 5, 1 };
+const char* lineRatesTxt = "Every frame\0" "20 lines/s\0" "10 lines/s\0" "5 lines/s\0" "1 line/s\0";
+
+const double rowDurations[] = { 0.05, 0.1, 0.5, 1.0, 5.0, 30.0 };
+const char* rowDurationsTxt = "50ms/line\0" "100ms/line\0" "500ms/line\0" "1s/line\0" "5s/line\0" "30s/line\0";
+
+class WaterfallHistoryModule : public ModuleManager::Instance {
+public:
+    WaterfallHistoryModule(std::string name) : folderSelect("%ROOT%/recordings"), fileSelect("", { "Spectrum History (*.sphf)", "*.sphf", "All Files", "*" }), img(HISTORY_VIEW_WIDTH, HISTORY_VIEW_HEIGHT) {
+        this->name = name;
+
+        // Load config
+        config.acquire();
+        if (config.conf.contains("recPath")) {
+            folderSelect.setPath(config.conf["recPath"]);
+        }
+        bits16 = config.conf["bits16"];
+        lineRateId = std::clamp<int>(config.conf["lineRate"], 0, (sizeof(lineRates) / sizeof(lineRates[0])) - 1);
+        rowDurationId = std::clamp<int>(config.conf["rowDuration"], 0, (sizeof(rowDurations) / sizeof(rowDurations[0])) - 1);
+        follow = config.conf["follow"];
+        config.release();
+
+        gui::menu.registerEntry(name, menuHandler, this, NULL);
+    }
+
+    ~WaterfallHistoryModule() {
+        gui::menu.removeEntry(name);
+        stopRecording();
+    }
+
+    void postInit() {}
+
+    void enable() {
+        enabled = true;
+    }
+
+    void disable() {
+        enabled = false;
+    }
+
+    bool isEnabled() {
+        return enabled;
+    }
+
+private:
+    struct CachedChunk {
+        int id;
+        spectrum_history::ChunkHeader header;
+        std::vector<uint64_t> timestamps;
+        std::vector<float> lines;   // Lines decimated to HISTORY_VIEW_WIDTH
+    };
+
+    struct RowInfo {
+        bool valid;
+        uint64_t timestamp;
+        double centerFrequency;
+        double sampleRate;
+    };
+
+    static void menuHandler(void* ctx) {
+        WaterfallHistoryModule* _this = (WaterfallHistoryModule*)ctx;
+        float menuWidth = ImGui::GetContentRegionAvail().x;
+
+        // Recording
+        if (_this->recording) { style::beginDisabled(); }
+        if (_this->folderSelect.render("##_wfhist_rec_path_" + _this->name) && _this->folderSelect.pathIsValid()) {
+            config.acquire();
+            config.conf["recPath"] = _this->folderSelect.path;
+            config.release(true);
+        }
+        ImGui::LeftLabel("Line Rate");
+        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+        if (ImGui::Combo(("##_wfhist_line_rate_" + _this->name).c_str(), &_this->lineRateId, lineRatesTxt)) {
+            config.acquire();
+            config.conf["lineRate"] = _this->lineRateId;
+            config.release(true);
+        }
+        if (ImGui::Checkbox(("16 bit precision##_wfhist_16bit_" + _this->name).c_str(), &_this->bits16)) {
+            config.acquire();
+            config.conf["bits16"] = _this->bits16;
+            config.release(true);
+        }
+        if (_this->recording) { style::endDisabled(); }
+
+        if (!_this->recording) {
+            if (!_this->folderSelect.pathIsValid()) { style::beginDisabled(); }
+            if (ImGui::Button(("Record##_wfhist_rec_" + _this->name).c_str(), ImVec2(menuWidth, 0))) {
+                _this->startRecording();
+            }
+            if (!_this->folderSelect.pathIsValid()) { style::endDisabled(); }
+            ImGui::TextUnformatted("Idle --:--:--");
+        }
+        else {
+            if (ImGui::Button(("Stop##_wfhist_rec_" + _this->name).c_str(), ImVec2(menuWidth, 0))) {
+                _this->stopRecording();
+            }
+            uint64_t seconds = _this->recordedLines ? (_this->lastLineTime - _this->firstLineTime) / 1000000000ull : 0;
+            ImGui::TextColored(ImVec4(1.0f, 0.1f, 0.1f, 1.0f), "Recording %02d:%02d:%02d", (int)(seconds / 3600), (int)((seconds / 60) % 60), (int)(seconds % 60));
+        }
+
+        // Viewer
+        ImGui::Separator();
+        if (_this->fileSelect.render("##_wfhist_view_path_" + _this->name) && _this->fileSelect.pathIsValid()) {
+            _this->openHistory(_this->fileSelect.path);
+        }
+        if (!_this->reader.isOpen()) { return; }
+
+        // Pick up chunks written since the last refresh, cheap since only new headers are read
+        auto now = std::chrono::high_resolution_clock::now();
+        if (std::chrono::duration_cast<std::chrono::milliseconds>(now - _this->lastRefresh).count() >= 1000) {
+            _this->lastRefresh = now;
+            int lastCount = _this->reader.chunkCount();
+            _this->reader.refresh();
+            if (_this->follow && _this->reader.chunkCount() != lastCount) {
+                _this->viewEnd = _this->reader.lastTimestamp();
+                _this->redraw = true;
+            }
+        }
+
+        ImGui::LeftLabel("Zoom");
+        ImGui::SetNextItemWidth(menuWidth - ImGui::GetCursorPosX());
+        if (ImGui::Combo(("##_wfhist_zoom_" + _this->name).c_str(), &_this->rowDurationId, rowDurationsTxt)) {
+            _this->redraw = true;
+            config.acquire();
+            config.conf["rowDuration"] = _this->rowDurationId;
+            config.release(true);
+        }
+        if (ImGui::Checkbox(("Follow##_wfhist_follow_" + _this->name).c_str(), &_this->follow)) {
+            if (_this->follow) {
+                _this->viewEnd = _this->reader.lastTimestamp();
+                _this->redraw = true;
+            }
+            config.acquire();
+            config.conf["follow"] = _this->follow;
+            config.release(true);
+        }
+
+        // Position within the file
+        uint64_t first = _this->reader.firstTimestamp();
+        uint64_t last = _this->reader.lastTimestamp();
+        float pos = (last > first) ? (double)(_this->viewEnd - first) / (double)(last - first) : 1.0f;
+        ImGui::SetNextItemWidth(menuWidth);
+        if (ImGui::SliderFloat(("##_wfhist_pos_" + _this->name).c_str(), &pos, 0.0f, 1.0f, formatTime(_this->viewEnd).c_str())) {
+            _this->viewEnd = first + (uint64_t)(pos * (double)(last - first));
+            _this->follow = false;
+            _this->redraw = true;
+        }
+
+        if (_this->redraw) {
+            _this->redraw = false;
+            _this->render();
+        }
+        ImGui::SetNextItemWidth(menuWidth);
+        _this->img.draw();
+
+        // Scroll through time with the mouse wheel, show the time and frequency under the cursor
+        if (ImGui::IsItemHovered()) {
+            float wheel = ImGui::GetIO().MouseWheel;
+            if (wheel != 0.0f) {
+                int64_t delta = wheel * 16.0 * rowDurations[_this->rowDurationId] * 1e9;
+                _this->viewEnd = std::clamp<int64_t>((int64_t)_this->viewEnd + delta, first, last);
+                _this->follow = false;
+                _this->redraw = true;
+            }
+
+            ImVec2 rel = ImVec2(ImGui::GetMousePos().x - ImGui::GetItemRectMin().x, ImGui::GetMousePos().y - ImGui::GetItemRectMin().y);
+            int row = std::clamp<int>((rel.y / ImGui::GetItemRectSize().y) * HISTORY_VIEW_HEIGHT, 0, HISTORY_VIEW_HEIGHT - 1);
+            RowInfo& info = _this->rows[row];
+            if (info.valid) {
+                double freq = info.centerFrequency + (((rel.x / ImGui::GetItemRectSize().x) - 0.5) * info.sampleRate);
+                ImGui::BeginTooltip();
+                ImGui::Text("%s", formatTime(info.timestamp).c_str());
+                ImGui::Text("%s", utils::formatFreq(freq).c_str());
+                ImGui::EndTooltip();
+                if (ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left) && !gui::waterfall.selectedVFO.empty()) {
+                    tuner::tune(tuner::TUNER_MODE_NORMAL, gui::waterfall.selectedVFO, freq);
+                }
+            }
+        }
+    }
+
+    static std::string formatTime(uint64_t time) {
+        time_t t = time / 1000000000ull;
+        char buf[64];
+        strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", localtime(&t));
+        return buf;
+    }
+
+    void startRecording() {
+        if (recording) { return; }
+        time_t now = time(NULL);
+        char fileName[64];
+        strftime(fileName, sizeof(fileName), "/waterfall_%Y%m%d_%H%M%S.sphf", localtime(&now));
+        std::string path = folderSelect.expandString(folderSelect.path + fileName);
+        if (!writer.open(path, bits16 ? 16 : 8)) { return; }
+        spdlog::info("Recording waterfall history to '{0}'", path);
+
+        recordedLines = 0;
+        recording = true;
+        workerThread = std::thread(&WaterfallHistoryModule::worker, this);
+    }
+
+    void stopRecording() {
+        if (!recording) { return; }
+        recording = false;
+        if (workerThread.joinable()) { workerThread.join(); }
+        writer.close();
+    }
+
+    void worker() {
+        uint64_t lastFrameId = 0;
+        sigpath::spectrum.subscribe();
+        while (recording) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+            SpectrumFrameRef frame = sigpath::spectrum.getLatest();
+            if (!frame || frame->id == lastFrameId) { continue; }
+            lastFrameId = frame->id;
+
+            // Limit the line rate, there's rarely a point in keeping every frame over hours
+            int rate = lineRates[lineRateId];
+            if (rate && recordedLines && frame->timestamp < lastLineTime + (1000000000ull / rate)) { continue; }
+
+            writer.write(frame->data.data(), frame->size(), frame->centerFrequency, frame->sampleRate, frame->timestamp);
+            if (!recordedLines) { firstLineTime = frame->timestamp; }
+            lastLineTime = frame->timestamp;
+            recordedLines++;
+        }
+        sigpath::spectrum.unsubscribe();
+    }
+
+    void openHistory(std::string path) {
+        cache.clear();
+        if (!reader.open(path)) { return; }
+        viewEnd = reader.lastTimestamp();
+        redraw = true;
+    }
+
+    // Returns the chunk from the cache, decoding it only if there's decode budget left.
+    // Sets pending instead when a chunk had to be skipped for lack of budget.
+    CachedChunk* getChunk(int id, int& budget, bool& pending) {
+        // Move cache hits to the front so that the least recently used chunk is evicted first
+        for (auto it = cache.begin(); it != cache.end(); it++) {
+            if (it->id != id) { continue; }
+            cache.splice(cache.begin(), cache, it);
+            return &cache.front();
+        }
+
+        if (budget <= 0) {
+            pending = true;
+            return NULL;
+        }
+        budget--;
+        if (!reader.readChunk(id, decoded)) { return NULL; }
+        if (cache.size() >= HISTORY_CACHE_SIZE) { cache.pop_back(); }
+        cache.emplace_front();
+        CachedChunk& chunk = cache.front();
+        chunk.id = id;
+        chunk.header = decoded.header;
+        chunk.timestamps = decoded.timestamps;
+
+        // Decimate the lines to the view width keeping the peak of each column
+        int size = decoded.header.fftSize;
+        chunk.lines.resize(decoded.header.lineCount * HISTORY_VIEW_WIDTH);
+        for (int i = 0; i < decoded.header.lineCount; i++) {
+            const float* line = decoded.line(i);
+            float* out = &chunk.lines[i * HISTORY_VIEW_WIDTH];
+            for (int j = 0; j < HISTORY_VIEW_WIDTH; j++) {
+                int start = ((int64_t)j * size) / HISTORY_VIEW_WIDTH;
+                int end = std::max<int>(((int64_t)(j + 1) * size) / HISTORY_VIEW_WIDTH, start + 1);
+                float max = -INFINITY;
+                for (int k = start; k < end && k < size; k++) { max = std::max<float>(max, line[k]); }
+                out[j] = max;
+            }
+        }
+        return &chunk;
+    }
+
+    void render() {
+        uint32_t* fb = (uint32_t*)img.buffer;
+        uint64_t rowDuration = rowDurations[rowDurationId] * 1e9;
+        uint64_t first = reader.firstTimestamp();
+        int budget = HISTORY_MAX_DECODES;
+        bool pending = false;
+
+        for (int i = 0; i < HISTORY_VIEW_HEIGHT; i++) {
+            uint32_t* row = &fb[i * HISTORY_VIEW_WIDTH];
+            rows[i].valid = false;
+
+            // Rows before the start of the file or in a gap of the recording stay black
+            uint64_t offset = (uint64_t)i * rowDuration;
+            int id = (viewEnd >= offset) ? reader.findChunk(viewEnd - offset) : -1;
+            CachedChunk* chunk = (id >= 0 && viewEnd - offset >= first) ? getChunk(id, budget, pending) : NULL;
+            uint64_t ts = viewEnd - offset;
+            if (!chunk || ts + rowDuration < chunk->header.firstTimestamp || ts > chunk->header.lastTimestamp + rowDuration) {
+                for (int j = 0; j < HISTORY_VIEW_WIDTH; j++) { row[j] = (uint32_t)255 << 24; }
+                continue;
+            }
+
+            auto it = std::lower_bound(chunk->timestamps.begin(), chunk->timestamps.end(), ts);
+            int line = std::min<int>(it - chunk->timestamps.begin(), chunk->timestamps.size() - 1);
+            gui::waterfall.levelsToColors(&chunk->lines[line * HISTORY_VIEW_WIDTH], row, HISTORY_VIEW_WIDTH);
+
+            rows[i].valid = true;
+            rows[i].timestamp = chunk->timestamps[line];
+            rows[i].centerFrequency = chunk->header.centerFrequency;
+            rows[i].sampleRate = chunk->header.sampleRate;
+        }
+
+        img.swap();
+
+        // Decoding a whole view at once would stall the UI, finish it on the next frames
+        if (pending) { redraw = true; }
+    }
+
+    std::string name;
+    bool enabled = true;
+
+    // Recording
+    FolderSelect folderSelect;
+    spectrum_history::Writer writer;
+    std::atomic<bool> recording = false;
+    std::thread workerThread;
+    bool bits16 = false;
+    int lineRateId = 2;
+    uint64_t recordedLines = 0;
+    uint64_t firstLineTime = 0;
+    uint64_t lastLineTime = 0;
+
+    // Viewer
+    FileSelect fileSelect;
+    spectrum_history::Reader reader;
+    spectrum_history::Chunk decoded;
+    std::list<CachedChunk> cache;
+    ImGui::ImageDisplay img;
+    RowInfo rows[HISTORY_VIEW_HEIGHT];
+    uint64_t viewEnd = 0;
+    int rowDurationId = 1;
+    bool follow = true;
+    bool redraw = false;
+    std::chrono::time_point<std::chrono::high_resolution_clock> lastRefresh;
+};
+
+MOD_EXPORT void _INIT_() {
+    json def = json({});
+    def["recPath"] = "%ROOT%/recordings";
+    def["bits16"] = false;
+    def["lineRate"] = 2;
+    def["rowDuration"] = 1;
+    def["follow"] = true;
+    config.setPath(core::args["root"].s() + "/waterfall_history_config.json");
+    config.load(def);
+    config.enableAutoSave();
+}
+
+MOD_EXPORT ModuleManager::Instance* _CREATE_INSTANCE_(std::string name) {
+    return new WaterfallHistoryModule(name);
+}
+
+MOD_EXPORT void _DELETE_INSTANCE_(void* instance) {
+    delete (WaterfallHistoryModule*)instance;
+}
+
+MOD_EXPORT void _END_() {
+    config.disableAutoSave();
+    config.save();
+}
@@ -166,6 +166,13 @@ private:
         opts.flags = RTAUDIO_MINIMIZE_LATENCY;
         opts.streamName = _streamName;
 
+        // Let the audio callback and the packer feeding it preempt the rest of the DSP if enabled
+        core::configManager.acquire();
+        bool realtime = core::configManager.conf["threading"]["realtimeAudio"];
+        core::configManager.release();
+        if (realtime) { opts.flags |= RTAUDIO_SCHEDULE_REALTIME; }
+        stereoPacker.setThreadOptions("audio_packer", {}, realtime ? threading::PRIORITY_HIGH : threading::PRIORITY_NORMAL);
+
         try {
             audio.openStream(&parameters, NULL, RTAUDIO_FLOAT32, sampleRate, &bufferFrames, &callback, this, &opts);
             stereoPacker.setSampleCount(bufferFrames);
@@ -43,7 +43,49 @@ public:
         handler.tuneHandler = tune;
         handler.stream = &stream;
 
+        sigpath::sourceManager.registerSource("Airspy", &handler);
+    }
+
+    ~AirspySourceModule() {
+        if (enumThread.joinable()) { enumThread.join(); }
+        stop(this);
+        sigpath::sourceManager.unregisterSource("Airspy");
+        airspy_exit();
+    }
+
+    void postInit() {
+#ifndef __ANDROID__
+        // Looking for devices can take a while, so it's done on a worker into separate lists
+        // that the GUI thread swaps in once they're ready
+        enumThread = std::thread([this]() {
+            std::vector<uint64_t> list;
+            std::string txt;
+            listDevices(list, txt);
+            std::lock_guard<std::mutex> lck(enumMtx);
+            enumList = std::move(list);
+            enumListTxt = std::move(txt);
+            enumDone = true;
+        });
+#else
         refresh();
+        selectConfigDevice();
+#endif
+    }
+
+    // Swaps in the devices found after post-init. Only called from the GUI thread
+    void applyEnumeration(bool wait = false) {
+        if (wait && enumThread.joinable()) { enumThread.join(); }
+        {
+            std::lock_guard<std::mutex> lck(enumMtx);
+            if (!enumDone) { return; }
+            enumDone = false;
+            devList = std::move(enumList);
+            devListTxt = std::move(enumListTxt);
+        }
+        selectConfigDevice();
+    }
+
+    void selectConfigDevice() {
         if (sampleRateList.size() > 0) {
             sampleRate = sampleRateList[0];
         }
@@ -54,17 +96,10 @@ public:
         config.release();
         selectByString(devSerial);
 
-        sigpath::sourceManager.registerSource("Airspy", &handler);
-    }
-
-    ~AirspySourceModule() {
-        stop(this);
-        sigpath::sourceManager.unregisterSource("Airspy");
-        airspy_exit();
+        // Apply the device's samplerate if the source got selected in the meantime
+        if (selected) { core::setInputSampleRate(sampleRate); }
     }
 
-    void postInit() {}
-
     void enable() {
         enabled = true;
     }
@@ -78,9 +113,13 @@ public:
     }
 
     void refresh() {
+        listDevices(devList, devListTxt);
+    }
+
+    void listDevices(std::vector<uint64_t>& list, std::string& listTxt) {
 #ifndef __ANDROID__
-        devList.clear();
-        devListTxt = "";
+        list.clear();
+        listTxt = "";
 
         uint64_t serials[256];
         int n = airspy_list_devices(serials, 256);
@@ -88,9 +127,9 @@ public:
         char buf[1024];
         for (int i = 0; i < n; i++) {
             sprintf(buf, "%016" PRIX64, serials[i]);
-            devList.push_back(serials[i]);
-            devListTxt += buf;
-            devListTxt += '\0';
+            list.push_back(serials[i]);
+            listTxt += buf;
+            listTxt += '\0';
         }
 #else
         // Check for device presence
@@ -100,9 +139,9 @@ public:
 
         // Get device info
         std::string fakeName = "Airspy USB";
-        devList.push_back(0xDEADBEEF);
-        devListTxt += fakeName;
-        devListTxt += '\0';
+        list.push_back(0xDEADBEEF);
+        listTxt += fakeName;
+        listTxt += '\0';
 #endif
     }
 
@@ -248,18 +287,22 @@ private:
 
     static void menuSelected(void* ctx) {
         AirspySourceModule* _this = (AirspySourceModule*)ctx;
+        _this->selected = true;
+        _this->applyEnumeration();
         core::setInputSampleRate(_this->sampleRate);
         spdlog::info("AirspySourceModule '{0}': Menu Select!", _this->name);
     }
 
     static void menuDeselected(void* ctx) {
         AirspySourceModule* _this = (AirspySourceModule*)ctx;
+        _this->selected = false;
         spdlog::info("AirspySourceModule '{0}': Menu Deselect!", _this->name);
     }
 
     static void start(void* ctx) {
         AirspySourceModule* _this = (AirspySourceModule*)ctx;
         if (_this->running) { return; }
+        _this->applyEnumeration(true);
         if (_this->selectedSerial == 0) {
             spdlog::error("Tried to start Airspy source with null serial");
             return;
@@ -337,6 +380,7 @@ private:
 
     static void menuHandler(void* ctx) {
         AirspySourceModule* _this = (AirspySourceModule*)ctx;
+        _this->applyEnumeration();
 
         if (_this->running) { SmGui::BeginDisabled(); }
 
@@ -572,6 +616,7 @@ private:
     std::string name;
     airspy_device* openDev;
     bool enabled = true;
+    bool selected = false;
     dsp::stream<dsp::complex_t> stream;
     double sampleRate;
     SourceManager::SourceHandler handler;
@@ -601,6 +646,14 @@ private:
 
     std::vector<uint64_t> devList;
     std::string devListTxt;
+
+    // Results of the device enumeration started by post-init
+    std::thread enumThread;
+    std::mutex enumMtx;
+    bool enumDone = false;
+    std::vector<uint64_t> enumList;
+    std::string enumListTxt;
+
     std::vector<uint32_t> sampleRateList;
     std::string sampleRateListTxt;
 };
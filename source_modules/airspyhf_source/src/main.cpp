@@ -43,22 +43,56 @@ public:
         handler.tuneHandler = tune;
         handler.stream = &stream;
 
-        refresh();
-
-        config.acquire();
-        std::string devSerial = config.conf["device"];
-        config.release();
-        selectByString(devSerial);
-
         sigpath::sourceManager.registerSource("Airspy HF+", &handler);
     }
 
     ~AirspyHFSourceModule() {
+        if (enumThread.joinable()) { enumThread.join(); }
         stop(this);
         sigpath::sourceManager.unregisterSource("Airspy HF+");
     }
 
-    void postInit() {}
+    void postInit() {
+#ifndef __ANDROID__
+        // Looking for devices can take a while, so it's done on a worker into separate lists
+        // that the GUI thread swaps in once they're ready
+        enumThread = std::thread([this]() {
+            std::vector<uint64_t> list;
+            std::string txt;
+            listDevices(list, txt);
+            std::lock_guard<std::mutex> lck(enumMtx);
+            enumList = std::move(list);
+            enumListTxt = std::move(txt);
+            enumDone = true;
+        });
+#else
+        refresh();
+        selectConfigDevice();
+#endif
+    }
+
+    // Swaps in the devices found after post-init. Only called from the GUI thread
+    void applyEnumeration(bool wait = false) {
+        if (wait && enumThread.joinable()) { enumThread.join(); }
+        {
+            std::lock_guard<std::mutex> lck(enumMtx);
+            if (!enumDone) { return; }
+            enumDone = false;
+            devList = std::move(enumList);
+            devListTxt = std::move(enumListTxt);
+        }
+        selectConfigDevice();
+    }
+
+    void selectConfigDevice() {
+        config.acquire();
+        std::string devSerial = config.conf["device"];
+        config.release();
+        selectByString(devSerial);
+
+        // Apply the device's samplerate if the source got selected in the meantime
+        if (selected) { core::setInputSampleRate(sampleRate); }
+    }
 
     enum AGCMode {
         AGC_MODE_OFF,
@@ -79,8 +113,12 @@ public:
     }
 
     void refresh() {
-        devList.clear();
-        devListTxt = "";
+        listDevices(devList, devListTxt);
+    }
+
+    void listDevices(std::vector<uint64_t>& list, std::string& listTxt) {
+        list.clear();
+        listTxt = "";
 
 #ifndef __ANDROID__
         uint64_t serials[256];
@@ -89,9 +127,9 @@ public:
         char buf[1024];
         for (int i = 0; i < n; i++) {
             sprintf(buf, "%016" PRIX64, serials[i]);
-            devList.push_back(serials[i]);
-            devListTxt += buf;
-            devListTxt += '\0';
+            list.push_back(serials[i]);
+            listTxt += buf;
+            listTxt += '\0';
         }
 #else
         // Check for device presence
@@ -101,9 +139,9 @@ public:
 
         // Get device info
         std::string fakeName = "Airspy HF+ USB";
-        devList.push_back(0xDEADBEEF);
-        devListTxt += fakeName;
-        devListTxt += '\0';
+        list.push_back(0xDEADBEEF);
+        listTxt += fakeName;
+        listTxt += '\0';
 #endif
     }
 
@@ -226,18 +264,22 @@ private:
 
     static void menuSelected(void* ctx) {
         AirspyHFSourceModule* _this = (AirspyHFSourceModule*)ctx;
+        _this->selected = true;
+        _this->applyEnumeration();
         core::setInputSampleRate(_this->sampleRate);
         spdlog::info("AirspyHFSourceModule '{0}': Menu Select!", _this->name);
     }
 
     static void menuDeselected(void* ctx) {
         AirspyHFSourceModule* _this = (AirspyHFSourceModule*)ctx;
+        _this->selected = false;
         spdlog::info("AirspyHFSourceModule '{0}': Menu Deselect!", _this->name);
     }
 
     static void start(void* ctx) {
         AirspyHFSourceModule* _this = (AirspyHFSourceModule*)ctx;
         if (_this->running) { return; }
+        _this->applyEnumeration(true);
         if (_this->selectedSerial == 0) {
             spdlog::error("Tried to start AirspyHF+ source with null serial");
             return;
@@ -291,6 +333,7 @@ private:
 
     static void menuHandler(void* ctx) {
         AirspyHFSourceModule* _this = (AirspyHFSourceModule*)ctx;
+        _this->applyEnumeration();
 
         if (_this->running) { SmGui::BeginDisabled(); }
 
@@ -381,6 +424,7 @@ private:
     std::string name;
     airspyhf_device_t* openDev;
     bool enabled = true;
+    bool selected = false;
     dsp::stream<dsp::complex_t> stream;
     double sampleRate;
     SourceManager::SourceHandler handler;
@@ -400,6 +444,14 @@ private:
 
     std::vector<uint64_t> devList;
     std::string devListTxt;
+
+    // Results of the device enumeration started by post-init
+    std::thread enumThread;
+    std::mutex enumMtx;
+    bool enumDone = false;
+    std::vector<uint64_t> enumList;
+    std::string enumListTxt;
+
     std::vector<uint32_t> sampleRateList;
     std::string sampleRateListTxt;
 };
@@ -10,6 +10,8 @@
 #include <libbladeRF.h>
 #include <gui/smgui.h>
 #include <algorithm>
+#include <thread>
+#include <mutex>
 
 #define CONCAT(a, b) ((std::string(a) + b).c_str())
 
@@ -48,23 +50,50 @@ public:
         handler.tuneHandler = tune;
         handler.stream = &stream;
 
-        refresh();
-
-        // Select device here
-        config.acquire();
-        std::string serial = config.conf["device"];
-        config.release();
-        selectBySerial(serial);
-
         sigpath::sourceManager.registerSource("BladeRF", &handler);
     }
 
     ~BladeRFSourceModule() {
+        if (enumThread.joinable()) { enumThread.join(); }
+        if (enumInfoList != NULL) { bladerf_free_device_list(enumInfoList); }
         stop(this);
         sigpath::sourceManager.unregisterSource("BladeRF");
     }
 
-    void postInit() {}
+    void postInit() {
+        // Looking for devices can take a while, so it's done on a worker into a separate list
+        // that the GUI thread swaps in once it's ready
+        enumThread = std::thread([this]() {
+            bladerf_devinfo* list = NULL;
+            std::string txt;
+            int count = listDevices(&list, txt);
+            std::lock_guard<std::mutex> lck(enumMtx);
+            enumInfoList = list;
+            enumListTxt = std::move(txt);
+            enumCount = count;
+            enumDone = true;
+        });
+    }
+
+    // Swaps in the devices found after post-init and selects the configured one. Only called from the GUI thread
+    void applyEnumeration(bool wait = false) {
+        if (wait && enumThread.joinable()) { enumThread.join(); }
+        {
+            std::lock_guard<std::mutex> lck(enumMtx);
+            if (!enumDone) { return; }
+            enumDone = false;
+            if (devInfoList != NULL) { bladerf_free_device_list(devInfoList); }
+            devInfoList = enumInfoList;
+            enumInfoList = NULL;
+            devListTxt = std::move(enumListTxt);
+            devCount = enumCount;
+        }
+
+        config.acquire();
+        std::string serial = config.conf["device"];
+        config.release();
+        selectBySerial(serial);
+    }
 
     void enable() {
         enabled = true;
@@ -79,22 +108,28 @@ public:
     }
 
     void refresh() {
-        devListTxt = "";
-
         if (devInfoList != NULL) {
             bladerf_free_device_list(devInfoList);
+            devInfoList = NULL;
         }
+        devCount = listDevices(&devInfoList, devListTxt);
+    }
 
-        devCount = bladerf_get_device_list(&devInfoList);
-        if (devCount < 0) {
-            spdlog::error("Could not list devices {0}", devCount);
-            return;
+    int listDevices(bladerf_devinfo** list, std::string& listTxt) {
+        listTxt = "";
+
+        int count = bladerf_get_device_list(list);
+        if (count < 0) {
+            spdlog::error("Could not list devices {0}", count);
+            *list = NULL;
+            return count;
         }
-        for (int i = 0; i < devCount; i++) {
+        for (int i = 0; i < count; i++) {
             // Keep only the first 32 character of the serial number for display
-            devListTxt += std::string(devInfoList[i].serial).substr(0, 16);
-            devListTxt += '\0';
+            listTxt += std::string((*list)[i].serial).substr(0, 16);
+            listTxt += '\0';
         }
+        return count;
     }
 
     void selectFirst() {
@@ -335,6 +370,7 @@ private:
 
     static void menuSelected(void* ctx) {
         BladeRFSourceModule* _this = (BladeRFSourceModule*)ctx;
+        _this->applyEnumeration();
         core::setInputSampleRate(_this->sampleRate);
         spdlog::info("BladeRFSourceModule '{0}': Menu Select!", _this->name);
     }
@@ -347,6 +383,7 @@ private:
     static void start(void* ctx) {
         BladeRFSourceModule* _this = (BladeRFSourceModule*)ctx;
         if (_this->running) { return; }
+        _this->applyEnumeration(true);
         if (_this->devCount == 0) { return; }
 
         // Open device
@@ -425,6 +462,7 @@ private:
 
     static void menuHandler(void* ctx) {
         BladeRFSourceModule* _this = (BladeRFSourceModule*)ctx;
+        _this->applyEnumeration();
 
         if (_this->running) { SmGui::BeginDisabled(); }
 
@@ -594,6 +632,14 @@ private:
     bladerf_devinfo* devInfoList = NULL;
     std::string devListTxt;
 
+    // Results of the device enumeration started by post-init
+    std::thread enumThread;
+    std::mutex enumMtx;
+    bool enumDone = false;
+    bladerf_devinfo* enumInfoList = NULL;
+    std::string enumListTxt;
+    int enumCount = 0;
+
     std::string selectedSerial;
 
     BladeRFType selectedBladeType = BLADERF_TYPE_UNKNOWN;
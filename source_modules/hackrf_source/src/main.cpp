@@ -99,23 +99,57 @@ public:
         handler.tuneHandler = tune;
         handler.stream = &stream;
 
-        refresh();
-
-        config.acquire();
-        std::string confSerial = config.conf["device"];
-        config.release();
-        selectBySerial(confSerial);
-
         sigpath::sourceManager.registerSource("HackRF", &handler);
     }
 
     ~HackRFSourceModule() {
+        if (enumThread.joinable()) { enumThread.join(); }
         stop(this);
         hackrf_exit();
         sigpath::sourceManager.unregisterSource("HackRF");
     }
 
-    void postInit() {}
+    void postInit() {
+#ifndef __ANDROID__
+        // Looking for devices can take a while, so it's done on a worker into separate lists
+        // that the GUI thread swaps in once they're ready
+        enumThread = std::thread([this]() {
+            std::vector<std::string> list;
+            std::string txt;
+            listDevices(list, txt);
+            std::lock_guard<std::mutex> lck(enumMtx);
+            enumList = std::move(list);
+            enumListTxt = std::move(txt);
+            enumDone = true;
+        });
+#else
+        refresh();
+        selectConfigDevice();
+#endif
+    }
+
+    // Swaps in the devices found after post-init. Only called from the GUI thread
+    void applyEnumeration(bool wait = false) {
+        if (wait && enumThread.joinable()) { enumThread.join(); }
+        {
+            std::lock_guard<std::mutex> lck(enumMtx);
+            if (!enumDone) { return; }
+            enumDone = false;
+            devList = std::move(enumList);
+            devListTxt = std::move(enumListTxt);
+        }
+        selectConfigDevice();
+    }
+
+    void selectConfigDevice() {
+        config.acquire();
+        std::string confSerial = config.conf["device"];
+        config.release();
+        selectBySerial(confSerial);
+
+        // Apply the device's samplerate if the source got selected in the meantime
+        if (selected) { core::setInputSampleRate(sampleRate); }
+    }
 
     void enable() {
         enabled = true;
@@ -130,17 +164,21 @@ public:
     }
 
     void refresh() {
-        devList.clear();
-        devListTxt = "";
+        listDevices(devList, devListTxt);
+    }
+
+    void listDevices(std::vector<std::string>& list, std::string& listTxt) {
+        list.clear();
+        listTxt = "";
 
 #ifndef __ANDROID__
         uint64_t serials[256];
         hackrf_device_list_t* _devList = hackrf_device_list();
 
         for (int i = 0; i < _devList->devicecount; i++) {
-            devList.push_back(_devList->serial_numbers[i]);
-            devListTxt += (char*)(_devList->serial_numbers[i] + 16);
-            devListTxt += '\0';
+            list.push_back(_devList->serial_numbers[i]);
+            listTxt += (char*)(_devList->serial_numbers[i] + 16);
+            listTxt += '\0';
         }
 
         hackrf_device_list_free(_devList);
@@ -149,9 +187,9 @@ public:
         devFd = backend::getDeviceFD(vid, pid, backend::HACKRF_VIDPIDS);
         if (devFd < 0) { return; }
         std::string fakeName = "HackRF USB";
-        devList.push_back("fake_serial");
-        devListTxt += fakeName;
-        devListTxt += '\0';
+        list.push_back("fake_serial");
+        listTxt += fakeName;
+        listTxt += '\0';
 #endif
     }
 
@@ -223,12 +261,15 @@ public:
 private:
     static void menuSelected(void* ctx) {
         HackRFSourceModule* _this = (HackRFSourceModule*)ctx;
+        _this->selected = true;
+        _this->applyEnumeration();
         core::setInputSampleRate(_this->sampleRate);
         spdlog::info("HackRFSourceModule '{0}': Menu Select!", _this->name);
     }
 
     static void menuDeselected(void* ctx) {
         HackRFSourceModule* _this = (HackRFSourceModule*)ctx;
+        _this->selected = false;
         spdlog::info("HackRFSourceModule '{0}': Menu Deselect!", _this->name);
     }
 
@@ -240,6 +281,7 @@ private:
     static void start(void* ctx) {
         HackRFSourceModule* _this = (HackRFSourceModule*)ctx;
         if (_this->running) { return; }
+        _this->applyEnumeration(true);
         if (_this->selectedSerial == "") {
             spdlog::error("Tried to start HackRF source with empty serial");
             return;
@@ -295,6 +337,7 @@ private:
 
     static void menuHandler(void* ctx) {
         HackRFSourceModule* _this = (HackRFSourceModule*)ctx;
+        _this->applyEnumeration();
 
         if (_this->running) { SmGui::BeginDisabled(); }
         SmGui::FillWidth();
@@ -387,6 +430,7 @@ private:
     std::string name;
     hackrf_device* openDev;
     bool enabled = true;
+    bool selected = false;
     dsp::stream<dsp::complex_t> stream;
     int sampleRate;
     SourceManager::SourceHandler handler;
@@ -407,6 +451,13 @@ private:
 
     std::vector<std::string> devList;
     std::string devListTxt;
+
+    // Results of the device enumeration started by post-init
+    std::thread enumThread;
+    std::mutex enumMtx;
+    bool enumDone = false;
+    std::vector<std::string> enumList;
+    std::string enumListTxt;
 };
 
 MOD_EXPORT void _INIT_() {
@@ -1,9 +1,12 @@
 #include "hermes.h"
 #include <spdlog/spdlog.h>
+#include <volk/volk.h>
+#include <algorithm>
 
 namespace hermes {
     Client::Client(std::shared_ptr<net::Socket> sock) {
         this->sock = sock;
+        updateBlockSize();
 
         // Start worker
         workerThread = std::thread(&Client::worker, this);
@@ -33,6 +36,19 @@ namespace hermes {
 
     void Client::setSamplerate(HermesLiteSamplerate samplerate) {
         writeReg(0, (uint32_t)samplerate << 24);
+        sampleRate = 48000.0 * (double)(1 << samplerate);
+        updateBlockSize();
+    }
+
+    void Client::setBlockDuration(double duration) {
+        blockDuration = duration;
+        updateBlockSize();
+    }
+
+    void Client::updateBlockSize() {
+        // Whole frames are added at once, so leave room for one more on top of a full block
+        int size = (sampleRate * blockDuration) / 1000.0;
+        blockSize = std::clamp<int>(size, HERMES_FRAME_SAMPLES, STREAM_BUFFER_SIZE / 2);
     }
 
     void Client::setFrequency(double freq) {
@@ -154,54 +170,99 @@ namespace hermes {
 #endif
     }
 
+    // Unpacks the 24bit big endian samples of a frame to 32bit integers. There are no branches and the sign
+    // is extended with a single shift so that the compiler can vectorize it. IQ is swapped in the stream.
+    static inline void unpackFrame(const uint8_t* in, int32_t* out) {
+        for (int i = 0; i < HERMES_FRAME_SAMPLES; i++) {
+            const uint8_t* s = &in[i * 8];
+            out[(i * 2) + 1] = (int32_t)(((uint32_t)s[0] << 24) | ((uint32_t)s[1] << 16) | ((uint32_t)s[2] << 8)) >> 8;
+            out[(i * 2)] = (int32_t)(((uint32_t)s[3] << 24) | ((uint32_t)s[4] << 16) | ((uint32_t)s[5] << 8)) >> 8;
+        }
+    }
+
     void Client::worker() {
-        uint8_t rbuf[2048];
-        MetisUSBPacket* pkt = (MetisUSBPacket*)rbuf;
-        while (true) {
-            // Wait for a packet or exit if connection closed
-            int len = sock->recv(rbuf, 2048);
-            if (len <= 0) { break; }
+        uint8_t* rbuf = new uint8_t[HERMES_RECV_BATCH * HERMES_MAX_PACKET_SIZE];
+        int lengths[HERMES_RECV_BATCH];
+        inBuffer = 0;
+        synced = false;
 
-            // Ignore anything that's not a USB packet
-            if (htons(pkt->hdr.signature) != HERMES_METIS_SIGNATURE || pkt->hdr.type != METIS_PKT_USB) {
-                continue;
+        while (true) {
+            // Wait for packets or exit if connection closed
+            int count = sock->recvmulti(rbuf, HERMES_MAX_PACKET_SIZE, HERMES_RECV_BATCH, lengths);
+            if (count < 0 && sock->isOpen()) { continue; }
+            if (count <= 0) { break; }
+
+            bool stopped = false;
+            for (int i = 0; i < count && !stopped; i++) {
+                stopped = !processPacket((MetisUSBPacket*)&rbuf[i * HERMES_MAX_PACKET_SIZE], lengths[i]);
             }
+            if (stopped) { break; }
+        }
 
-            // Parse frames
-            for (int frn = 0; frn < 2; frn++) {
-                uint8_t* frame = pkt->frame[frn];
-                HPSDRUSBHeader* hdr = (HPSDRUSBHeader*)frame;
+        delete[] rbuf;
+    }
 
-                // Make sure this is a valid frame by checking the sync
-                if (hdr->sync[0] != 0x7F || hdr->sync[1] != 0x7F || hdr->sync[2] != 0x7F) {
-                    continue;
-                }
+    bool Client::processPacket(MetisUSBPacket* pkt, int len) {
+        int32_t* samples = (int32_t*)out.writeBuf;
 
-                // Check if this is a response
-                if (hdr->c0 & (1 << 7)) {
-                    uint8_t reg = (hdr->c0 >> 1) & 0x3F;
-                    spdlog::warn("Got response! Reg={0}, Seq={1}", reg, htonl(pkt->seq));
-                }
+        // Ignore anything that's not an IQ packet
+        if (len < sizeof(MetisUSBPacket) || htons(pkt->hdr.signature) != HERMES_METIS_SIGNATURE || pkt->hdr.type != METIS_PKT_USB || pkt->endpoint != HERMES_IQ_ENDPOINT) {
+            return true;
+        }
 
-                // Decode and send IQ to stream
-                uint8_t* iq = &frame[8];
-                for (int i = 0; i < 63; i++) {
-                    // Convert to 32bit
-                    int32_t si = ((uint32_t)iq[(i*8) + 0] << 16) | ((uint32_t)iq[(i*8) + 1] << 8) | (uint32_t)iq[(i*8) + 2];
-                    int32_t sq = ((uint32_t)iq[(i*8) + 3] << 16) | ((uint32_t)iq[(i*8) + 4] << 8) | (uint32_t)iq[(i*8) + 5];
-                    
-                    // Sign extend
-                    si = (si << 8) >> 8;
-                    sq = (sq << 8) >> 8;
-
-                    // Convert to float (IQ swapped for some reason)
-                    out.writeBuf[i].im = (float)si / (float)0x1000000;
-                    out.writeBuf[i].re = (float)sq / (float)0x1000000;
+        // Check the sequence number, drop late packets and fill in for lost ones to keep the timing
+        uint32_t seq = htonl(pkt->seq);
+        if (synced && seq != expectedSeq) {
+            if ((int32_t)(seq - expectedSeq) < 0) { return true; }
+            uint32_t lost = seq - expectedSeq;
+            lostPackets += lost;
+            spdlog::warn("Hermes: Lost {0} packets (seq {1} to {2})", lost, expectedSeq, seq - 1);
+
+            int fill = std::min<uint32_t>(lost, HERMES_MAX_FILL_PACKETS) * 2 * HERMES_FRAME_SAMPLES;
+            while (fill > 0) {
+                int n = std::min<int>(fill, blockSize - inBuffer);
+                if (n > 0) {
+                    memset(&samples[inBuffer * 2], 0, n * 2 * sizeof(int32_t));
+                    inBuffer += n;
+                    fill -= n;
                 }
-                out.swap(63);
-                // TODO: Buffer the data to avoid having a very high DSP frame rate
-            }            
+                if (inBuffer >= blockSize && !sendBlock()) { return false; }
+            }
+        }
+        synced = true;
+        expectedSeq = seq + 1;
+
+        // Parse frames
+        for (int frn = 0; frn < 2; frn++) {
+            uint8_t* frame = pkt->frame[frn];
+            HPSDRUSBHeader* hdr = (HPSDRUSBHeader*)frame;
+
+            // Make sure this is a valid frame by checking the sync
+            if (hdr->sync[0] != 0x7F || hdr->sync[1] != 0x7F || hdr->sync[2] != 0x7F) {
+                continue;
+            }
+
+            // Check if this is a response
+            if (hdr->c0 & (1 << 7)) {
+                uint8_t reg = (hdr->c0 >> 1) & 0x3F;
+                spdlog::warn("Got response! Reg={0}, Seq={1}", reg, seq);
+            }
+
+            // Decode IQ and send blocks of the configured duration to the stream
+            unpackFrame(&frame[8], &samples[inBuffer * 2]);
+            inBuffer += HERMES_FRAME_SAMPLES;
+            if (inBuffer >= blockSize && !sendBlock()) { return false; }
         }
+
+        return true;
+    }
+
+    bool Client::sendBlock() {
+        // The samples are accumulated as integers in the write buffer and converted in place
+        volk_32i_s32f_convert_32f((float*)out.writeBuf, (const int32_t*)out.writeBuf, (float)0x1000000, inBuffer * 2);
+        int count = inBuffer;
+        inBuffer = 0;
+        return out.swap(count);
     }
 
     std::vector<Info> discover() {
@@ -6,12 +6,20 @@
 #include <vector>
 #include <string>
 #include <thread>
+#include <atomic>
 
 #define HERMES_METIS_REPEAT     5
 #define HERMES_METIS_TIMEOUT    1000
 #define HERMES_METIS_SIGNATURE  0xEFFE
 #define HERMES_HPSDR_USB_SYNC   0x7F
 #define HERMES_I2C_DELAY        50
+#define HERMES_IQ_ENDPOINT      6
+#define HERMES_FRAME_SAMPLES    63
+#define HERMES_MAX_PACKET_SIZE  2048
+#define HERMES_RECV_BATCH       32
+#define HERMES_MAX_FILL_PACKETS 64
+
+#define HERMES_DEFAULT_BLOCK_DURATION   10.0
 
 namespace hermes {
     enum MetisPacketType {
@@ -138,6 +146,11 @@ namespace hermes {
         void setGain(int gain);
         void autoFilters(double freq);
 
+        // Duration in milliseconds of the sample blocks sent to the DSP
+        void setBlockDuration(double duration);
+
+        uint64_t getLostPackets() { return lostPackets; }
+
         dsp::stream<dsp::complex_t> out;
 
     //private:
@@ -152,8 +165,20 @@ namespace hermes {
         
 
         void worker();
+        bool processPacket(MetisUSBPacket* pkt, int len);
+        bool sendBlock();
+        void updateBlockSize();
 
         double freq = 0;
+        double sampleRate = 384000.0;
+        double blockDuration = HERMES_DEFAULT_BLOCK_DURATION;
+        std::atomic<int> blockSize;
+        std::atomic<uint64_t> lostPackets = 0;
+
+        // Worker state
+        int inBuffer = 0;
+        uint32_t expectedSeq = 0;
+        bool synced = false;
 
         std::thread workerThread;
         std::shared_ptr<net::Socket> sock;
@@ -153,6 +153,12 @@ private:
         // TODO: Implement start
         _this->dev = hermes::open(_this->devices[_this->devId].addr);
 
+        config.acquire();
+        if (config.conf.contains("blockDuration")) {
+            _this->dev->setBlockDuration(config.conf["blockDuration"]);
+        }
+        config.release();
+
         // TODO: STOP USING A LINK, FIND A BETTER WAY
         _this->lnk.setInput(&_this->dev->out);
         _this->lnk.start();
@@ -272,6 +278,7 @@ MOD_EXPORT void _INIT_() {
     json def = json({});
     def["devices"] = json({});
     def["device"] = "";
+    def["blockDuration"] = HERMES_DEFAULT_BLOCK_DURATION;
     config.setPath(core::args["root"].s() + "/hermes_config.json");
     config.load(def);
     config.enableAutoSave();
@@ -1,6 +1,7 @@
 #include "net.h"
 #include <string.h>
 #include <codecvt>
+#include <algorithm>
 
 #ifdef _WIN32
 #define WOULD_BLOCK (WSAGetLastError() == WSAEWOULDBLOCK)
@@ -8,6 +9,8 @@
 #define WOULD_BLOCK (errno == EWOULDBLOCK)
 #endif
 
+#define MAX_RECVMULTI_COUNT 64
+
 namespace net {
     bool _init = false;
     
@@ -177,6 +180,51 @@ namespace net {
         return read;
     }
 
+    int Socket::recvmulti(uint8_t* data, size_t maxLen, int maxCount, int* lengths, int timeout) {
+        // Wait for the first datagram
+        if (timeout != NONBLOCKING) {
+            fd_set set;
+            FD_ZERO(&set);
+            FD_SET(sock, &set);
+            timeval tv;
+            tv.tv_sec = 0;
+            tv.tv_usec = timeout * 1000;
+            int err = select(sock+1, &set, NULL, &set, (timeout > 0) ? &tv : NULL);
+            if (err <= 0) { return err; }
+        }
+
+#ifdef __linux__
+        // Receive everything that's already queued up with a single call
+        mmsghdr msgs[MAX_RECVMULTI_COUNT];
+        iovec iovs[MAX_RECVMULTI_COUNT];
+        maxCount = std::min<int>(maxCount, MAX_RECVMULTI_COUNT);
+        for (int i = 0; i < maxCount; i++) {
+            iovs[i].iov_base = &data[i * maxLen];
+            iovs[i].iov_len = maxLen;
+            memset(&msgs[i].msg_hdr, 0, sizeof(msghdr));
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        int count = recvmmsg(sock, msgs, maxCount, MSG_DONTWAIT, NULL);
+        if (count <= 0) {
+            if (count < 0 && WOULD_BLOCK) { return -1; }
+            close();
+            return count;
+        }
+        for (int i = 0; i < count; i++) { lengths[i] = msgs[i].msg_len; }
+        return count;
+#else
+        int err = ::recvfrom(sock, (char*)data, maxLen, 0, NULL, NULL);
+        if (err <= 0) {
+            if (err < 0 && WOULD_BLOCK) { return -1; }
+            close();
+            return err;
+        }
+        lengths[0] = err;
+        return 1;
+#endif
+    }
+
     int Socket::recvline(std::string& str, int maxLen, int timeout, Address* dest) {
         // Disallow nonblocking mode
         if (timeout < 0) { return -1; }
@@ -158,6 +158,17 @@ namespace net {
          */
         int recv(uint8_t* data, size_t maxLen, bool forceLen = false, int timeout = NO_TIMEOUT, Address* dest = NULL);
 
+        /**
+         * Receive multiple datagrams from a UDP socket at once. Uses a single system call when the platform allows it.
+         * @param data Buffer to read the datagrams into, the n-th datagram is stored at data + n*maxLen.
+         * @param maxLen Maximum size of a datagram.
+         * @param maxCount Maximum number of datagrams to read.
+         * @param lengths Array of at least maxCount entries receiving the size of each datagram.
+         * @param timeout Timeout in milliseconds for the first datagram. Use NO_TIMEOUT or NONBLOCKING here if needed.
+         * @return Number of datagrams read. 0 means timed out or closed. -1 means would block or error.
+         */
+        int recvmulti(uint8_t* data, size_t maxLen, int maxCount, int* lengths, int timeout = NO_TIMEOUT);
+
         /**
          * Receive line from socket.
          * @param str String to read the data into.
@@ -0,0 +1,378 @@
+#include <utils/networking.h>
+#include <imgui.h>
+#include <spdlog/spdlog.h>
+#include <module.h>
+#include <gui/gui.h>
+#include <signal_path/signal_path.h>
+#include <iq_multicast_protocol.h>
+#include <core.h>
+#include <gui/smgui.h>
+#include <gui/style.h>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+#define CONCAT(a, b) ((std::string(a) + b).c_str())
+
+// Receive buffer large enough to ride out scheduling hiccups at high sample rates
+#define IQ_MULTICAST_SOURCE_RECV_BUFFER     (8 * 1024 * 1024)
+
+// Upper bound on the number of samples synthesized to cover a single gap
+#define IQ_MULTICAST_SOURCE_MAX_FILL        (STREAM_BUFFER_SIZE / 2)
+
+// A sequence number this far behind, or this many late packets in a row, means the publisher restarted
+#define IQ_MULTICAST_SOURCE_RESYNC_JUMP     1024
+#define IQ_MULTICAST_SOURCE_RESYNC_LATE     16
+
+SDRPP_MOD_INFO{
+    /* Name:            */ "iq_multicast_source",
+    /* Description:     */ "Receives IQ published over UDP multicast",
+    /* Author:          */ "Ryzerth",
+    /* Version:         */ 0, 1, 0,
+    /* Max instances    */ 1
+};
+
+ConfigManager config;
+
+class IQMulticastSourceModule : public ModuleManager::Instance {
+public:
+    IQMulticastSourceModule(std::string name) {
+        this->name = name;
+
+        config.acquire();
+        std::string _group = config.conf["group"];
+        strcpy(group, _group.substr(0, sizeof(group) - 1).c_str());
+        port = config.conf["port"];
+        streamId = config.conf["streamId"];
+        zeroFill = config.conf["zeroFill"];
+        sampleRate = (double)config.conf["sampleRate"];
+        config.release();
+
+        handler.ctx = this;
+        handler.selectHandler = menuSelected;
+        handler.deselectHandler = menuDeselected;
+        handler.menuHandler = menuHandler;
+        handler.startHandler = start;
+        handler.stopHandler = stop;
+        handler.tuneHandler = tune;
+        handler.stream = &stream;
+        sigpath::sourceManager.registerSource("IQ Multicast", &handler);
+    }
+
+    ~IQMulticastSourceModule() {
+        stop(this);
+        sigpath::sourceManager.unregisterSource("IQ Multicast");
+    }
+
+    void postInit() {}
+
+    void enable() {
+        enabled = true;
+    }
+
+    void disable() {
+        enabled = false;
+    }
+
+    bool isEnabled() {
+        return enabled;
+    }
+
+private:
+    static void menuSelected(void* ctx) {
+        IQMulticastSourceModule* _this = (IQMulticastSourceModule*)ctx;
+        core::setInputSampleRate(_this->sampleRate);
+        spdlog::info("IQMulticastSourceModule '{0}': Menu Select!", _this->name);
+    }
+
+    static void menuDeselected(void* ctx) {
+        IQMulticastSourceModule* _this = (IQMulticastSourceModule*)ctx;
+        spdlog::info("IQMulticastSourceModule '{0}': Menu Deselect!", _this->name);
+    }
+
+    static void start(void* ctx) {
+        IQMulticastSourceModule* _this = (IQMulticastSourceModule*)ctx;
+        if (_this->running) { return; }
+
+        // Bind the port, allowing other subscribers on the same host to bind it too
+        try {
+            _this->conn = net::openUDP("0.0.0.0", _this->port, _this->group, _this->port, true, true);
+        }
+        catch (std::exception& e) {
+            spdlog::error("IQMulticastSourceModule '{0}': Could not open socket: {1}", _this->name, e.what());
+            return;
+        }
+        if (!_this->conn) { return; }
+        if (!_this->conn->joinMulticastGroup(_this->group)) {
+            spdlog::warn("IQMulticastSourceModule '{0}': Could not join group {1}, receiving unicast only", _this->name, _this->group);
+        }
+        _this->conn->setRecvBufferSize(IQ_MULTICAST_SOURCE_RECV_BUFFER);
+
+        _this->synced = false;
+        _this->rxSampleRate = _this->sampleRate;
+        _this->receivedPackets = 0;
+        _this->lostPackets = 0;
+        _this->gaps = 0;
+        _this->latePackets = 0;
+
+        _this->running = true;
+        _this->rateChangePending = false;
+        _this->controlThread = std::thread(controlWorker, _this);
+        _this->workerThread = std::thread(worker, _this);
+        spdlog::info("IQMulticastSourceModule '{0}': Start!", _this->name);
+    }
+
+    static void stop(void* ctx) {
+        IQMulticastSourceModule* _this = (IQMulticastSourceModule*)ctx;
+        if (!_this->running) { return; }
+        {
+            std::lock_guard<std::mutex> lck(_this->controlMtx);
+            _this->running = false;
+        }
+        _this->controlCnd.notify_all();
+        _this->stream.stopWriter();
+        _this->conn->close();
+        _this->workerThread.join();
+        _this->controlThread.join();
+        _this->stream.clearWriteStop();
+        _this->conn.reset();
+        spdlog::info("IQMulticastSourceModule '{0}': Stop!", _this->name);
+    }
+
+    static void tune(double freq, void* ctx) {
+        // The feed is tuned by the publisher
+        IQMulticastSourceModule* _this = (IQMulticastSourceModule*)ctx;
+        _this->freq = freq;
+    }
+
+    static void menuHandler(void* ctx) {
+        IQMulticastSourceModule* _this = (IQMulticastSourceModule*)ctx;
+
+        if (_this->running) { SmGui::BeginDisabled(); }
+
+        if (SmGui::InputText(CONCAT("##_iq_multicast_group_", _this->name), _this->group, sizeof(_this->group))) {
+            config.acquire();
+            config.conf["group"] = std::string(_this->group);
+            config.release(true);
+        }
+        SmGui::SameLine();
+        SmGui::FillWidth();
+        if (SmGui::InputInt(CONCAT("##_iq_multicast_port_", _this->name), &_this->port, 0)) {
+            _this->port = std::clamp<int>(_this->port, 1, 65535);
+            config.acquire();
+            config.conf["port"] = _this->port;
+            config.release(true);
+        }
+
+        SmGui::LeftLabel("Stream ID");
+        SmGui::FillWidth();
+        if (SmGui::InputInt(CONCAT("##_iq_multicast_stream_id_", _this->name), &_this->streamId, 0)) {
+            _this->streamId = std::clamp<int>(_this->streamId, 0, 65535);
+            config.acquire();
+            config.conf["streamId"] = _this->streamId;
+            config.release(true);
+        }
+
+        if (_this->running) { SmGui::EndDisabled(); }
+
+        if (SmGui::Checkbox(CONCAT("Fill gaps with silence##_iq_multicast_zero_fill_", _this->name), &_this->zeroFill)) {
+            config.acquire();
+            config.conf["zeroFill"] = _this->zeroFill;
+            config.release(true);
+        }
+
+        if (_this->running) {
+            char buf[128];
+            sprintf(buf, "Received: %" PRIu64 " packets", _this->receivedPackets.load());
+            SmGui::Text(buf);
+            sprintf(buf, "Lost: %" PRIu64 " packets in %" PRIu64 " gaps", _this->lostPackets.load(), _this->gaps.load());
+            SmGui::Text(buf);
+            sprintf(buf, "Late: %" PRIu64 " packets", _this->latePackets.load());
+            SmGui::Text(buf);
+            sprintf(buf, "Publisher frequency: %.3lfMHz", _this->centerFreq.load() / 1e6);
+            SmGui::Text(buf);
+        }
+    }
+
+    // Applies sample rate changes of the publisher, kept off the network thread since
+    // reconfiguring the DSP chain can block while the chain waits on the stream
+    static void controlWorker(void* ctx) {
+        IQMulticastSourceModule* _this = (IQMulticastSourceModule*)ctx;
+        while (true) {
+            double sr;
+            {
+                std::unique_lock<std::mutex> lck(_this->controlMtx);
+                _this->controlCnd.wait(lck, [_this]() { return _this->rateChangePending || !_this->running; });
+                if (!_this->running) { return; }
+                _this->rateChangePending = false;
+                sr = _this->pendingSampleRate;
+            }
+
+            _this->sampleRate = sr;
+            core::setInputSampleRate(sr);
+            config.acquire();
+            config.conf["sampleRate"] = sr;
+            config.release(true);
+        }
+    }
+
+    static void worker(void* ctx) {
+        IQMulticastSourceModule* _this = (IQMulticastSourceModule*)ctx;
+        uint8_t* buf = new uint8_t[IQ_MULTICAST_MAX_PACKET];
+        iq_multicast::PacketHeader* hdr = (iq_multicast::PacketHeader*)buf;
+        uint8_t* payload = &buf[sizeof(iq_multicast::PacketHeader)];
+        uint64_t expectedSeq = 0;
+        int lastCount = 0;
+        int lateInARow = 0;
+        int inBuffer = 0;
+        int blockSize = std::clamp<int>(_this->rxSampleRate / 100.0, 1, STREAM_BUFFER_SIZE / 2);
+
+        while (true) {
+            int len = _this->conn->read(IQ_MULTICAST_MAX_PACKET, buf, false);
+            if (len < 0) { break; }
+
+            // Validate the datagram
+            if (len < sizeof(iq_multicast::PacketHeader) || hdr->magic != IQ_MULTICAST_MAGIC || hdr->version != IQ_MULTICAST_VERSION) { continue; }
+            if (hdr->streamId != _this->streamId) { continue; }
+            int count = hdr->sampleCount;
+            int sampSize = iq_multicast::sampleSize(hdr->sampleType);
+            if (!sampSize || count <= 0 || count > STREAM_BUFFER_SIZE || sizeof(iq_multicast::PacketHeader) + (count * sampSize) > len) { continue; }
+
+            // Check the sequence number. A restarted publisher starts over from 0, follow it
+            // instead of dropping everything it sends as late.
+            if (_this->synced && hdr->sequence < expectedSeq) {
+                if (expectedSeq - hdr->sequence < IQ_MULTICAST_SOURCE_RESYNC_JUMP && ++lateInARow < IQ_MULTICAST_SOURCE_RESYNC_LATE) {
+                    _this->latePackets++;
+                    continue;
+                }
+                spdlog::info("IQMulticastSourceModule '{0}': Stream restarted (seq {1}, expected {2}), resyncing", _this->name, hdr->sequence, expectedSeq);
+                _this->synced = false;
+            }
+            lateInARow = 0;
+            if (_this->synced && hdr->sequence > expectedSeq) {
+                uint64_t lost = hdr->sequence - expectedSeq;
+                _this->lostPackets += lost;
+                _this->gaps++;
+                spdlog::warn("IQMulticastSourceModule '{0}': Lost {1} packets (seq {2} to {3})", _this->name, lost, expectedSeq, hdr->sequence - 1);
+
+                // Keep the sample timing by inserting silence in place of the missing samples
+                bool swapFailed = false;
+                if (_this->zeroFill) {
+                    int fill = std::min<uint64_t>(lost * lastCount, IQ_MULTICAST_SOURCE_MAX_FILL);
+                    while (fill > 0 && !swapFailed) {
+                        int n = std::min<int>(fill, STREAM_BUFFER_SIZE - inBuffer);
+                        memset(&_this->stream.writeBuf[inBuffer], 0, n * sizeof(dsp::complex_t));
+                        inBuffer += n;
+                        fill -= n;
+                        if (inBuffer >= blockSize) {
+                            swapFailed = !_this->stream.swap(inBuffer);
+                            inBuffer = 0;
+                        }
+                    }
+                }
+                if (swapFailed) { break; }
+            }
+            _this->synced = true;
+            expectedSeq = hdr->sequence + 1;
+            lastCount = count;
+            _this->receivedPackets++;
+            _this->centerFreq = hdr->centerFrequency;
+
+            // Follow sample rate changes of the publisher
+            if (hdr->sampleRate != _this->rxSampleRate && hdr->sampleRate > 0) {
+                if (inBuffer) {
+                    if (!_this->stream.swap(inBuffer)) { break; }
+                    inBuffer = 0;
+                }
+                _this->rxSampleRate = hdr->sampleRate;
+                blockSize = std::clamp<int>(_this->rxSampleRate / 100.0, 1, STREAM_BUFFER_SIZE / 2);
+                {
+                    std::lock_guard<std::mutex> lck(_this->controlMtx);
+                    _this->pendingSampleRate = hdr->sampleRate;
+                    _this->rateChangePending = true;
+                }
+                _this->controlCnd.notify_all();
+            }
+
+            // Make room in the stream buffer if needed
+            if (inBuffer + count > STREAM_BUFFER_SIZE) {
+                if (!_this->stream.swap(inBuffer)) { break; }
+                inBuffer = 0;
+            }
+
+            // Convert the samples
+            dsp::complex_t* out = &_this->stream.writeBuf[inBuffer];
+            if (hdr->sampleType == iq_multicast::SAMPLE_TYPE_INT8) {
+                volk_8i_s32f_convert_32f((float*)out, (int8_t*)payload, 1.0f / hdr->scale, count * 2);
+            }
+            else if (hdr->sampleType == iq_multicast::SAMPLE_TYPE_INT16) {
+                volk_16i_s32f_convert_32f((float*)out, (int16_t*)payload, 1.0f / hdr->scale, count * 2);
+            }
+            else {
+                memcpy(out, payload, count * sizeof(dsp::complex_t));
+            }
+            inBuffer += count;
+
+            // Send blocks of about 10ms
+            if (inBuffer >= blockSize) {
+                if (!_this->stream.swap(inBuffer)) { break; }
+                inBuffer = 0;
+            }
+        }
+
+        delete[] buf;
+    }
+
+    std::string name;
+    bool enabled = true;
+    dsp::stream<dsp::complex_t> stream;
+    std::atomic<double> sampleRate;
+    double rxSampleRate;
+    double freq;
+    std::atomic<double> centerFreq = 0;
+    SourceManager::SourceHandler handler;
+    std::thread workerThread;
+    std::thread controlThread;
+    std::mutex controlMtx;
+    std::condition_variable controlCnd;
+    double pendingSampleRate;
+    bool rateChangePending = false;
+    net::Conn conn;
+    bool running = false;
+
+    char group[1024];
+    int port = IQ_MULTICAST_DEFAULT_PORT;
+    int streamId = 0;
+    bool zeroFill = false;
+
+    bool synced = false;
+    std::atomic<uint64_t> receivedPackets = 0;
+    std::atomic<uint64_t> lostPackets = 0;
+    std::atomic<uint64_t> gaps = 0;
+    std::atomic<uint64_t> latePackets = 0;
+};
+
+MOD_EXPORT void _INIT_() {
+    config.setPath(core::args["root"].s() + "/iq_multicast_source_config.json");
+    json defConf;
+    defConf["group"] = IQ_MULTICAST_DEFAULT_GROUP;
+    defConf["port"] = IQ_MULTICAST_DEFAULT_PORT;
+    defConf["streamId"] = 0;
+    defConf["zeroFill"] = false;
+    defConf["sampleRate"] = 1000000.0;
+    config.load(defConf);
+    config.enableAutoSave();
+}
+
+MOD_EXPORT ModuleManager::Instance* _CREATE_INSTANCE_(std::string name) {
+    return new IQMulticastSourceModule(name);
+}
+
+MOD_EXPORT void _DELETE_INSTANCE_(ModuleManager::Instance* inst) {
+    delete (IQMulticastSourceModule*)inst;
+}
+
+MOD_EXPORT void _END_() {
+    config.disableAutoSave();
+    config.save();
+}
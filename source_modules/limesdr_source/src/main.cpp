@@ -7,6 +7,10 @@
 #include <config.h>
 #include <gui/smgui.h>
 #include <lime/LimeSuite.h>
+#include <thread>
+#include <mutex>
+#include <memory>
+#include <string.h>
 
 
 #define CONCAT(a, b) ((std::string(a) + b).c_str())
@@ -39,20 +43,46 @@ public:
         handler.tuneHandler = tune;
         handler.stream = &stream;
 
-        refresh();
-
-        // Select device from config
-        selectFirst();
-
         sigpath::sourceManager.registerSource("LimeSDR", &handler);
     }
 
     ~LimeSDRSourceModule() {
+        if (enumThread.joinable()) { enumThread.join(); }
         stop(this);
         sigpath::sourceManager.unregisterSource("LimeSDR");
     }
 
-    void postInit() {}
+    void postInit() {
+        // Listing devices opens each of them to get its serial, so it's done on a worker into
+        // separate lists that the GUI thread swaps in once they're ready
+        enumThread = std::thread([this]() {
+            std::unique_ptr<lms_info_str_t[]> list(new lms_info_str_t[128]);
+            std::vector<std::string> names;
+            std::string txt;
+            int count = listDevices(list.get(), names, txt);
+            std::lock_guard<std::mutex> lck(enumMtx);
+            memcpy(enumList, list.get(), sizeof(enumList));
+            enumCount = count;
+            enumNames = std::move(names);
+            enumListTxt = std::move(txt);
+            enumDone = true;
+        });
+    }
+
+    // Swaps in the devices found after post-init. Only called from the GUI thread
+    void applyEnumeration(bool wait = false) {
+        if (wait && enumThread.joinable()) { enumThread.join(); }
+        {
+            std::lock_guard<std::mutex> lck(enumMtx);
+            if (!enumDone) { return; }
+            enumDone = false;
+            memcpy(devList, enumList, sizeof(devList));
+            devNames = std::move(enumNames);
+            devListTxt = std::move(enumListTxt);
+            devCount = enumCount;
+        }
+        selectFirst();
+    }
 
     void enable() {
         enabled = true;
@@ -67,21 +97,27 @@ public:
     }
 
     void refresh() {
-        devCount = LMS_GetDeviceList(devList);
+        devCount = listDevices(devList, devNames, devListTxt);
+    }
+
+    int listDevices(lms_info_str_t* list, std::vector<std::string>& names, std::string& listTxt) {
+        int count = LMS_GetDeviceList(list);
         char buf[256];
-        devListTxt = "";
+        names.clear();
+        listTxt = "";
 
-        for (int i = 0; i < devCount; i++) {
+        for (int i = 0; i < count; i++) {
             lms_device_t* dev = NULL;
-            LMS_Open(&dev, devList[i], NULL);
+            LMS_Open(&dev, list[i], NULL);
             const lms_dev_info_t* info = LMS_GetDeviceInfo(dev);
             sprintf(buf, "%s [%" PRIX64 "]", info->deviceName, info->boardSerialNumber);
             LMS_Close(dev);
 
-            devNames.push_back(buf);
-            devListTxt += buf;
-            devListTxt += '\0';
+            names.push_back(buf);
+            listTxt += buf;
+            listTxt += '\0';
         }
+        return count;
     }
 
     void selectFirst() {
@@ -307,6 +343,7 @@ private:
 
     static void menuSelected(void* ctx) {
         LimeSDRSourceModule* _this = (LimeSDRSourceModule*)ctx;
+        _this->applyEnumeration();
         core::setInputSampleRate(_this->sampleRate);
         spdlog::info("LimeSDRSourceModule '{0}': Menu Select!", _this->name);
     }
@@ -319,6 +356,11 @@ private:
     static void start(void* ctx) {
         LimeSDRSourceModule* _this = (LimeSDRSourceModule*)ctx;
         if (_this->running) { return; }
+        _this->applyEnumeration(true);
+        if (_this->selectedDevName == "") {
+            spdlog::error("No device selected");
+            return;
+        }
 
         // Open device
         _this->openDev = NULL;
@@ -390,6 +432,7 @@ private:
 
     static void menuHandler(void* ctx) {
         LimeSDRSourceModule* _this = (LimeSDRSourceModule*)ctx;
+        _this->applyEnumeration();
 
         if (_this->running) { SmGui::BeginDisabled(); }
 
@@ -510,6 +553,15 @@ private:
     int devCount = 0;
     std::string devListTxt;
     std::vector<std::string> devNames;
+
+    // Results of the device enumeration started by post-init
+    std::thread enumThread;
+    std::mutex enumMtx;
+    bool enumDone = false;
+    lms_info_str_t enumList[128];
+    std::vector<std::string> enumNames;
+    std::string enumListTxt;
+    int enumCount = 0;
     std::string selectedDevName;
 
     lms_device_t* openDev;
@@ -79,8 +79,50 @@ public:
             sampleRateListTxt += '\0';
         }
 
+        sigpath::sourceManager.registerSource("RTL-SDR", &handler);
+    }
+
+    ~RTLSDRSourceModule() {
+        if (enumThread.joinable()) { enumThread.join(); }
+        stop(this);
+        sigpath::sourceManager.unregisterSource("RTL-SDR");
+    }
+
+    void postInit() {
+#ifndef __ANDROID__
+        // Looking for devices can take a while, so it's done on a worker into separate lists
+        // that the GUI thread swaps in once they're ready
+        enumThread = std::thread([this]() {
+            std::vector<std::string> names;
+            std::string txt;
+            int count = listDevices(names, txt);
+            std::lock_guard<std::mutex> lck(enumMtx);
+            enumNames = std::move(names);
+            enumListTxt = std::move(txt);
+            enumCount = count;
+            enumDone = true;
+        });
+#else
         refresh();
+        selectConfigDevice();
+#endif
+    }
 
+    // Swaps in the devices found after post-init. Only called from the GUI thread
+    void applyEnumeration(bool wait = false) {
+        if (wait && enumThread.joinable()) { enumThread.join(); }
+        {
+            std::lock_guard<std::mutex> lck(enumMtx);
+            if (!enumDone) { return; }
+            enumDone = false;
+            devNames = std::move(enumNames);
+            devListTxt = std::move(enumListTxt);
+            devCount = enumCount;
+        }
+        selectConfigDevice();
+    }
+
+    void selectConfigDevice() {
         config.acquire();
         if (!config.conf["device"].is_string()) {
             selectedDevName = "";
@@ -92,16 +134,10 @@ public:
         config.release(true);
         selectByName(selectedDevName);
 
-        sigpath::sourceManager.registerSource("RTL-SDR", &handler);
-    }
-
-    ~RTLSDRSourceModule() {
-        stop(this);
-        sigpath::sourceManager.unregisterSource("RTL-SDR");
+        // Apply the device's samplerate if the source got selected in the meantime
+        if (selected) { core::setInputSampleRate(sampleRate); }
     }
 
-    void postInit() {}
-
     void enable() {
         enabled = true;
     }
@@ -115,38 +151,42 @@ public:
     }
 
     void refresh() {
-        devNames.clear();
-        devListTxt = "";
+        devCount = listDevices(devNames, devListTxt);
+    }
+
+    int listDevices(std::vector<std::string>& names, std::string& listTxt) {
+        names.clear();
+        listTxt = "";
 
 #ifndef __ANDROID__
-        devCount = rtlsdr_get_device_count();
+        int count = rtlsdr_get_device_count();
         char buf[1024];
         char snBuf[1024];
-        for (int i = 0; i < devCount; i++) {
+        for (int i = 0; i < count; i++) {
             // Gather device info
             const char* devName = rtlsdr_get_device_name(i);
             int snErr = rtlsdr_get_device_usb_strings(i, NULL, NULL, snBuf);
 
             // Build name
             sprintf(buf, "[%s] %s##%d", (!snErr && snBuf[0]) ? snBuf : "No Serial", devName, i);
-            devNames.push_back(buf);
-            devListTxt += buf;
-            devListTxt += '\0';
+            names.push_back(buf);
+            listTxt += buf;
+            listTxt += '\0';
         }
 #else
         // Check for device connection
-        devCount = 0;
         int vid, pid;
         devFd = backend::getDeviceFD(vid, pid, backend::RTL_SDR_VIDPIDS);
-        if (devFd < 0) { return; }
+        if (devFd < 0) { return 0; }
 
         // Generate fake device info
-        devCount = 1;
+        int count = 1;
         std::string fakeName = "RTL-SDR Dongle USB";
-        devNames.push_back(fakeName);
-        devListTxt += fakeName;
-        devListTxt += '\0';
+        names.push_back(fakeName);
+        listTxt += fakeName;
+        listTxt += '\0';
 #endif
+        return count;
     }
 
     void selectFirst() {
@@ -265,18 +305,22 @@ private:
 
     static void menuSelected(void* ctx) {
         RTLSDRSourceModule* _this = (RTLSDRSourceModule*)ctx;
+        _this->selected = true;
+        _this->applyEnumeration();
         core::setInputSampleRate(_this->sampleRate);
         spdlog::info("RTLSDRSourceModule '{0}': Menu Select!", _this->name);
     }
 
     static void menuDeselected(void* ctx) {
         RTLSDRSourceModule* _this = (RTLSDRSourceModule*)ctx;
+        _this->selected = false;
         spdlog::info("RTLSDRSourceModule '{0}': Menu Deselect!", _this->name);
     }
 
     static void start(void* ctx) {
         RTLSDRSourceModule* _this = (RTLSDRSourceModule*)ctx;
         if (_this->running) { return; }
+        _this->applyEnumeration(true);
         if (_this->selectedDevName == "") {
             spdlog::error("No device selected");
             return;
@@ -351,6 +395,7 @@ private:
 
     static void menuHandler(void* ctx) {
         RTLSDRSourceModule* _this = (RTLSDRSourceModule*)ctx;
+        _this->applyEnumeration();
 
         if (_this->running) { SmGui::BeginDisabled(); }
         SmGui::FillWidth();
@@ -535,6 +580,7 @@ private:
     std::string name;
     rtlsdr_dev_t* openDev;
     bool enabled = true;
+    bool selected = false;
     dsp::stream<dsp::complex_t> stream;
     double sampleRate;
     SourceManager::SourceHandler handler;
@@ -547,6 +593,14 @@ private:
     std::thread workerThread;
     bool serverMode = false;
 
+    // Results of the device enumeration started by post-init
+    std::thread enumThread;
+    std::mutex enumMtx;
+    bool enumDone = false;
+    std::vector<std::string> enumNames;
+    std::string enumListTxt;
+    int enumCount = 0;
+
 #ifdef __ANDROID__
     int devFd = -1;
 #endif
@@ -8,6 +8,8 @@
 #include <config.h>
 #include <sdrplay_api.h>
 #include <gui/smgui.h>
+#include <thread>
+#include <mutex>
 
 #define CONCAT(a, b) ((std::string(a) + b).c_str())
 
@@ -153,25 +155,53 @@ public:
         handler.tuneHandler = tune;
         handler.stream = &stream;
 
-        refresh();
-
-        config.acquire();
-        std::string confSelectDev = config.conf["device"];
-        config.release();
-        selectByName(confSelectDev);
-
         sigpath::sourceManager.registerSource("SDRplay", &handler);
 
         initOk = true;
     }
 
     ~SDRPlaySourceModule() {
+        if (enumThread.joinable()) { enumThread.join(); }
         stop(this);
         if (initOk) { sdrplay_api_Close(); }
         sigpath::sourceManager.unregisterSource("SDRplay");
     }
 
-    void postInit() {}
+    void postInit() {
+        if (!initOk) { return; }
+
+        // Asking the API service for devices can take a while, so it's done on a worker into
+        // separate lists that the GUI thread swaps in once they're ready
+        enumThread = std::thread([this]() {
+            std::vector<sdrplay_api_DeviceT> list;
+            std::vector<std::string> names;
+            std::string txt;
+            listDevices(list, names, txt);
+            std::lock_guard<std::mutex> lck(enumMtx);
+            enumList = std::move(list);
+            enumNames = std::move(names);
+            enumListTxt = std::move(txt);
+            enumDone = true;
+        });
+    }
+
+    // Swaps in the devices found after post-init and selects the configured one. Only called from the GUI thread
+    void applyEnumeration(bool wait = false) {
+        if (wait && enumThread.joinable()) { enumThread.join(); }
+        {
+            std::lock_guard<std::mutex> lck(enumMtx);
+            if (!enumDone) { return; }
+            enumDone = false;
+            devList = std::move(enumList);
+            devNameList = std::move(enumNames);
+            devListTxt = std::move(enumListTxt);
+        }
+
+        config.acquire();
+        std::string confSelectDev = config.conf["device"];
+        config.release();
+        selectByName(confSelectDev);
+    }
 
     void enable() {
         enabled = true;
@@ -186,16 +216,23 @@ public:
     }
 
     void refresh() {
-        devList.clear();
-        devNameList.clear();
-        devListTxt = "";
+        // Don't query the API service from two threads, the post-init result would be older anyway
+        if (enumThread.joinable()) { enumThread.join(); }
+        enumDone = false;
+        listDevices(devList, devNameList, devListTxt);
+    }
+
+    void listDevices(std::vector<sdrplay_api_DeviceT>& list, std::vector<std::string>& names, std::string& listTxt) {
+        list.clear();
+        names.clear();
+        listTxt = "";
 
         sdrplay_api_DeviceT devArr[128];
         unsigned int numDev = 0;
         sdrplay_api_GetDevices(devArr, &numDev, 128);
 
         for (unsigned int i = 0; i < numDev; i++) {
-            devList.push_back(devArr[i]);
+            list.push_back(devArr[i]);
             std::string name = "";
             switch (devArr[i].hwVer) {
             case SDRPLAY_RSP1_ID:
@@ -229,9 +266,9 @@ public:
                 name += ')';
                 break;
             }
-            devNameList.push_back(name);
-            devListTxt += name;
-            devListTxt += '\0';
+            names.push_back(name);
+            listTxt += name;
+            listTxt += '\0';
         }
     }
 
@@ -521,6 +558,7 @@ private:
 
     static void menuSelected(void* ctx) {
         SDRPlaySourceModule* _this = (SDRPlaySourceModule*)ctx;
+        _this->applyEnumeration();
         core::setInputSampleRate(_this->sampleRate);
         spdlog::info("SDRPlaySourceModule '{0}': Menu Select!", _this->name);
     }
@@ -533,6 +571,11 @@ private:
     static void start(void* ctx) {
         SDRPlaySourceModule* _this = (SDRPlaySourceModule*)ctx;
         if (_this->running) { return; }
+        _this->applyEnumeration(true);
+        if (_this->selectedName == "") {
+            spdlog::error("No device selected");
+            return;
+        }
 
         // First, acquire device
         sdrplay_api_ErrT err;
@@ -681,6 +724,7 @@ private:
 
     static void menuHandler(void* ctx) {
         SDRPlaySourceModule* _this = (SDRPlaySourceModule*)ctx;
+        _this->applyEnumeration();
 
         if (_this->running) { SmGui::BeginDisabled(); }
 
@@ -1200,6 +1244,14 @@ private:
     std::string devListTxt;
     std::vector<std::string> devNameList;
     std::string selectedName;
+
+    // Results of the device enumeration started by post-init
+    std::thread enumThread;
+    std::mutex enumMtx;
+    bool enumDone = false;
+    std::vector<sdrplay_api_DeviceT> enumList;
+    std::vector<std::string> enumNames;
+    std::string enumListTxt;
 };
 
 MOD_EXPORT void _INIT_() {
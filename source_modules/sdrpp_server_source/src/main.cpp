@@ -35,7 +35,14 @@ public:
         sampleTypeList.define("Int8", dsp::compression::PCM_TYPE_I8);
         sampleTypeList.define("Int16", dsp::compression::PCM_TYPE_I16);
         sampleTypeList.define("Float32", dsp::compression::PCM_TYPE_F32);
+        sampleTypeList.define("Packed", dsp::compression::PCM_TYPE_BFP);
         sampleTypeId = sampleTypeList.valueId(dsp::compression::PCM_TYPE_I16);
+        compressionLevelList.define("Adaptive", SERVER_COMPRESSION_LEVEL_ADAPTIVE);
+        compressionLevelList.define("Fastest", -5);
+        compressionLevelList.define("Fast", 1);
+        compressionLevelList.define("Normal", 3);
+        compressionLevelList.define("Strong", 9);
+        compressionLevelId = compressionLevelList.valueId(1);
 
         handler.ctx = this;
         handler.selectHandler = menuSelected;
@@ -117,6 +124,7 @@ private:
 
         // Set configuration
         _this->client->setFrequency(_this->freq);
+        _this->updateStreamingMode();
         _this->client->start();
 
         _this->running = true;
@@ -182,13 +190,31 @@ private:
             ImGui::LeftLabel("Sample type");
             ImGui::FillWidth();
             if (ImGui::Combo("##sdrpp_srv_source_samp_type", &_this->sampleTypeId, _this->sampleTypeList.txt)) {
-                _this->client->setSampleType(_this->sampleTypeList[_this->sampleTypeId]);
+                _this->client->setSampleType(_this->sampleTypeList[_this->sampleTypeId], _this->bitDepth, _this->deltaCoding);
 
                 // Save config
                 config.acquire();
                 config.conf["servers"][_this->devConfName]["sampleType"] = _this->sampleTypeList.key(_this->sampleTypeId);
                 config.release(true);
             }
+
+            // Packed samples should match the real resolution of the remote ADC
+            if (_this->sampleTypeList[_this->sampleTypeId] == dsp::compression::PCM_TYPE_BFP) {
+                ImGui::LeftLabel("Bit depth");
+                ImGui::FillWidth();
+                if (ImGui::SliderInt("##sdrpp_srv_source_bit_depth", &_this->bitDepth, BFP_MIN_BITS, BFP_MAX_BITS)) {
+                    _this->client->setSampleType(dsp::compression::PCM_TYPE_BFP, _this->bitDepth, _this->deltaCoding);
+                    config.acquire();
+                    config.conf["servers"][_this->devConfName]["bitDepth"] = _this->bitDepth;
+                    config.release(true);
+                }
+                if (ImGui::Checkbox("Delta coding##sdrpp_srv_source_delta", &_this->deltaCoding)) {
+                    _this->client->setSampleType(dsp::compression::PCM_TYPE_BFP, _this->bitDepth, _this->deltaCoding);
+                    config.acquire();
+                    config.conf["servers"][_this->devConfName]["deltaCoding"] = _this->deltaCoding;
+                    config.release(true);
+                }
+            }
             
             if (ImGui::Checkbox("Compression", &_this->compression)) {
                 _this->client->setCompression(_this->compression);
@@ -199,10 +225,28 @@ private:
                 config.release(true);
             }
 
-            bool dummy = true;
-            style::beginDisabled();
-            ImGui::Checkbox("Full IQ", &dummy);
-            style::endDisabled();
+            if (_this->compression) {
+                ImGui::LeftLabel("Compression level");
+                ImGui::FillWidth();
+                if (ImGui::Combo("##sdrpp_srv_source_comp_level", &_this->compressionLevelId, _this->compressionLevelList.txt)) {
+                    _this->client->setCompressionLevel(_this->compressionLevelList[_this->compressionLevelId]);
+
+                    // Save config
+                    config.acquire();
+                    config.conf["servers"][_this->devConfName]["compressionLevel"] = _this->compressionLevelList.key(_this->compressionLevelId);
+                    config.release(true);
+                }
+            }
+
+            // Without the full IQ only the spectrum computed by the server is received
+            if (ImGui::Checkbox("Full IQ##sdrpp_srv_source_full_iq", &_this->fullIQ)) {
+                _this->updateStreamingMode();
+
+                // Save config
+                config.acquire();
+                config.conf["servers"][_this->devConfName]["fullIQ"] = _this->fullIQ;
+                config.release(true);
+            }
 
             // Calculate datarate
             _this->frametimeCounter += ImGui::GetIO().DeltaTime;
@@ -216,6 +260,20 @@ private:
             ImGui::SameLine();
             ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "Connected (%.3f Mbit/s)", _this->datarate);
 
+            // Show what the server actually achieves
+            if (_this->client->compressionStatsValid) {
+                const server::CompressionStats& stats = _this->client->compressionStats;
+                ImGui::Text("Server: %.3f Mbit/s, %u queued", (stats.bandwidth * 8.0f) / (1024.0f * 1024.0f), stats.queueDepth);
+                if (_this->compression) {
+                    dsp::compression::PCMType type = (dsp::compression::PCMType)stats.sampleType;
+                    std::string typeName = _this->sampleTypeList.valueExists(type) ? _this->sampleTypeList.key(_this->sampleTypeList.valueId(type)) : "Unknown";
+                    ImGui::Text("Ratio: %.2f (level %d, %s)", stats.ratio, stats.level, typeName.c_str());
+                }
+                if (stats.dropped) {
+                    ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Dropped buffers: %u", stats.dropped);
+                }
+            }
+
             ImGui::CollapsingHeader("Source [REMOTE]", ImGuiTreeNodeFlags_DefaultOpen);
 
             _this->client->showMenu();
@@ -227,6 +285,30 @@ private:
         }
     }
 
+    static void fftHandler(float* data, int count, void* ctx) {
+        sigpath::iqFrontEnd.pushExternalFFT(data, count);
+    }
+
+    void updateStreamingMode() {
+        if (fullIQ) {
+            client->setStreamingMode(server::STREAMING_MODE_BASEBAND);
+            client->setFFTHandler(NULL, NULL);
+            return;
+        }
+
+        // Ask for the spectrum the display would compute itself
+        int fftSize = 8192;
+        float fftRate = 20.0f;
+        core::configManager.acquire();
+        if (core::configManager.conf.contains("fftSize")) { fftSize = core::configManager.conf["fftSize"]; }
+        if (core::configManager.conf.contains("fftRate")) { fftRate = core::configManager.conf["fftRate"]; }
+        core::configManager.release();
+
+        client->setFFTHandler(fftHandler, this);
+        client->setFFT(fftSize, fftRate);
+        client->setStreamingMode(server::STREAMING_MODE_FFT);
+    }
+
     void tryConnect() {
         try {
             if (client) { client.reset(); }
@@ -251,13 +333,30 @@ private:
             std::string key = config.conf["servers"][devConfName]["sampleType"];
             if (sampleTypeList.keyExists(key)) { sampleTypeId = sampleTypeList.keyId(key); }
         }
+        if (config.conf["servers"][devConfName].contains("bitDepth")) {
+            bitDepth = std::clamp<int>(config.conf["servers"][devConfName]["bitDepth"], BFP_MIN_BITS, BFP_MAX_BITS);
+        }
+        if (config.conf["servers"][devConfName].contains("deltaCoding")) {
+            deltaCoding = config.conf["servers"][devConfName]["deltaCoding"];
+        }
         if (config.conf["servers"][devConfName].contains("compression")) {
             compression = config.conf["servers"][devConfName]["compression"];
         }
+        compressionLevelId = compressionLevelList.valueId(1);
+        if (config.conf["servers"][devConfName].contains("compressionLevel")) {
+            std::string key = config.conf["servers"][devConfName]["compressionLevel"];
+            if (compressionLevelList.keyExists(key)) { compressionLevelId = compressionLevelList.keyId(key); }
+        }
+        fullIQ = true;
+        if (config.conf["servers"][devConfName].contains("fullIQ")) {
+            fullIQ = config.conf["servers"][devConfName]["fullIQ"];
+        }
 
         // Set settings
-        client->setSampleType(sampleTypeList[sampleTypeId]);
+        client->setSampleType(sampleTypeList[sampleTypeId], bitDepth, deltaCoding);
         client->setCompression(compression);
+        client->setCompressionLevel(compressionLevelList[compressionLevelId]);
+        updateStreamingMode();
     }
 
     std::string name;
@@ -279,8 +378,15 @@ private:
 
     OptionList<std::string, dsp::compression::PCMType> sampleTypeList;
     int sampleTypeId;
+    int bitDepth = 12;
+    bool deltaCoding = false;
     bool compression = false;
 
+    OptionList<std::string, int> compressionLevelList;
+    int compressionLevelId;
+
+    bool fullIQ = true;
+
     server::Client client;
 };
 
@@ -14,6 +14,7 @@ namespace server {
         // Allocate buffers
         rbuffer = new uint8_t[SERVER_MAX_PACKET_SIZE];
         sbuffer = new uint8_t[SERVER_MAX_PACKET_SIZE];
+        decompBuf = new uint8_t[SERVER_DECOMP_BUFFER_SIZE];
 
         // Initialize headers
         r_pkt_hdr = (PacketHeader*)rbuffer;
@@ -29,19 +30,22 @@ namespace server {
         // Initialize decompressor
         dctx = ZSTD_createDCtx();
 
-        // Initialize DSP
-        decompIn.setBufferSize((sizeof(dsp::complex_t) * STREAM_BUFFER_SIZE) + 8);
-        decompIn.clearWriteStop();
-        decomp.init(&decompIn);
-        link.init(&decomp.out, output);
-        decomp.start();
-        link.start();
+        // Start the decompression worker, receive buffers are only allocated as packets need them
+        for (int i = 0; i < SERVER_RECV_POOL_SIZE; i++) { freeBuffers.push(i); }
+        workerRunning = true;
+        workerThread = std::thread(&ClientClass::decompWorker, this);
+
+        // Let packet headers be read together with their payload and don't delay commands
+        client->setReadBuffer(SERVER_READ_BUFFER_SIZE);
+        client->setNoDelay(true);
 
         // Start readers
         client->readAsync(sizeof(PacketHeader), rbuffer, tcpHandler, this);
 
-        // Ask for a UI
-        int res = getUI();
+        // Find out what the server supports before asking for a UI
+        int res = getVersion();
+        if (res == 0) { res = getUI(); }
+        if (res < 0) { close(); }
         if (res == -1) { throw std::runtime_error("Timed out"); }
         else if (res == -2) { throw std::runtime_error("Server busy"); }
     }
@@ -51,15 +55,18 @@ namespace server {
         ZSTD_freeDCtx(dctx);
         delete[] rbuffer;
         delete[] sbuffer;
+        delete[] decompBuf;
     }
 
     void ClientClass::showMenu() {
         std::string diffId = "";
         SmGui::DrawListElem diffValue;
         bool syncRequired = false;
+        uint64_t dlHash;
         {
             std::lock_guard<std::mutex> lck(dlMtx);
             dl.draw(diffId, diffValue, syncRequired);
+            if (syncRequired) { dlHash = dl.getHash(); }
         }
 
         if (!diffId.empty()) {
@@ -77,11 +84,17 @@ namespace server {
             // Send
             if (syncRequired) {
                 spdlog::warn("Action requires resync");
+
+                // The server only sends the UI back if it differs from what the action already changed locally
+                if (serverVersion >= 1) {
+                    *(uint64_t*)&s_cmd_data[size] = dlHash;
+                    size += sizeof(uint64_t);
+                }
+
                 auto waiter = awaitCommandAck(COMMAND_UI_ACTION);
                 sendCommand(COMMAND_UI_ACTION, size);
                 if (waiter->await(PROTOCOL_TIMEOUT_MS)) {
-                    std::lock_guard lck(dlMtx);
-                    dl.load(r_cmd_data, r_pkt_hdr->size - sizeof(PacketHeader) - sizeof(CommandHeader));
+                    loadUI();
                 }
                 else {
                     spdlog::error("Timeout out after asking for UI");
@@ -109,8 +122,14 @@ namespace server {
         return currentSampleRate;
     }
 
-    void ClientClass::setSampleType(dsp::compression::PCMType type) {
+    void ClientClass::setSampleType(dsp::compression::PCMType type, int bitDepth, bool deltaCoding) {
         s_cmd_data[0] = type;
+        if (type == dsp::compression::PCM_TYPE_BFP) {
+            s_cmd_data[1] = bitDepth;
+            s_cmd_data[2] = deltaCoding ? BFP_FLAG_DELTA : 0;
+            sendCommand(COMMAND_SET_SAMPLE_TYPE, 3);
+            return;
+        }
         sendCommand(COMMAND_SET_SAMPLE_TYPE, 1);
     }
 
@@ -119,6 +138,28 @@ namespace server {
         sendCommand(COMMAND_SET_COMPRESSION, 1);
     }
 
+    void ClientClass::setCompressionLevel(int level) {
+        *(int8_t*)s_cmd_data = level;
+        sendCommand(COMMAND_SET_COMPRESSION_LEVEL, 1);
+    }
+
+    void ClientClass::setStreamingMode(StreamingMode mode) {
+        s_cmd_data[0] = mode;
+        sendCommand(COMMAND_SET_STREAMING_MODE, 1);
+    }
+
+    void ClientClass::setFFT(int size, float rate) {
+        FFTSettings* settings = (FFTSettings*)s_cmd_data;
+        settings->size = size;
+        settings->rate = rate;
+        sendCommand(COMMAND_SET_FFT, sizeof(FFTSettings));
+    }
+
+    void ClientClass::setFFTHandler(void (*handler)(float* data, int count, void* ctx), void* ctx) {
+        fftHandlerCtx = ctx;
+        fftHandler = handler;
+    }
+
     void ClientClass::start() {
         if (!client || !client->isOpen()) { return; }
         sendCommand(COMMAND_START, 0);
@@ -132,11 +173,8 @@ namespace server {
     }
 
     void ClientClass::close() {
-        decomp.stop();
-        link.stop();
-        decompIn.stopWriter();
+        stopDecompWorker();
         client->close();
-        decompIn.clearWriteStop();
     }
 
     bool ClientClass::isOpen() {
@@ -146,25 +184,57 @@ namespace server {
     void ClientClass::tcpHandler(int count, uint8_t* buf, void* ctx) {
         ClientClass* _this = (ClientClass*)ctx;
         
-        // Read the rest of the data (TODO: CHECK SIZE OR SHIT WILL BE FUCKED)
-        int len = 0;
-        int read = 0;
-        int goal = _this->r_pkt_hdr->size - sizeof(PacketHeader);
-        while (len < goal) {
-            read = _this->client->read(goal - len, &buf[sizeof(PacketHeader) + len]);
-            if (read < 0) {
-                return; 
-            };
-            len += read;
+        // Reject packets that can't fit in the receive buffer
+        if (_this->r_pkt_hdr->size < sizeof(PacketHeader) || _this->r_pkt_hdr->size > SERVER_MAX_PACKET_SIZE) {
+            spdlog::error("Invalid packet size: {0}, closing the connection", _this->r_pkt_hdr->size);
+            _this->close();
+            return;
         }
+        int goal = _this->r_pkt_hdr->size - sizeof(PacketHeader);
         _this->bytes += _this->r_pkt_hdr->size;
-        
+
+        // Baseband is read into the receive pool and left to the decompression worker
+        if (_this->r_pkt_hdr->type == PACKET_TYPE_BASEBAND || _this->r_pkt_hdr->type == PACKET_TYPE_BASEBAND_COMPRESSED) {
+            int id;
+            {
+                std::unique_lock<std::mutex> lck(_this->poolMtx);
+                _this->poolCnd.wait(lck, [=](){ return !_this->freeBuffers.empty() || !_this->workerRunning; });
+                if (!_this->workerRunning) { return; }
+                id = _this->freeBuffers.front();
+                _this->freeBuffers.pop();
+            }
+
+            RecvBuffer& rb = _this->recvPool[id];
+            if (rb.data.size() < goal) { rb.data.resize(goal); }
+            rb.size = goal;
+            rb.compressed = (_this->r_pkt_hdr->type == PACKET_TYPE_BASEBAND_COMPRESSED);
+            bool ok = _this->readPayload(rb.data.data(), goal);
+
+            {
+                std::lock_guard<std::mutex> lck(_this->poolMtx);
+                if (ok) { _this->filledBuffers.push(id); }
+                else { _this->freeBuffers.push(id); }
+            }
+            _this->poolCnd.notify_all();
+            if (!ok) { return; }
+
+            _this->client->readAsync(sizeof(PacketHeader), _this->rbuffer, tcpHandler, _this);
+            return;
+        }
+
+        // Read the rest of the data
+        if (!_this->readPayload(&buf[sizeof(PacketHeader)], goal)) { return; }
+
         if (_this->r_pkt_hdr->type == PACKET_TYPE_COMMAND) {
             // TODO: Move to command handler
             if (_this->r_cmd_hdr->cmd == COMMAND_SET_SAMPLERATE && _this->r_pkt_hdr->size == sizeof(PacketHeader) + sizeof(CommandHeader) + sizeof(double)) {
                 _this->currentSampleRate = *(double*)_this->r_cmd_data;
                 core::setInputSampleRate(_this->currentSampleRate);
             }
+            else if (_this->r_cmd_hdr->cmd == COMMAND_COMPRESSION_STATS && _this->r_pkt_hdr->size == sizeof(PacketHeader) + sizeof(CommandHeader) + sizeof(CompressionStats)) {
+                memcpy(&_this->compressionStats, _this->r_cmd_data, sizeof(CompressionStats));
+                _this->compressionStatsValid = true;
+            }
             else if (_this->r_cmd_hdr->cmd == COMMAND_DISCONNECT) {
                 spdlog::error("Asked to disconnect by the server");
                 _this->serverBusy = true;
@@ -198,16 +268,38 @@ namespace server {
                 delete waiter;
             }
         }
-        else if (_this->r_pkt_hdr->type == PACKET_TYPE_BASEBAND) {
-            memcpy(_this->decompIn.writeBuf, &buf[sizeof(PacketHeader)], _this->r_pkt_hdr->size - sizeof(PacketHeader));
-            _this->decompIn.swap(_this->r_pkt_hdr->size - sizeof(PacketHeader));
-        }
-        else if (_this->r_pkt_hdr->type == PACKET_TYPE_BASEBAND_COMPRESSED) {
-            size_t outCount = ZSTD_decompressDCtx(_this->dctx, _this->decompIn.writeBuf, STREAM_BUFFER_SIZE, _this->r_pkt_data, _this->r_pkt_hdr->size - sizeof(PacketHeader));
-            if (outCount) { _this->decompIn.swap(outCount); };
+        else if (_this->r_pkt_hdr->type == PACKET_TYPE_FFT && goal > sizeof(FFTHeader)) {
+            // Expand the quantized levels back to dB
+            FFTHeader* fhdr = (FFTHeader*)_this->r_pkt_data;
+            const uint8_t* bins = &_this->r_pkt_data[sizeof(FFTHeader)];
+            int binCount = goal - sizeof(FFTHeader);
+            if (_this->fftHandler) {
+                if (_this->fftBuf.size() < binCount) { _this->fftBuf.resize(binCount); }
+                for (int i = 0; i < binCount; i++) {
+                    _this->fftBuf[i] = fhdr->offset + ((float)bins[i] * fhdr->step);
+                }
+                _this->fftHandler(_this->fftBuf.data(), binCount, _this->fftHandlerCtx);
+            }
         }
         else if (_this->r_pkt_hdr->type == PACKET_TYPE_ERROR) {
-            spdlog::error("SDR++ Server Error: {0}", buf[sizeof(PacketHeader)]);
+            uint8_t err = buf[sizeof(PacketHeader)];
+
+            // Servers that predate the version command reject it, don't wait for an answer that won't come
+            bool versionRejected = false;
+            if (err == ERROR_INVALID_COMMAND) {
+                std::vector<PacketWaiter*> toBeRemoved;
+                for (auto& [waiter, cmd] : _this->commandAckWaiters) {
+                    if (cmd != COMMAND_GET_VERSION) { continue; }
+                    waiter->cancel();
+                    toBeRemoved.push_back(waiter);
+                }
+                for (auto& waiter : toBeRemoved) {
+                    _this->commandAckWaiters.erase(waiter);
+                    delete waiter;
+                }
+                versionRejected = !toBeRemoved.empty();
+            }
+            if (!versionRejected) { spdlog::error("SDR++ Server Error: {0}", err); }
         }
         else {
             spdlog::error("Invalid packet type: {0}", _this->r_pkt_hdr->type);
@@ -217,12 +309,100 @@ namespace server {
         _this->client->readAsync(sizeof(PacketHeader), _this->rbuffer, tcpHandler, _this);
     }
 
+    bool ClientClass::readPayload(uint8_t* buf, int len) {
+        int done = 0;
+        while (done < len) {
+            int read = client->read(len - done, &buf[done]);
+            if (read < 0) { return false; }
+            done += read;
+        }
+        return true;
+    }
+
+    void ClientClass::decompWorker() {
+        while (true) {
+            // Wait for a packet
+            int id;
+            {
+                std::unique_lock<std::mutex> lck(poolMtx);
+                poolCnd.wait(lck, [=](){ return !filledBuffers.empty() || !workerRunning; });
+                if (!workerRunning) { return; }
+                id = filledBuffers.front();
+                filledBuffers.pop();
+            }
+
+            // Compressed packets are expanded first, raw ones are decoded from the receive buffer directly
+            RecvBuffer& rb = recvPool[id];
+            const uint8_t* data = rb.data.data();
+            int size = rb.size;
+            if (rb.compressed) {
+                size_t outSize = ZSTD_decompressDCtx(dctx, decompBuf, SERVER_DECOMP_BUFFER_SIZE, rb.data.data(), rb.size);
+                data = decompBuf;
+                size = ZSTD_isError(outSize) ? 0 : outSize;
+            }
+            int outCount = (size > 8) ? decomp.process(size, data, output->writeBuf) : 0;
+
+            // Hand the buffer back to the network thread before waiting on the output
+            {
+                std::lock_guard<std::mutex> lck(poolMtx);
+                freeBuffers.push(id);
+            }
+            poolCnd.notify_all();
+
+            if (outCount && !output->swap(outCount)) { return; }
+        }
+    }
+
+    void ClientClass::stopDecompWorker() {
+        {
+            std::lock_guard<std::mutex> lck(poolMtx);
+            workerRunning = false;
+        }
+        poolCnd.notify_all();
+        output->stopWriter();
+        if (workerThread.joinable()) { workerThread.join(); }
+        output->clearWriteStop();
+
+        // Drop whatever was still queued
+        std::lock_guard<std::mutex> lck(poolMtx);
+        while (!filledBuffers.empty()) {
+            freeBuffers.push(filledBuffers.front());
+            filledBuffers.pop();
+        }
+    }
+
+    int ClientClass::getVersion() {
+        auto waiter = awaitCommandAck(COMMAND_GET_VERSION);
+        sendCommand(COMMAND_GET_VERSION, 0);
+        if (waiter->await(PROTOCOL_TIMEOUT_MS)) {
+            int len = r_pkt_hdr->size - sizeof(PacketHeader) - sizeof(CommandHeader);
+            if (len >= sizeof(uint32_t)) { serverVersion = *(uint32_t*)r_cmd_data; }
+        }
+        else if (serverBusy) {
+            waiter->handled();
+            return -2;
+        }
+        else {
+            // Either rejected by an older server or timed out, assume the former
+            serverVersion = 0;
+        }
+        waiter->handled();
+        spdlog::info("Server protocol version: {0}", serverVersion);
+        return 0;
+    }
+
     int ClientClass::getUI() {
+        // Servers that know it only send the UI back if it differs from ours
+        int len = 0;
+        if (serverVersion >= 1) {
+            std::lock_guard lck(dlMtx);
+            *(uint64_t*)s_cmd_data = dl.getHash();
+            len = sizeof(uint64_t);
+        }
         auto waiter = awaitCommandAck(COMMAND_GET_UI);
-        sendCommand(COMMAND_GET_UI, 0);
+        sendCommand(COMMAND_GET_UI, len);
         if (waiter->await(PROTOCOL_TIMEOUT_MS)) {
-            std::lock_guard lck(dlMtx);
-            dl.load(r_cmd_data, r_pkt_hdr->size - sizeof(PacketHeader) - sizeof(CommandHeader));
+            loadUI();
         }
         else {
             if (!serverBusy) { spdlog::error("Timeout out after asking for UI"); };
@@ -233,6 +413,25 @@ namespace server {
         return 0;
     }
 
+    void ClientClass::loadUI() {
+        // Older servers reply with just the UI
+        int len = r_pkt_hdr->size - sizeof(PacketHeader) - sizeof(CommandHeader);
+        if (serverVersion < 1) {
+            std::lock_guard lck(dlMtx);
+            dl.load(r_cmd_data, len);
+            return;
+        }
+
+        // Otherwise it starts with a status byte since we sent the hash of our UI
+        if (len < 1) {
+            spdlog::error("Invalid UI reply");
+            return;
+        }
+        if (r_cmd_data[0] == UI_REPLY_UNCHANGED) { return; }
+        std::lock_guard lck(dlMtx);
+        dl.load(&r_cmd_data[1], len - 1);
+    }
+
     void ClientClass::sendPacket(PacketType type, int len) {
         s_pkt_hdr->type = type;
         s_pkt_hdr->size = sizeof(PacketHeader) + len;
@@ -255,12 +454,6 @@ namespace server {
         return waiter;
     }
 
-    void ClientClass::dHandler(dsp::complex_t *data, int count, void *ctx) {
-        ClientClass* _this = (ClientClass*)ctx;
-        memcpy(_this->output->writeBuf, data, count * sizeof(dsp::complex_t));
-        _this->output->swap(count);
-    }
-
     Client connect(std::string host, uint16_t port, dsp::stream<dsp::complex_t>* out) {
         net::Conn conn = net::connect(host, port);
         if (!conn) { return NULL; }
@@ -9,8 +9,9 @@
 #include <map>
 #include <vector>
 #include <dsp/compression/sample_stream_decompressor.h>
-#include <dsp/sink.h>
-#include <dsp/routing/stream_link.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <zstd.h>
 
 #define RFSPACE_MAX_SIZE                8192
@@ -19,6 +20,10 @@
 
 #define PROTOCOL_TIMEOUT_MS             10000
 
+// Number of baseband packets that can be received while the previous ones are being decompressed
+#define SERVER_RECV_POOL_SIZE           4
+#define SERVER_DECOMP_BUFFER_SIZE       ((sizeof(dsp::complex_t) * STREAM_BUFFER_SIZE) + 8)
+
 namespace server {
     class PacketWaiter {
     public:
@@ -85,8 +90,14 @@ namespace server {
         void setFrequency(double freq);
         double getSampleRate();
         
-        void setSampleType(dsp::compression::PCMType type);
+        void setSampleType(dsp::compression::PCMType type, int bitDepth = 12, bool deltaCoding = false);
         void setCompression(bool enabled);
+        void setCompressionLevel(int level);
+
+        // In spectrum mode the server sends FFT frames instead of the baseband
+        void setStreamingMode(StreamingMode mode);
+        void setFFT(int size, float rate);
+        void setFFTHandler(void (*handler)(float* data, int count, void* ctx), void* ctx);
 
         void start();
         void stop();
@@ -97,10 +108,24 @@ namespace server {
         int bytes = 0;
         bool serverBusy = false;
 
+        CompressionStats compressionStats;
+        bool compressionStatsValid = false;
+
     private:
+        struct RecvBuffer {
+            std::vector<uint8_t> data;
+            int size = 0;
+            bool compressed = false;
+        };
+
         static void tcpHandler(int count, uint8_t* buf, void* ctx);
+        bool readPayload(uint8_t* buf, int len);
+        void decompWorker();
+        void stopDecompWorker();
 
+        int getVersion();
         int getUI();
+        void loadUI();
 
         void sendPacket(PacketType type, int len);
         void sendCommand(Command cmd, int len);
@@ -110,15 +135,25 @@ namespace server {
         void commandAckHandled(PacketWaiter* waiter);
         std::map<PacketWaiter*, Command> commandAckWaiters;
 
-        static void dHandler(dsp::complex_t *data, int count, void *ctx);
-
         net::Conn client;
 
-        dsp::stream<uint8_t> decompIn;
+        // Baseband packets are read into the pool by the network thread and decoded straight into the output stream by the worker
+        RecvBuffer recvPool[SERVER_RECV_POOL_SIZE];
+        std::queue<int> freeBuffers;
+        std::queue<int> filledBuffers;
+        std::mutex poolMtx;
+        std::condition_variable poolCnd;
+        bool workerRunning = false;
+        std::thread workerThread;
+
+        uint8_t* decompBuf = NULL;
         dsp::compression::SampleStreamDecompressor decomp;
-        dsp::routing::StreamLink<dsp::complex_t> link;
         dsp::stream<dsp::complex_t>* output;
 
+        std::vector<float> fftBuf;
+        void (*fftHandler)(float* data, int count, void* ctx) = NULL;
+        void* fftHandlerCtx;
+
         uint8_t* rbuffer = NULL;
         uint8_t* sbuffer = NULL;
 
@@ -138,6 +173,9 @@ namespace server {
         ZSTD_DCtx* dctx;
 
         double currentSampleRate = 1000000.0;
+
+        // Protocol version of the server, 0 for servers that predate the version command
+        uint32_t serverVersion = 0;
     };
 
     typedef std::unique_ptr<ClientClass> Client;
@@ -11,6 +11,8 @@
 #include <core.h>
 #include <gui/style.h>
 #include <gui/smgui.h>
+#include <thread>
+#include <mutex>
 
 #define CONCAT(a, b) ((std::string(a) + b).c_str())
 
@@ -33,14 +35,6 @@ public:
 
         uiGains = new float[1];
 
-        refresh();
-
-        // Select default device
-        config.acquire();
-        std::string devName = config.conf["device"];
-        config.release();
-        selectDevice(devName);
-
         handler.ctx = this;
         handler.selectHandler = menuSelected;
         handler.deselectHandler = menuDeselected;
@@ -53,11 +47,21 @@ public:
     }
 
     ~SoapyModule() {
+        if (enumThread.joinable()) { enumThread.join(); }
         stop(this);
         sigpath::sourceManager.unregisterSource("SoapySDR");
     }
 
-    void postInit() {}
+    void postInit() {
+        // Soapy enumeration goes through every installed driver and can take seconds, so it's
+        // done on a worker into a separate list that the GUI thread swaps in once it's ready
+        enumThread = std::thread([this]() {
+            SoapySDR::KwargsList list = SoapySDR::Device::enumerate();
+            std::lock_guard<std::mutex> lck(enumMtx);
+            enumList = std::move(list);
+            enumDone = true;
+        });
+    }
 
     void enable() {
         enabled = true;
@@ -80,8 +84,29 @@ public:
     }
 
 private:
+    // Swaps in the devices found after post-init and selects the configured one. Only called from the GUI thread
+    void applyEnumeration(bool wait = false) {
+        if (wait && enumThread.joinable()) { enumThread.join(); }
+        {
+            std::lock_guard<std::mutex> lck(enumMtx);
+            if (!enumDone) { return; }
+            enumDone = false;
+            devList = std::move(enumList);
+        }
+        updateDevListTxt();
+
+        config.acquire();
+        std::string devName = config.conf["device"];
+        config.release();
+        selectDevice(devName);
+    }
+
     void refresh() {
         devList = SoapySDR::Device::enumerate();
+        updateDevListTxt();
+    }
+
+    void updateDevListTxt() {
         txtDevList = "";
         int i = 0;
         for (auto& dev : devList) {
@@ -288,6 +313,7 @@ private:
     static void menuSelected(void* ctx) {
         SoapyModule* _this = (SoapyModule*)ctx;
         spdlog::info("SoapyModule '{0}': Menu Select!", _this->name);
+        _this->applyEnumeration();
         if (_this->devList.size() == 0) {
             return;
         }
@@ -302,6 +328,7 @@ private:
     static void start(void* ctx) {
         SoapyModule* _this = (SoapyModule*)ctx;
         if (_this->running) { return; }
+        _this->applyEnumeration(true);
         if (_this->devId < 0) {
             spdlog::error("No device available");
             return;
@@ -364,6 +391,7 @@ private:
 
     static void menuHandler(void* ctx) {
         SoapyModule* _this = (SoapyModule*)ctx;
+        _this->applyEnumeration();
 
         // If no device is selected, draw only the refresh button
         if (_this->devId < 0) {
@@ -521,6 +549,12 @@ private:
     int uiBandwidthId = 0;
     std::vector<float> bandwidthList;
     std::string txtBwList;
+
+    // Results of the device enumeration started by post-init
+    std::thread enumThread;
+    std::mutex enumMtx;
+    bool enumDone = false;
+    SoapySDR::KwargsList enumList;
 };
 
 MOD_EXPORT void _INIT_() {
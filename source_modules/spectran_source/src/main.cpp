@@ -10,6 +10,8 @@
 #include <utils/optionlist.h>
 #include <codecvt>
 #include <aaroniartsaapi.h>
+#include <thread>
+#include <mutex>
 
 #define CONCAT(a, b) ((std::string(a) + b).c_str())
 
@@ -60,26 +62,48 @@ public:
         handler.tuneHandler = tune;
         handler.stream = &stream;
 
-        refresh();
-
-        // Select device from config
-        config.acquire();
-        std::string devSerial = config.conf["device"];
-        config.release();
-        // TODO: Select
-        selectSerial("");
-
         sigpath::sourceManager.registerSource("Spectran", &handler);
     }
 
     ~SpectranSourceModule() {
+        if (enumThread.joinable()) { enumThread.join(); }
         stop(this);
         sigpath::sourceManager.unregisterSource("Spectran");
         AARTSAAPI_Close(&api);
         AARTSAAPI_Shutdown();
     }
 
-    void postInit() {}
+    void postInit() {
+        // A rescan waits up to two seconds for the devices, so it's done on a worker into a
+        // separate list that the GUI thread swaps in once it's ready
+        enumThread = std::thread([this]() {
+            std::vector<std::pair<std::string, std::wstring>> list;
+            listDevices(list);
+            std::lock_guard<std::mutex> lck(enumMtx);
+            enumList = std::move(list);
+            enumDone = true;
+        });
+    }
+
+    // Swaps in the devices found after post-init. Only called from the GUI thread
+    void applyEnumeration(bool wait = false) {
+        if (wait && enumThread.joinable()) { enumThread.join(); }
+        {
+            std::lock_guard<std::mutex> lck(enumMtx);
+            if (!enumDone) { return; }
+            enumDone = false;
+            devList.clear();
+            for (auto& [serial, id] : enumList) { devList.define(serial, serial, id); }
+            enumList.clear();
+        }
+
+        // Select device from config
+        config.acquire();
+        std::string devSerial = config.conf["device"];
+        config.release();
+        // TODO: Select
+        selectSerial("");
+    }
 
     void enable() {
         enabled = true;
@@ -94,8 +118,19 @@ public:
     }
 
     void refresh() {
-        // Clear device list
+        // The API handle can't be used by the post-init enumeration at the same time, and its
+        // result would be older than this one anyway
+        if (enumThread.joinable()) { enumThread.join(); }
+        enumDone = false;
+
+        std::vector<std::pair<std::string, std::wstring>> list;
+        listDevices(list);
         devList.clear();
+        for (auto& [serial, id] : list) { devList.define(serial, serial, id); }
+    }
+
+    void listDevices(std::vector<std::pair<std::string, std::wstring>>& list) {
+        list.clear();
 
         // Rescan
         if (AARTSAAPI_RescanDevices(&api, 2000) != AARTSAAPI_OK) {
@@ -107,8 +142,7 @@ public:
         AARTSAAPI_DeviceInfo dinfo = { sizeof(AARTSAAPI_DeviceInfo) };
         for (int i = 0; AARTSAAPI_EnumDevice(&api, L"spectranv6", i, &dinfo) == AARTSAAPI_OK; i++) {
             if (!dinfo.ready) { continue; }
-            std::string serial = conv.to_bytes(dinfo.serialNumber);
-            devList.define(serial, serial, dinfo.serialNumber);
+            list.push_back({ conv.to_bytes(dinfo.serialNumber), dinfo.serialNumber });
         }
     }
 
@@ -214,6 +248,7 @@ private:
 
     static void menuSelected(void* ctx) {
         SpectranSourceModule* _this = (SpectranSourceModule*)ctx;
+        _this->applyEnumeration();
         core::setInputSampleRate(_this->samplerate.effective);
         spdlog::info("SpectranSourceModule '{0}': Menu Select!", _this->name);
     }
@@ -226,6 +261,7 @@ private:
     static void start(void* ctx) {
         SpectranSourceModule* _this = (SpectranSourceModule*)ctx;
         if (_this->running) { return; }
+        _this->applyEnumeration(true);
         if (_this->selectedSerial.empty()) { return; }
 
         if (AARTSAAPI_OpenDevice(&_this->api, &_this->dev, L"spectranv6/raw", _this->devList[_this->devId].c_str()) != AARTSAAPI_OK) {
@@ -323,6 +359,7 @@ private:
 
     static void menuHandler(void* ctx) {
         SpectranSourceModule* _this = (SpectranSourceModule*)ctx;
+        _this->applyEnumeration();
 
         if (_this->running) { SmGui::BeginDisabled(); }
 
@@ -506,6 +543,12 @@ private:
     AARTSAAPI_Config croot;
 
     std::thread workerThread;
+
+    // Results of the device enumeration started by post-init
+    std::thread enumThread;
+    std::mutex enumMtx;
+    bool enumDone = false;
+    std::vector<std::pair<std::string, std::wstring>> enumList;
 };
 
 MOD_EXPORT void _INIT_() {
@@ -28,22 +28,29 @@ const char* deviceTypesStr[] = {
     "RTL-SDR"
 };
 
+// Int24 is last to keep the IDs saved in existing configs valid
 const char* streamFormatStr = "UInt8\0"
                               "Int16\0"
-                              "Float32\0";
+                              "Float32\0"
+                              "Int24\0";
 
 const SpyServerStreamFormat streamFormats[] = {
     SPYSERVER_STREAM_FORMAT_UINT8,
     SPYSERVER_STREAM_FORMAT_INT16,
-    SPYSERVER_STREAM_FORMAT_FLOAT
+    SPYSERVER_STREAM_FORMAT_FLOAT,
+    SPYSERVER_STREAM_FORMAT_INT24
 };
 
 const int streamFormatsBitCount[] = {
     8,
     16,
-    32
+    32,
+    24
 };
 
+#define SPYSERVER_FFT_DB_OFFSET 0
+#define SPYSERVER_FFT_DB_RANGE  150
+
 ConfigManager config;
 
 class SpyServerSourceModule : public ModuleManager::Instance {
@@ -127,14 +134,35 @@ private:
             if (!_this->client) { return; }
         }
 
+        int decimation = _this->srId + _this->client->devInfo.MinimumIQDecimation;
+        if (_this->fftOnly) {
+            // Only the server's spectrum is streamed, covering the selected samplerate without any IQ
+            int pixels;
+            core::configManager.acquire();
+            pixels = core::configManager.conf["fftSize"];
+            core::configManager.release();
+            pixels = std::clamp<int>(pixels, SPYSERVER_MIN_DISPLAY_PIXELS, SPYSERVER_MAX_DISPLAY_PIXELS);
+
+            _this->client->setFFTHandler(fftHandler, _this);
+            _this->client->setSetting(SPYSERVER_SETTING_FFT_FORMAT, SPYSERVER_STREAM_FORMAT_UINT8);
+            _this->client->setSetting(SPYSERVER_SETTING_FFT_DECIMATION, decimation);
+            _this->client->setSetting(SPYSERVER_SETTING_FFT_FREQUENCY, _this->freq);
+            _this->client->setSetting(SPYSERVER_SETTING_FFT_DISPLAY_PIXELS, pixels);
+            _this->client->setFFTRange(SPYSERVER_FFT_DB_OFFSET, SPYSERVER_FFT_DB_RANGE);
+            _this->client->setSetting(SPYSERVER_SETTING_STREAMING_MODE, SPYSERVER_STREAM_MODE_FFT_ONLY);
+        }
+        else {
+            _this->client->setFFTHandler(NULL, NULL);
+            _this->client->setSetting(SPYSERVER_SETTING_IQ_FORMAT, streamFormats[_this->iqType]);
+            _this->client->setSetting(SPYSERVER_SETTING_IQ_DECIMATION, decimation);
+            _this->client->setSetting(SPYSERVER_SETTING_IQ_FREQUENCY, _this->freq);
+            _this->client->setSetting(SPYSERVER_SETTING_STREAMING_MODE, SPYSERVER_STREAM_MODE_IQ_ONLY);
+        }
         int srvBits = streamFormatsBitCount[_this->iqType];
-        _this->client->setSetting(SPYSERVER_SETTING_IQ_FORMAT, streamFormats[_this->iqType]);
-        _this->client->setSetting(SPYSERVER_SETTING_IQ_DECIMATION, _this->srId + _this->client->devInfo.MinimumIQDecimation);
-        _this->client->setSetting(SPYSERVER_SETTING_IQ_FREQUENCY, _this->freq);
-        _this->client->setSetting(SPYSERVER_SETTING_STREAMING_MODE, SPYSERVER_STREAM_MODE_IQ_ONLY);
         _this->client->setSetting(SPYSERVER_SETTING_GAIN, _this->gain);
-        _this->client->setSetting(SPYSERVER_SETTING_IQ_DIGITAL_GAIN, _this->client->computeDigitalGain(srvBits, _this->gain, _this->srId + _this->client->devInfo.MinimumIQDecimation));
+        _this->client->setSetting(SPYSERVER_SETTING_IQ_DIGITAL_GAIN, _this->client->computeDigitalGain(srvBits, _this->gain, decimation));
         _this->client->startStream();
+        _this->streamingFFT = _this->fftOnly;
 
         _this->running = true;
         spdlog::info("SpyServerSourceModule '{0}': Start!", _this->name);
@@ -153,7 +181,7 @@ private:
     static void tune(double freq, void* ctx) {
         SpyServerSourceModule* _this = (SpyServerSourceModule*)ctx;
         if (_this->running) {
-            _this->client->setSetting(SPYSERVER_SETTING_IQ_FREQUENCY, freq);
+            _this->client->setSetting(_this->streamingFFT ? SPYSERVER_SETTING_FFT_FREQUENCY : SPYSERVER_SETTING_IQ_FREQUENCY, freq);
         }
         _this->freq = freq;
         spdlog::info("SpyServerSourceModule '{0}': Tune: {1}!", _this->name, freq);
@@ -203,8 +231,14 @@ private:
                 config.conf["devices"][_this->devRef]["sampleRateId"] = _this->srId;
                 config.release(true);
             }
+            if (SmGui::Checkbox(CONCAT("Server spectrum only##_spyserver_fft_only_", _this->name), &_this->fftOnly)) {
+                config.acquire();
+                config.conf["devices"][_this->devRef]["fftOnly"] = _this->fftOnly;
+                config.release(true);
+            }
             if (_this->running) { style::endDisabled(); }
 
+            if (_this->fftOnly) { SmGui::BeginDisabled(); }
             SmGui::LeftLabel("Sample bit depth");
             SmGui::FillWidth();
             if (SmGui::Combo("##spyserver_source_type", &_this->iqType, streamFormatStr)) {
@@ -216,6 +250,7 @@ private:
                 config.conf["devices"][_this->devRef]["sampleBitDepthId"] = _this->iqType;
                 config.release(true);
             }
+            if (_this->fftOnly) { SmGui::EndDisabled(); }
 
             if (_this->client->devInfo.MaximumGainIndex) {
                 SmGui::FillWidth();
@@ -240,6 +275,10 @@ private:
         }
     }
 
+    static void fftHandler(float* data, int count, void* ctx) {
+        sigpath::iqFrontEnd.pushExternalFFT(data, count);
+    }
+
     void tryConnect() {
         try {
             if (client) { client.reset(); }
@@ -262,8 +301,14 @@ private:
                 srId = config.conf["devices"][devRef]["sampleRateId"];
                 iqType = config.conf["devices"][devRef]["sampleBitDepthId"];
                 gain = config.conf["devices"][devRef]["gainId"];
+                fftOnly = false;
+                if (config.conf["devices"][devRef].contains("fftOnly")) {
+                    fftOnly = config.conf["devices"][devRef]["fftOnly"];
+                }
                 config.release(true);
 
+                iqType = std::clamp<int>(iqType, 0, (sizeof(streamFormats) / sizeof(streamFormats[0])) - 1);
+
                 gain = std::clamp<int>(gain, 0, client->devInfo.MaximumGainIndex);
 
                 // Refresh sample rates
@@ -304,6 +349,9 @@ private:
 
     uint32_t gain = 0;
 
+    bool fftOnly = false;
+    bool streamingFFT = false;
+
     std::string devRef = "";
 
     dsp::stream<dsp::complex_t> stream;
@@ -1,6 +1,8 @@
 #include <spyserver_client.h>
 #include <volk/volk.h>
 #include <cstring>
+#include <algorithm>
+#include <math.h>
 
 using namespace std::chrono_literals;
 
@@ -8,11 +10,17 @@ namespace spyserver {
     SpyServerClientClass::SpyServerClientClass(net::Conn conn, dsp::stream<dsp::complex_t>* out) {
         readBuf = new uint8_t[SPYSERVER_MAX_MESSAGE_BODY_SIZE];
         writeBuf = new uint8_t[SPYSERVER_MAX_MESSAGE_BODY_SIZE];
+        convBuf = dsp::buffer::alloc<int32_t>(SPYSERVER_MAX_MESSAGE_BODY_SIZE / 3);
+        fftBuf = dsp::buffer::alloc<float>(SPYSERVER_MAX_DISPLAY_PIXELS);
         client = std::move(conn);
         output = out;
 
         output->clearWriteStop();
 
+        // Let message headers be read together with their body
+        client->setReadBuffer(SPYSERVER_READ_BUFFER_SIZE);
+        client->setNoDelay(true);
+
         sendHandshake("SDR++");
 
         client->readAsync(sizeof(SpyServerMessageHeader), (uint8_t*)&receivedHeader, dataHandler, this);
@@ -22,6 +30,8 @@ namespace spyserver {
         close();
         delete[] readBuf;
         delete[] writeBuf;
+        dsp::buffer::free(convBuf);
+        dsp::buffer::free(fftBuf);
     }
 
     void SpyServerClientClass::startStream() {
@@ -59,6 +69,18 @@ namespace spyserver {
         }
     }
 
+    void SpyServerClientClass::setFFTHandler(void (*handler)(float* data, int count, void* ctx), void* ctx) {
+        fftHandlerCtx = ctx;
+        fftHandler = handler;
+    }
+
+    void SpyServerClientClass::setFFTRange(int offset, int range) {
+        fftOffset = offset;
+        fftRange = range;
+        setSetting(SPYSERVER_SETTING_FFT_DB_OFFSET, offset);
+        setSetting(SPYSERVER_SETTING_FFT_DB_RANGE, range);
+    }
+
     bool SpyServerClientClass::waitForDevInfo(int timeoutMS) {
         std::unique_lock lck(deviceInfoMtx);
         auto now = std::chrono::system_clock::now();
@@ -134,34 +156,60 @@ namespace spyserver {
         }
         else if (mtype == SPYSERVER_MSG_TYPE_UINT8_IQ) {
             int sampCount = _this->receivedHeader.BodySize / (sizeof(uint8_t) * 2);
-            float gain = pow(10, (double)mflags / 20.0);
-            float scale = 1.0f / (gain * 128.0f);
-            for (int i = 0; i < sampCount; i++) {
-                _this->output->writeBuf[i].re = ((float)_this->readBuf[(2 * i)] - 128.0f) * scale;
-                _this->output->writeBuf[i].im = ((float)_this->readBuf[(2 * i) + 1] - 128.0f) * scale;
-            }
+            _this->updateGain(mflags);
+
+            // Flipping the top bit turns offset binary into two's complement so that volk can convert it
+            uint8_t* data = _this->readBuf;
+            for (int i = 0; i < sampCount * 2; i++) { data[i] ^= 0x80; }
+            volk_8i_s32f_convert_32f((float*)_this->output->writeBuf, (int8_t*)data, 128.0f * _this->gain, sampCount * 2);
             _this->output->swap(sampCount);
         }
         else if (mtype == SPYSERVER_MSG_TYPE_INT16_IQ) {
             int sampCount = _this->receivedHeader.BodySize / (sizeof(int16_t) * 2);
-            float gain = pow(10, (double)mflags / 20.0);
-            volk_16i_s32f_convert_32f((float*)_this->output->writeBuf, (int16_t*)_this->readBuf, 32768.0 * gain, sampCount * 2);
+            _this->updateGain(mflags);
+            volk_16i_s32f_convert_32f((float*)_this->output->writeBuf, (int16_t*)_this->readBuf, 32768.0f * _this->gain, sampCount * 2);
             _this->output->swap(sampCount);
         }
         else if (mtype == SPYSERVER_MSG_TYPE_INT24_IQ) {
-            printf("ERROR: IQ format not supported\n");
-            return;
+            int sampCount = _this->receivedHeader.BodySize / (3 * 2);
+            _this->updateGain(mflags);
+
+            // Little endian 24bit to 32bit, the sign is extended by a single shift so that the loop vectorizes
+            const uint8_t* data = _this->readBuf;
+            int32_t* conv = _this->convBuf;
+            for (int i = 0; i < sampCount * 2; i++) {
+                conv[i] = (int32_t)(((uint32_t)data[(i * 3)] << 8) | ((uint32_t)data[(i * 3) + 1] << 16) | ((uint32_t)data[(i * 3) + 2] << 24)) >> 8;
+            }
+            volk_32i_s32f_convert_32f((float*)_this->output->writeBuf, conv, 8388608.0f * _this->gain, sampCount * 2);
+            _this->output->swap(sampCount);
         }
         else if (mtype == SPYSERVER_MSG_TYPE_FLOAT_IQ) {
             int sampCount = _this->receivedHeader.BodySize / sizeof(dsp::complex_t);
-            float gain = pow(10, (double)mflags / 20.0);
-            volk_32f_s32f_multiply_32f((float*)_this->output->writeBuf, (float*)_this->readBuf, gain, sampCount * 2);
+            _this->updateGain(mflags);
+            volk_32f_s32f_multiply_32f((float*)_this->output->writeBuf, (float*)_this->readBuf, 1.0f / _this->gain, sampCount * 2);
             _this->output->swap(sampCount);
         }
+        else if (mtype == SPYSERVER_MSG_TYPE_UINT8_FFT && _this->fftHandler) {
+            // Each byte maps linearly to the configured dB range
+            int binCount = std::min<int>(_this->receivedHeader.BodySize, SPYSERVER_MAX_DISPLAY_PIXELS);
+            float step = (float)_this->fftRange / 255.0f;
+            float base = (float)(_this->fftOffset - _this->fftRange);
+            for (int i = 0; i < binCount; i++) {
+                _this->fftBuf[i] = base + ((float)_this->readBuf[i] * step);
+            }
+            _this->fftHandler(_this->fftBuf, binCount, _this->fftHandlerCtx);
+        }
 
         _this->client->readAsync(sizeof(SpyServerMessageHeader), (uint8_t*)&_this->receivedHeader, dataHandler, _this);
     }
 
+    void SpyServerClientClass::updateGain(int mflags) {
+        // The gain only changes when the digital gain setting does, no need to recompute it for every message
+        if (mflags == cachedGainFlags) { return; }
+        cachedGainFlags = mflags;
+        gain = pow(10, (double)mflags / 20.0);
+    }
+
     SpyServerClient connect(std::string host, uint16_t port, dsp::stream<dsp::complex_t>* out) {
         net::Conn conn = net::connect(host, port);
         if (!conn) {
@@ -4,6 +4,8 @@
 #include <dsp/stream.h>
 #include <dsp/types.h>
 
+#define SPYSERVER_READ_BUFFER_SIZE  0x10000
+
 namespace spyserver {
     class SpyServerClientClass {
     public:
@@ -22,6 +24,10 @@ namespace spyserver {
 
         int computeDigitalGain(int serverBits, int deviceGain, int decimationId);
 
+        // Handler receiving the server side FFT frames, in dB
+        void setFFTHandler(void (*handler)(float* data, int count, void* ctx), void* ctx);
+        void setFFTRange(int offset, int range);
+
         SpyServerDeviceInfo devInfo;
 
     private:
@@ -32,6 +38,8 @@ namespace spyserver {
 
         static void dataHandler(int count, uint8_t* buf, void* ctx);
 
+        void updateGain(int mflags);
+
         net::Conn client;
 
         uint8_t* readBuf;
@@ -44,6 +52,18 @@ namespace spyserver {
         SpyServerMessageHeader receivedHeader;
 
         dsp::stream<dsp::complex_t>* output;
+
+        // Conversion
+        int32_t* convBuf;
+        int cachedGainFlags = -1;
+        float gain = 1.0f;
+
+        // FFT
+        float* fftBuf;
+        void (*fftHandler)(float* data, int count, void* ctx) = NULL;
+        void* fftHandlerCtx;
+        int fftOffset = 0;
+        int fftRange = 127;
     };
 
     typedef std::unique_ptr<SpyServerClientClass> SpyServerClient;